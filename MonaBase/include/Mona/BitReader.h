@@ -31,16 +31,30 @@ struct BitReader : Binary, virtual Object {
 	template<typename ResultType>
 	ResultType read(UInt8 count = (sizeof(ResultType) * 8)) {
 		ResultType result(0);
-		while (_current != _end && count--) {
-			result <<= 1;
-			if (!read())
-				continue;
-			if (count >= (sizeof(ResultType) * 8))
-				return std::numeric_limits<ResultType>::max(); // max reachs!
-			result |= 1;
+		// bits exceeding ResultType capacity have to be 0, else max reachs!
+		for (; count > (sizeof(ResultType) * 8); --count) {
+			if (_current == _end)
+				return result;
+			if (read())
+				return std::numeric_limits<ResultType>::max();
+		}
+		// read byte part by byte part rather than bit by bit
+		while (count && _current != _end) {
+			UInt8 bits(8 - _bit);
+			if (bits > count)
+				bits = count;
+			result = ResultType((UInt64(result) << bits) | ((*_current >> (8 - _bit - bits)) & (0xFF >> (8 - bits))));
+			count -= bits;
+			if ((_bit += bits) == 8) {
+				_bit = 0;
+				nextByte();
+			}
 		}
 		return result;
 	}
+	/*!
+	Read 0 bits until the next 1 bit (readen too), returns the count of 0 bits (leading zeros of a Exp-Golomb code) */
+	UInt32	readZeros();
 
 	UInt64	position() const { return (_current-_data)*8 + _bit; }
 	virtual UInt64	next(UInt64 count = 1);
@@ -56,6 +70,9 @@ struct BitReader : Binary, virtual Object {
 	
 	static BitReader Null;
 protected:
+	/*!
+	Move to the next byte, can be overloaded to skip some bytes (see MPEG4 emulation prevention bytes) */
+	virtual void	nextByte() { ++_current; }
 
 	const UInt8*	_data;
 	const UInt8*	_end;
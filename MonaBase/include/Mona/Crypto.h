@@ -53,7 +53,11 @@ struct Crypto : virtual Static {
 	static UInt32 Rotate32(UInt32 value);
 	static UInt64 Rotate64(UInt64 value);
 
-	static UInt16 ComputeChecksum(BinaryReader& reader);
+	static UInt16 ComputeChecksum(BinaryReader& reader) { return ComputeChecksum(reader.current(), reader.available()); }
+	/*!
+	One's complement checksum of big endian 16 bits words (a last odd byte is added as is, RTMFP way),
+	computed with wide accumulators (SSE2 when available) */
+	static UInt16 ComputeChecksum(const UInt8* data, UInt32 size);
 
 	static UInt32 ComputeCRC32(const UInt8* data, UInt32 size, ROTATE_OPTIONS options =0);
 
@@ -34,7 +34,8 @@ struct File : virtual Object {
 	/*!
 	Decoder offers to decode data in the reception thread when file is used with IOFile,
 	If pBuffer is reseted, no onReaden is callen (data captured),
-	If returns > 0 it continue reading operation (reads returned size) */
+	If returns > 0 it continue reading operation (reads returned size),
+	the reading position can be moved with File::reset before to return (random access) */
 	struct Decoder : virtual Object {
 		virtual UInt32 decode(shared<Buffer>& pBuffer, bool end) = 0;
 		virtual void onRelease(File& file) {}
@@ -53,6 +54,14 @@ struct File : virtual Object {
 	const Mode  mode;
 	Path		releasePath; // path on close
 
+	/*!
+	Writing policy, to set before the first write (recording usage):
+	- extent reserves disk space by extents of this size to limit fragmentation (Linux only, 0 = disabled)
+	- syncSize/syncInterval flush data on disk after this size written or this time (ms) elapsed (0 = disabled, system decides) */
+	UInt32		extent;
+	UInt32		syncSize;
+	UInt32		syncInterval;
+
 	operator const Path&() const { return _path; }
 
 	// properties
@@ -72,6 +81,12 @@ struct File : virtual Object {
 
 	UInt64		readen() const { return _readen; }
 	UInt64		written() const { return _written; }
+	/*!
+	Duration in microseconds of the last write operation (reservation and sync included) */
+	UInt32		latency() const { return _latency; }
+	/*!
+	Duration in microseconds of the last write operation since its queueing by IOFile (backlog latency) */
+	UInt32		delay() const { return _delay; }
 
 	UInt64		queueing() const;
 
@@ -101,6 +116,12 @@ private:
 	volatile bool		_loaded;
 	std::atomic<UInt64>	_readen;
 	std::atomic<UInt64>	_written;
+	std::atomic<UInt32>	_latency;
+	std::atomic<UInt32>	_delay;
+	UInt64				_allocated;
+	UInt64				_origin; // size on opening in append mode, writing position = _origin + _written
+	UInt64				_unsynced;
+	Int64				_syncTime;
 #if defined(_WIN32)
 	HANDLE				_handle;
 #else
@@ -109,8 +109,11 @@ struct Parameters : String::Object<Parameters> {
 	Just to match STD container (see MapWriter) */
 	template<typename ValueType>
 	std::pair<const_iterator, bool> emplace(const std::string& key, ValueType&& value) {
-		if (!_pMap)
-			_pMap.set();
+		if (!_pMap) {
+			onParamInit(); // lazy params have to be built before the first writing too
+			if (!_pMap)
+				_pMap.set();
+		}
 		const auto& it = _pMap->emplace(key, std::string());
 		if (it.second || it.first->second.compare(value) != 0) {
 			it.first->second = std::forward<ValueType>(value);
@@ -93,6 +93,7 @@ struct SRT : virtual Object {
 		virtual bool connect(Exception& ex, const SocketAddress& address, UInt16 timeout = 0);
 
 		virtual int	 sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags = 0);
+		virtual int	 sendPackets(Exception& ex, const std::deque<Packet>& packets, int flags = 0);
 
 		virtual bool bind(Exception& ex, const SocketAddress& address);
 
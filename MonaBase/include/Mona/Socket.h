@@ -146,6 +146,9 @@ struct Socket : virtual Object, Net::Stats {
 	int			 write(Exception& ex, const Packet& packet, int flags = 0) { return write(ex, packet, SocketAddress::Wildcard(), flags); }
 	int			 write(Exception& ex, const Packet& packet, const SocketAddress& address, int flags = 0);
 	/*!
+	Gather writing, sends packets in one system call when possible, otherwise works like write(ex, packet) */
+	int			 write(Exception& ex, const std::deque<Packet>& packets, int flags = 0);
+	/*!
 	Flush packets, return false on socket error */
 	bool		 flush(Exception& ex) { return flush(ex, false); }
 
@@ -166,6 +169,9 @@ protected:
 	Socket(NET_SOCKET id, const sockaddr& addr, Type type=TYPE_STREAM);
 	virtual Socket* newSocket(Exception& ex, NET_SOCKET sockfd, const sockaddr& addr) { return new Socket(sockfd, (sockaddr&)addr); }
 	virtual int		receive(Exception& ex, void* buffer, UInt32 size, int flags, SocketAddress* pAddress);
+	/*!
+	Gather sending (sendmsg/WSASend) to the connected peer, returns size of data sent */
+	virtual int		sendPackets(Exception& ex, const std::deque<Packet>& packets, int flags = 0);
 
 
 	void			send(UInt32 count) { _sendTime = Time::Now(); _sendByteRate += count; }
@@ -226,6 +232,8 @@ private:
 		return false;
 	}
 
+	enum { MAX_GATHERING = 1024 }; // sendings gathered by flush in one sendPackets call (IOV_MAX usual value)
+
 	struct Sending : Packet, virtual Object {
 		Sending(const Packet& packet, const SocketAddress& address, int flags) : Packet(std::move(packet)), address(address), flags(flags) {}
 
@@ -182,6 +182,14 @@ struct String : std::string {
 	static Type ToNumber(Exception& ex, const char* value, Math base = BASE_10) { Type result; return ToNumber(ex, value, std::string::npos, result, base) ? result : defaultValue; }
 	template<typename Type, long long defaultValue>
 	static Type ToNumber(Exception& ex, const char* value, std::size_t size, Math base = BASE_10) { Type result; return ToNumber(ex, value, size, result, base) ? result : defaultValue; }
+
+	/*!
+	Write value in buffer without locale, same result than sprintf with "%lld" or "%llu", returns written size (without null terminated char) */
+	static UInt8 FromNumber(Int64 value, char* buffer);
+	static UInt8 FromNumber(UInt64 value, char* buffer);
+	/*!
+	Write value in buffer (32 bytes minimum) without locale, same result than sprintf with "%.<precision>g", returns written size (without null terminated char) */
+	static UInt8 FromNumber(double value, char* buffer, UInt8 precision = 16);
 	
 
 	static bool IsTrue(const std::string& value) { return IsTrue(value.data(),value.size()); }
@@ -317,96 +325,84 @@ struct String : std::string {
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, signed char value, Args&&... args) {
 		char buffer[8];
-		sprintf(buffer, "%hhd", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(Int64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "short" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, short value, Args&&... args) {
 		char buffer[8];
-		sprintf(buffer, "%hd", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(Int64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "int" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, int value, Args&&... args) {
 		char buffer[16];
-		sprintf(buffer, "%d", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(Int64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "long" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, long value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%ld", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(Int64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "unsigned char" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, unsigned char value, Args&&... args) {
 		char buffer[8];
-		sprintf(buffer, "%hhu", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(UInt64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "unsigned short" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, unsigned short value, Args&&... args) {
 		char buffer[8];
-		sprintf(buffer, "%hu", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(UInt64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "unsigned int" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, unsigned int value, Args&&... args) {
 		char buffer[16];
-		sprintf(buffer, "%u", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(UInt64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "unsigned long" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, unsigned long value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%lu", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(UInt64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "Int64" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, long long value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%lld", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(Int64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "UInt64" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, unsigned long long value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%llu", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(UInt64(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "float" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, float value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%.8g", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(double(value), buffer, 8)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "double" case
 	template <typename OutType, typename ...Args>
 	static OutType& Append(OutType& out, double value, Args&&... args) {
 		char buffer[32];
-		sprintf(buffer, "%.16g", value);
-		return Append<OutType>((OutType&)out.append(buffer,strlen(buffer)), std::forward<Args>(args)...);
+		return Append<OutType>((OutType&)out.append(buffer, FromNumber(double(value), buffer)), std::forward<Args>(args)...);
 	}
 
 	/// \brief match "bool" case
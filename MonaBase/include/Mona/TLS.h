@@ -52,6 +52,7 @@ struct TLS : virtual Object {
 
 	private:
 		int	 receive(Exception& ex, void* buffer, UInt32 size, int flags, SocketAddress* pAddress);
+		int	 sendPackets(Exception& ex, const std::deque<Packet>& packets, int flags = 0) override;
 		bool flush(Exception& ex, bool deleting) override;
 		bool close(Socket::ShutdownType type = SHUTDOWN_BOTH);
 
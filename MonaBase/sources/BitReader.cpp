@@ -15,6 +15,9 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/BitReader.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 using namespace std;
 
@@ -28,11 +31,40 @@ bool BitReader::read() {
 	bool result = (*_current & (0x80 >> _bit++)) ? true : false;
 	if (_bit == 8) {
 		_bit = 0;
-		++_current;
+		nextByte();
 	}
 	return result;
 }
 
+UInt32 BitReader::readZeros() {
+	UInt32 zeros(0);
+	while (_current != _end) {
+		UInt8 value(*_current << _bit);
+		if (!value) {
+			// whole rest of byte is 0
+			zeros += 8 - _bit;
+			_bit = 0;
+			nextByte();
+			continue;
+		}
+		// count leading zeros of the byte
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		UInt8 count(UInt8(7 - index));
+#else
+		UInt8 count(UInt8(__builtin_clz(value) - 24));
+#endif
+		zeros += count;
+		if ((_bit += count + 1) == 8) {
+			_bit = 0;
+			nextByte();
+		}
+		break;
+	}
+	return zeros;
+}
+
 
 UInt64 BitReader::next(UInt64 count) {
 	UInt64 gotten(0);
@@ -40,7 +72,7 @@ UInt64 BitReader::next(UInt64 count) {
 		++gotten;
 		if (++_bit == 8) {
 			_bit = 0;
-			++_current;
+			nextByte();
 		}
 	}
 	return gotten;
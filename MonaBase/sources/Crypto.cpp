@@ -16,6 +16,10 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/Crypto.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace Mona {
@@ -95,17 +99,48 @@ UInt8* Crypto::HMAC::Compute(const EVP_MD* evp, const void* key, int keySize, co
 	return value;
 }
 
-UInt16 Crypto::ComputeChecksum(BinaryReader& reader) {
-	UInt32 sum = 0;
-	UInt32 pos(reader.position());
-	while(reader.available()>0)
-		sum += reader.available()==1 ? reader.read8() : reader.read16();
-	reader.reset(pos);
-
-  /* add back carry outs from top 16 bits to low 16 bits */
-  sum = (sum >> 16) + (sum & 0xffff);     /* add hi 16 to low 16 */
-  sum += (sum >> 16);                     /* add carry */
-  return ~sum; /* truncate to 16 bits */
+UInt16 Crypto::ComputeChecksum(const UInt8* data, UInt32 size) {
+	// One's complement sum doesn't depend on byte order: add native words in wide accumulators,
+	// fold to 16 bits and swap bytes at the end to get the big endian words sum
+	UInt64 sum(0);
+	const UInt8* end(data + (size & ~1));
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	const __m128i zero(_mm_setzero_si128());
+	while ((end - data) >= 16) {
+		// 32 bits lanes get 2 words by loop, can't overflow before 0x8000 loops
+		__m128i lanes(zero);
+		for (UInt32 loops = min(UInt32(end - data) >> 4, 0x7FFFu); loops; --loops, data += 16) {
+			__m128i words(_mm_loadu_si128((const __m128i*)data));
+			lanes = _mm_add_epi32(lanes, _mm_unpacklo_epi16(words, zero));
+			lanes = _mm_add_epi32(lanes, _mm_unpackhi_epi16(words, zero));
+		}
+		UInt32 values[4];
+		_mm_storeu_si128((__m128i*)values, lanes);
+		sum += UInt64(values[0]) + values[1] + values[2] + values[3];
+	}
+#endif
+	UInt32 value;
+	for (; (end - data) >= 4; data += 4) {
+		memcpy(&value, data, 4);
+		sum += value;
+	}
+	if (data < end) {
+		UInt16 word;
+		memcpy(&word, data, 2);
+		sum += word;
+		data += 2;
+	}
+	while (sum >> 16)
+		sum = (sum >> 16) + (sum & 0xFFFF);
+#if !__BIG_ENDIAN__
+	sum = ((sum & 0xFF) << 8) | (sum >> 8);
+#endif
+	if (size & 1)
+		sum += *data;
+	/* add back carry outs from top 16 bits to low 16 bits */
+	sum = (sum >> 16) + (sum & 0xffff);     /* add hi 16 to low 16 */
+	sum += (sum >> 16);                     /* add carry */
+	return ~UInt16(sum); /* truncate to 16 bits */
 }
 
 
@@ -15,6 +15,8 @@ details (or else see http://mozilla.org/MPL/2.0/).
 */
 
 #include "Mona/File.h"
+#include "Mona/Time.h"
+#include <chrono>
 #include <sys/types.h>
 #include <sys/stat.h>
 #if !defined(_WIN32)
@@ -36,7 +38,8 @@ using namespace std;
 namespace Mona {
 
 File::File(const Path& path, Mode mode) : _flushing(0), _loaded(false), _pDecoder(NULL),
-	_written(0), _readen(0), _path(path), mode(mode), _decodingTrack(0),
+	_written(0), _readen(0), _path(path), mode(mode), _decodingTrack(0), extent(0), syncSize(0), syncInterval(0),
+	_latency(0), _delay(0), _allocated(0), _origin(0), _unsynced(0), _syncTime(0),
 	_queueing(0), _ioTrack(0), _handle(INVALID_HANDLE_VALUE), _externDecoder(false) {
 }
 
@@ -97,6 +100,8 @@ bool File::load(Exception& ex) {
 			SetFilePointer((HANDLE)_handle, 0, NULL, FILE_END);
 		LARGE_INTEGER size;
 		GetFileSizeEx((HANDLE)_handle, &size);
+		if (mode == File::MODE_APPEND)
+			_origin = size.QuadPart;
 		FILETIME access;
 		FILETIME change;
 		GetFileTime((HANDLE)_handle, NULL, &access, &change);
@@ -136,6 +141,8 @@ bool File::load(Exception& ex) {
 #endif
 		struct stat status;
 		::fstat(_handle, &status);
+		if (mode == MODE_APPEND)
+			_origin = status.st_size;
 		_path._pImpl->setAttributes(status.st_mode&S_IFDIR ? 0 : (UInt64)status.st_size, status.st_atime * 1000ll, status.st_mtime * 1000ll);
 		_loaded = true;
 		return true;
@@ -191,6 +198,17 @@ bool File::reset(UInt64 position) {
 	if(!load(ex))
 		return position ? true : false;
 	_readen = position;
+	if (!mode) {
+		// reading position, random access
+#if defined(_WIN32)
+		LARGE_INTEGER offset;
+		offset.QuadPart = position;
+		SetFilePointerEx((HANDLE)_handle, offset, NULL, FILE_BEGIN);
+#else
+		lseek64(_handle, position, SEEK_SET);
+#endif
+		return true;
+	}
 #if defined(_WIN32)
 	LARGE_INTEGER offset;
 	offset.QuadPart = -(LONGLONG)_written.exchange(position) + position; // move relating APPEND possible mode!
@@ -241,6 +259,17 @@ bool File::write(Exception& ex, const void* data, UInt32 size) {
 	}
 	if (!size)
 		return true; // nothing todo!
+	chrono::time_point<chrono::steady_clock> start(chrono::steady_clock::now());
+#if defined(__linux__)
+	if (extent && _allocated != UInt64(-1)) {
+		UInt64 end = _origin + _written + size;
+		if (end > _allocated) {
+			// reserve disk space by extents without changing file size, disabled if unsupported by file system
+			UInt64 allocated = end + extent - 1 - (end + extent - 1) % extent;
+			_allocated = fallocate(_handle, FALLOC_FL_KEEP_SIZE, end - size, allocated - end + size) ? UInt64(-1) : allocated;
+		}
+	}
+#endif
 #if defined(_WIN32)
 	DWORD written;
 	if (!WriteFile((HANDLE)_handle, data, size, &written, NULL))
@@ -257,6 +286,22 @@ bool File::write(Exception& ex, const void* data, UInt32 size) {
 		ex.set<Ex::System::File>("No more disk space to write ", _path, " (size=", size, ")");
 		return false;
 	}
+	if (syncSize || syncInterval) {
+		// flush on disk by size or time rather than on every write
+		_unsynced += written;
+		if (!_syncTime)
+			_syncTime = Time::Now();
+		if ((syncSize && _unsynced >= syncSize) || (syncInterval && Time::Now() - _syncTime >= syncInterval)) {
+#if defined(_WIN32)
+			FlushFileBuffers((HANDLE)_handle);
+#else
+			fsync(_handle);
+#endif
+			_unsynced = 0;
+			_syncTime = Time::Now();
+		}
+	}
+	_latency = UInt32(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
 	return true;
 }
 
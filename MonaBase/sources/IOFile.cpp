@@ -16,6 +16,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/IOFile.h"
 #include <list>
+#include <chrono>
 
 using namespace std;
 
@@ -145,6 +146,8 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 						if (pFile.unique())
 							return true; // useless to decode here, nobody to receive it!
 						UInt32 decoded = pFile->_pDecoder->decode(_pBuffer, _end);
+						if (_end && pFile->readen() < pFile->size())
+							_end = false; // reading position moved by the decoder
 						// decoded=wantToRead!
 						if(decoded && !_end)
 							_pThread->queue<ReadFile>(*pFile->_pHandler, pFile, _threadPool, decoded);
@@ -171,7 +174,7 @@ void IOFile::read(const shared<File>& pFile, UInt32 size) {
 
 void IOFile::write(const shared<File>& pFile, const Packet& packet) {
 	struct WriteFile : Action { 
-		WriteFile(const Handler& handler, const shared<File>& pFile, const Packet& packet) : _packet(move(packet)), Action("WriteFile", handler, pFile) {
+		WriteFile(const Handler& handler, const shared<File>& pFile, const Packet& packet) : _packet(move(packet)), Action("WriteFile", handler, pFile), _time(chrono::steady_clock::now()) {
 			pFile->_queueing += _packet.size();
 		}
 	private:
@@ -188,6 +191,7 @@ void IOFile::write(const shared<File>& pFile, const Packet& packet) {
 			UInt64 queueing = (pFile->_queueing -= _packet.size());
 			if (!pFile->write(ex, _packet.data(), _packet.size()))
 				return false;
+			pFile->_delay = UInt32(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - _time).count());
 			if (queueing)
 				return true;
 			if(!pFile->_flushing++) // To signal end of write!
@@ -197,6 +201,7 @@ void IOFile::write(const shared<File>& pFile, const Packet& packet) {
 			return true;
 		}
 		Packet		 _packet;
+		chrono::time_point<chrono::steady_clock> _time; // queueing time
 	};
 	// do the WriteFile even if packet is empty when not loaded to allow to open the file and clear its content or create the file
 	// or to allow to create the folder => if File is a Folder opened in WRITE/APPEND mode loaded is always false and write an empty packet create the folder => allow a folder creation asynchrone!
@@ -386,6 +386,22 @@ int SRT::Socket::sendTo(Exception& ex, const void* data, UInt32 size, const Sock
 	return sent;
 }
 
+int SRT::Socket::sendPackets(Exception& ex, const deque<Packet>& packets, int flags) {
+	// SRT is message oriented, every packet is a distinct message
+	int sent(0);
+	for (const Packet& packet : packets) {
+		int result = sendTo(ex, packet.data(), packet.size(), SocketAddress::Wildcard(), flags);
+		if (result < 0) {
+			if (!sent)
+				return -1;
+			ex = nullptr; // error will be raised again on next sending
+			break;
+		}
+		sent += result;
+	}
+	return sent;
+}
+
 bool SRT::Socket::setRecvBufferSize(Exception& ex, UInt32 size) {
 	if (!setOption(ex, ::SRTO_UDP_RCVBUF, size))
 		return false;
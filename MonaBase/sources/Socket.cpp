@@ -19,6 +19,8 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #if !defined(_WIN32)
 #include <net/if.h>
 #include <fcntl.h>
+#include <sys/uio.h>
+#include <limits.h>
 #endif
 
 
@@ -510,24 +512,123 @@ int Socket::write(Exception& ex, const Packet& packet, const SocketAddress& addr
 	return sent;
 }
 
+int Socket::write(Exception& ex, const deque<Packet>& packets, int flags) {
+	lock_guard<mutex> lock(_mutexSending);
+	UInt32 sent(0);
+	auto it = packets.begin();
+	if (_sendings.empty()) {
+		_sending = true;
+		int result = sendPackets(ex, packets, flags);
+		if (result < 0) {
+			int code = ex.cast<Ex::Net::Socket>().code;
+			if ((code == NET_ENOTCONN && _peerAddress) || code == NET_EWOULDBLOCK) {
+				// queue and wait next call to flush(), no error!
+				ex = nullptr;
+			} else {
+				// RELIABILITY IMPOSSIBLE => is not an error socket + is not connected (connecting = (peerAddress && error==NET_ENOTCONN) = false) + is not WOUldBLOCK
+				if (type == TYPE_STREAM)
+					close(); // shutdown system to avoid to try to send before shutdown!
+				_sending = false;
+				return -1;
+			}
+		} else
+			sent = result;
+		// skip packets sent
+		UInt32 count(sent);
+		while (it != packets.end() && count >= it->size())
+			count -= (it++)->size();
+		if (it == packets.end()) {
+			_sending = false;
+			return sent;
+		}
+		_sendings.emplace_back(*it + count, _peerAddress, flags);
+		_queueing += _sendings.back().size();
+		++it;
+	}
+	while (it != packets.end()) {
+		_sendings.emplace_back(*it, _peerAddress, flags);
+		_queueing += (it++)->size();
+	}
+	return sent;
+}
+
+int Socket::sendPackets(Exception& ex, const deque<Packet>& packets, int flags) {
+	if (_ex) {
+		ex = _ex;
+		return -1;
+	}
+
+#if defined(MSG_NOSIGNAL)
+	flags |= MSG_NOSIGNAL;
+#endif
+
+	UInt32 size(0);
+	int rc;
+	int error;
+#if defined(_WIN32)
+	vector<WSABUF> buffers;
+	buffers.reserve(packets.size());
+	for (const Packet& packet : packets) {
+		buffers.push_back({ packet.size(), (CHAR*)packet.data() });
+		size += packet.size();
+	}
+	DWORD sent;
+	do {
+		rc = WSASend(_id, buffers.data(), DWORD(buffers.size()), &sent, flags, NULL, NULL) == 0 ? int(sent) : -1;
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+#else
+	iovec buffers[IOV_MAX];
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = buffers;
+	for (const Packet& packet : packets) {
+		if (message.msg_iovlen == IOV_MAX)
+			break; // send the rest on next call (partial sending)
+		buffers[message.msg_iovlen].iov_base = (void*)packet.data();
+		buffers[message.msg_iovlen++].iov_len = packet.size();
+		size += packet.size();
+	}
+	do {
+		rc = ::sendmsg(_id, &message, flags);
+	} while (rc < 0 && (error = Net::LastError()) == NET_EINTR);
+#endif
+	if (rc < 0) {
+		SetException(error, ex, " (address=", _peerAddress, ", size=", size, ", flags=", flags, ")");
+		return -1;
+	}
+
+	if (!_address)
+		_address.set(IPAddress::Loopback(), 0); // to advise that address is computable
+
+	send(rc);
+	return rc;
+}
+
 bool Socket::flush(Exception& ex, bool deleting) {
 	UInt32 written(0);
 
 	unique_lock<mutex> lock(_mutexSending, defer_lock);
 	if (!deleting)
 		lock.lock();
-	int sent(0);
-	while(sent>=0 && !_sendings.empty()) {
+	deque<Packet> packets;
+	while(!_sendings.empty()) {
 		Sending& sending(_sendings.front());
-		sent = sendTo(ex, sending.data(), sending.size(), sending.address, sending.flags);
-		if (sent >= 0) {
-			written += sent;
-			if (UInt32(sent) < sending.size()) {
-				// can't send more!
-				sending += sent;
-				break;
+		UInt32 size;
+		int sent;
+		if (type == TYPE_STREAM && _sendings.size() > 1) {
+			// gather sendings queued (a scatter write can queue a lot of small parts) to send them in one call
+			size = 0;
+			for (const Sending& next : _sendings) {
+				if (next.flags != sending.flags || packets.size() == MAX_GATHERING)
+					break;
+				packets.emplace_back(next);
+				size += next.size();
 			}
-		} else {
+			sent = sendPackets(ex, packets, sending.flags);
+			packets.clear();
+		} else
+			sent = sendTo(ex, sending.data(), size = sending.size(), sending.address, sending.flags);
+		if (sent < 0) {
 			int code = ex.cast<Ex::Net::Socket>().code;
 			if ((code == NET_ENOTCONN && _peerAddress) || code == NET_EWOULDBLOCK) {
 				// is connecting, can't send more now (wait onFlush)
@@ -540,8 +641,21 @@ bool Socket::flush(Exception& ex, bool deleting) {
 					close(); // shutdown system to avoid to try to send before shutdown!
 				return false;
 			}
+			_sendings.pop_front();
+			break;
+		}
+		written += sent;
+		// remove sendings sent
+		UInt32 count(sent);
+		while (!_sendings.empty() && count >= _sendings.front().size()) {
+			count -= _sendings.front().size();
+			_sendings.pop_front();
+		}
+		if (UInt32(sent) < size) {
+			// can't send more!
+			_sendings.front() += count;
+			break;
 		}
-		_sendings.pop_front();
 	}
 	if (!deleting && written && !(_queueing -= written))
 		_sending = false;
@@ -114,6 +114,17 @@ bool String::ToNumber(const char* value, size_t size, Type& result, Math base)
 	return ToNumber<Type>(ex, value, size, result, base);
 }
 
+static const UInt64 Power10[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+	100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+	100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull };
+
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 UInt128;
+#endif
+
+// powers of ten exactly representable by a double
+static const double DoublePower10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
 template<typename Type>
 bool String::ToNumber(Exception& ex, const char* value, size_t size, Type& result, Math base) {
 	STATIC_ASSERT(is_arithmetic<Type>::value);
@@ -121,66 +132,108 @@ bool String::ToNumber(Exception& ex, const char* value, size_t size, Type& resul
 		ex.set<Ex::Format>(base, " is impossible to represent with ascii table, maximum base is 36");
 		return false;
 	}
-	bool beginning = true, negative = false;
+	bool beginning = true, negative = false, comma = false, digits = false;
+	// digits are accumulated in an integer while it can hold them exactly, then in a long double
+	UInt64 integer(0);
+	const UInt64 limit((0xFFFFFFFFFFFFFFFFull - 35) / base);
+	bool exact(true);
 	long double number(0);
-	UInt64 comma(0);
+	Int32 exponent(0); // power of base to apply to digits
 
 	const char* current(value);
 	while(*current && size-->0) {
 
-		if (iscntrl(*current) || *current==' ') {
-			if (beginning) {
-				++current;
-				continue;
+		UInt8 digit = *current - '0';
+		if (digit > 9) {
+			if (UInt8(*current) <= ' ' || *current == 0x7F) {
+				if (beginning) {
+					++current;
+					continue;
+				}
+				ex.set<Ex::Format>(value, " is not a correct number");
+				return false;
 			}
-			ex.set<Ex::Format>(value, " is not a correct number");
-			return false;
-		}
 
-		switch (*current) {
-			case '-':
-				negative = true;
-			case '+':
-				if (!beginning) {
-					ex.set<Ex::Format>(value, " is not a correct number");
-					return false;
-				}
-				beginning = false;
-				++current;
-				continue;
-			case '.':
-			case ',':
-				if (beginning || comma) {
-					ex.set<Ex::Format>(value, " is not a correct number");
-					return false;
+			switch (*current) {
+				case '-':
+					negative = true;
+				case '+':
+					if (!beginning) {
+						ex.set<Ex::Format>(value, " is not a correct number");
+						return false;
+					}
+					beginning = false;
+					++current;
+					continue;
+				case '.':
+				case ',':
+					if (beginning || comma) {
+						ex.set<Ex::Format>(value, " is not a correct number");
+						return false;
+					}
+					comma = true;
+					++current;
+					continue;
+				case 'e':
+				case 'E': {
+					if (base != BASE_10 || !digits)
+						break;
+					// exponent, ends the number
+					const char* begin(++current);
+					bool negativeExponent(false), exponentDigits(false);
+					Int32 power(0);
+					while (*current && size-- > 0) {
+						if (*current >= '0' && *current <= '9') {
+							if (power < 100000) // beyond long double capacity anyway
+								power = power * 10 + (*current - '0');
+							exponentDigits = true;
+						} else if (current == begin && (*current == '-' || *current == '+'))
+							negativeExponent = *current == '-';
+						else
+							break;
+						++current;
+					}
+					if (!exponentDigits || (*current && size != string::npos)) {
+						ex.set<Ex::Format>(value, " is not a correct number");
+						return false;
+					}
+					exponent += negativeExponent ? -power : power;
+					size = 0;
+					continue;
 				}
-				comma = 1;
-				++current;
-				continue;
-		}
-
-		if (beginning)
-			beginning = false;
-
-		Int8 value = *current - '0';
-		if (value > 9) {
+			}
+			if (*current < '0') {
+				ex.set<Ex::Format>(*current, " is not a correct digit");
+				return false;
+			}
 			// is letter!
-			if (value >= 49)
-				value -= 39; // is lower letter
-			else if(value>=17)
-				value -= 7; // is upper letter
+			if (*current >= 'a' && *current <= 'z')
+				digit = *current - 'a' + 10; // is lower letter
+			else if(*current >= 'A' && *current <= 'Z')
+				digit = *current - 'A' + 10; // is upper letter
 			else {
 				ex.set<Ex::Format>(*current, " is not a correct digit");
 				return false;
 			}
 		}
-		if(value>=base) {
+		if(digit>=base) {
 			ex.set<Ex::Format>(*current, " is not a correct digit in base ", base);
 			return false;
 		}
 
-		number = number * base + value;
-		comma *= base;
+		beginning = false;
+		digits = true;
+		if (exact) {
+			if (integer <= limit)
+				integer = integer * base + digit;
+			else {
+				exact = false;
+				number = (long double)integer * base + digit;
+			}
+		} else
+			number = number * base + digit;
+		if (comma)
+			--exponent;
 		++current;
 	}
 
@@ -189,8 +242,65 @@ bool String::ToNumber(Exception& ex, const char* value, size_t size, Type& resul
 		return false;
 	}
 
-	if (comma)
-		number /= comma;
+	if (exact && !exponent) {
+		// integer
+		if ((long double)integer > numeric_limits<Type>::max()) {
+			ex.set<Ex::Format>(value, " exceeds maximum number capacity");
+			return false;
+		}
+		result = negative ? (Type)-(long double)integer : (Type)integer;
+		return true;
+	}
+
+	if (exact && base == BASE_10) {
+		// bring exponent back in the exact powers of ten when possible: trailing zeros of digits (as written by %e), or small integer
+		while (exponent < -22 && integer && !(integer % 10)) {
+			integer /= 10;
+			++exponent;
+		}
+		while (exponent > 22 && integer <= (1ull << 53) / 10) {
+			integer *= 10;
+			--exponent;
+		}
+	}
+	if (exact && base == BASE_10 && integer <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+		// integer and power of ten exact in a double, so one rounding as a correctly rounded parsing
+		double decimal = double(integer);
+		if (exponent < 0)
+			decimal /= DoublePower10[-exponent];
+		else
+			decimal *= DoublePower10[exponent];
+		if (decimal > numeric_limits<Type>::max()) {
+			ex.set<Ex::Format>(value, " exceeds maximum decimal capacity");
+			return false;
+		}
+		result = negative ? (Type)-decimal : (Type)decimal;
+		return true;
+	}
+
+	if (exact) {
+		if (!integer) { // zero whatever the exponent (avoid 0 * inf = NaN)
+			result = negative ? (Type)-0.0 : Type(0);
+			return true;
+		}
+		number = (long double)integer;
+	}
+	// apply exponent by steps where power stays finite, then number overflows to inf or underflows to 0 as expected
+	const Int32 maxStep(numeric_limits<long double>::max_exponent10);
+	while (exponent && number && number <= numeric_limits<long double>::max()) {
+		Int32 step(exponent > maxStep ? maxStep : (exponent < -maxStep ? -maxStep : exponent));
+		exponent -= step;
+		long double power(1), factor(base);
+		for (UInt32 count = step < 0 ? -step : step; count; count >>= 1) {
+			if (count & 1)
+				power *= factor;
+			factor *= factor;
+		}
+		if (step < 0)
+			number /= power;
+		else
+			number *= power;
+	}
 
 	if (number > numeric_limits<Type>::max()) {
 		ex.set<Ex::Format>(value, " exceeds maximum number capacity");
@@ -204,6 +314,129 @@ bool String::ToNumber(Exception& ex, const char* value, size_t size, Type& resul
 	return true;
 }
 
+UInt8 String::FromNumber(Int64 value, char* buffer) {
+	if (value >= 0)
+		return FromNumber(UInt64(value), buffer);
+	*buffer = '-';
+	return FromNumber(0 - UInt64(value), buffer + 1) + 1;
+}
+
+UInt8 String::FromNumber(UInt64 value, char* buffer) {
+	static const char Digits[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+	// two digits by iteration, from the end
+	char digits[20];
+	char* current(digits + sizeof(digits));
+	while (value >= 100) {
+		current -= 2;
+		memcpy(current, Digits + (value % 100) * 2, 2);
+		value /= 100;
+	}
+	if (value >= 10) {
+		current -= 2;
+		memcpy(current, Digits + value * 2, 2);
+	} else
+		*--current = char('0' + value);
+	UInt8 size(UInt8(digits + sizeof(digits) - current));
+	memcpy(buffer, current, size);
+	return size;
+}
+
+UInt8 String::FromNumber(double value, char* buffer, UInt8 precision) {
+	UInt64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	char* out(buffer);
+	if (bits >> 63)
+		*out = '-';
+	Int16 exponent((bits >> 52) & 0x7FF);
+	UInt64 mantissa(bits & 0xFFFFFFFFFFFFFull);
+	if (!exponent && !mantissa) {
+		out[bits >> 63] = '0';
+		return UInt8(bits >> 63) + 1;
+	}
+	out += bits >> 63;
+	if (precision && precision <= 19 && exponent && exponent < 0x7FF) {
+		// normalized, value = mantissa * 2^exponent
+		mantissa |= 1ull << 52;
+		exponent -= 1075;
+		if (exponent >= 0) {
+			// integer, fixed notation of %g if less digits than precision
+			if (exponent <= 11 && (mantissa << exponent) < Power10[precision])
+				return UInt8(out - buffer) + FromNumber(mantissa << exponent, out);
+		} else if (exponent > -53 && !(mantissa & ((1ull << -exponent) - 1))) {
+			if ((mantissa >> -exponent) < Power10[precision])
+				return UInt8(out - buffer) + FromNumber(mantissa >> -exponent, out);
+		}
+#if defined(__SIZEOF_INT128__)
+		else if (exponent > -128) {
+			// fractional, rounds exactly "precision" significant digits with 128 bits integers
+			Int16 decimal(((exponent + 52) * 1233) >> 12); // floor(log10(value)), or one less
+			UInt64 digits(0);
+			UInt128 remainder(0), half(UInt128(1) << (-exponent - 1));
+			for (;;) {
+				Int16 shift(precision - 1 - decimal);
+				if (shift < 0 || shift > 19)
+					break;
+				UInt128 scaled(UInt128(mantissa) * Power10[shift]);
+				UInt128 quotient(scaled >> -exponent);
+				if (quotient >= Power10[precision]) {
+					++decimal;
+					continue;
+				}
+				if (quotient < Power10[precision - 1]) {
+					--decimal;
+					continue;
+				}
+				digits = UInt64(quotient);
+				remainder = scaled & ((half << 1) - 1);
+				break;
+			}
+			if (digits) {
+				// round half to even, like printf
+				if (remainder > half || (remainder == half && (digits & 1))) {
+					if (++digits == Power10[precision]) {
+						digits = Power10[precision - 1];
+						++decimal;
+					}
+				}
+				if (decimal >= -4 && decimal < precision) {
+					// fixed notation of %g, without trailing zeros
+					char figures[20];
+					FromNumber(digits, figures);
+					UInt8 size(precision);
+					while (figures[size - 1] == '0')
+						--size;
+					if (decimal >= 0) {
+						memcpy(out, figures, decimal + 1);
+						out += decimal + 1;
+						if (size > decimal + 1) {
+							*out++ = '.';
+							memcpy(out, figures + decimal + 1, size - decimal - 1);
+							out += size - decimal - 1;
+						}
+					} else {
+						*out++ = '0';
+						*out++ = '.';
+						for (Int16 i = decimal + 1; i < 0; ++i)
+							*out++ = '0';
+						memcpy(out, figures, size);
+						out += size;
+					}
+					return UInt8(out - buffer);
+				}
+			}
+		}
+#endif
+	}
+	// exponent notation, infinity or nan
+	int size(snprintf(buffer, 32, "%.*g", precision, value));
+	if (size < 0)
+		return 0;
+	char* comma(strchr(buffer, ','));
+	if (comma)
+		*comma = '.'; // locale-free
+	return UInt8(size);
+}
+
 
 UInt32 String::FromURI(const char* value, std::size_t count, const ForEachDecodedChar& forEach) {
 
@@ -28,8 +28,9 @@ bool TLS::Create(Exception& ex, shared<TLS>& pTLS, const SSL_METHOD* method) {
 	if (pCTX) {
 		/* If the underlying BIO is blocking, SSL_read()/SSL_write() will only return, once the read operation has been finished or an error occurred,
 		except when a renegotiation take place, in which case a SSL_ERROR_WANT_READ may occur.
-		This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call. */
-		SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY);
+		This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call.
+		SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER because a write retry can gather the sendings queued in a new buffer */
+		SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 		pTLS = new TLS(pCTX);
 		return true;
 	}
@@ -45,8 +46,9 @@ bool TLS::Create(Exception& ex, const char* cert, const char* key, shared<TLS>&
 		if (SSL_CTX_use_certificate_file(pCTX, cert, SSL_FILETYPE_PEM) == 1 && SSL_CTX_use_PrivateKey_file(pCTX, key, SSL_FILETYPE_PEM) == 1) {
 			/* If the underlying BIO is blocking, SSL_read()/SSL_write() will only return, once the read operation has been finished or an error occurred,
 			except when a renegotiation take place, in which case a SSL_ERROR_WANT_READ may occur.
-			This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call. */
-			SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY);
+			This behaviour can be controlled with the SSL_MODE_AUTO_RETRY flag of the SSL_CTX_set_mode call.
+			SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER because a write retry can gather the sendings queued in a new buffer */
+			SSL_CTX_set_mode(pCTX, SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 			pTLS = new TLS(pCTX);
 			return true;
 		}
@@ -166,6 +168,16 @@ int TLS::Socket::sendTo(Exception& ex, const void* data, UInt32 size, const Sock
 	return result;
 }
 
+int TLS::Socket::sendPackets(Exception& ex, const deque<Packet>& packets, int flags) {
+	if (!pTLS)
+		return Mona::Socket::sendPackets(ex, packets, flags); // normal socket
+	// gather packets to encrypt them in one SSL record rather one record by packet
+	Buffer buffer;
+	for (const Packet& packet : packets)
+		buffer.append(packet.data(), packet.size());
+	return sendTo(ex, buffer.data(), buffer.size(), SocketAddress::Wildcard(), flags);
+}
+
 bool TLS::Socket::flush(Exception& ex, bool deleting) {
 	// Call when Writable!
 	if (!pTLS || queueing() || deleting) // if queueing a SLL_Write will do the handshake!
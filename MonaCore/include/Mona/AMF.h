@@ -36,7 +36,8 @@ struct AMF : virtual Static {
 		TYPE_DATA_AMF3			=0x0F,
 		TYPE_INVOCATION_AMF3	=0x11,
 		TYPE_DATA				=0x12,
-		TYPE_INVOCATION			=0x14
+		TYPE_INVOCATION			=0x14,
+		TYPE_AGGREGATE			=0x16
 	};
 
 	enum AMF3 {
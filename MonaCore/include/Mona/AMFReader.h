@@ -22,6 +22,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/AMF.h"
 #include "Mona/ReferableReader.h"
 #include <vector>
+#include <deque>
 
 namespace Mona {
 
@@ -51,8 +52,19 @@ private:
 
 	const char*		readText(UInt32& size);
 
+	/*!
+	AMF3 traits decoded one time, then just indexed by traits reference */
+	struct Traits : virtual Object {
+		Traits(UInt32 position, const char* type, UInt32 size, UInt8 flags) : position(position), type(type), size(size), flags(flags) {}
+		const UInt32	position;
+		const char*		type;
+		UInt32			size;
+		UInt8			flags; // 1 = externalizable, 2 = dynamic
+		std::vector<std::pair<const char*, UInt32>> members; // sealed members
+	};
+
 	std::vector<UInt32>		_stringReferences;
-	std::vector<UInt32>		_classDefReferences;
+	std::deque<Traits>		_traits; // deque to keep traits references valid on nested objects
 	std::vector<UInt32>		_references;
 	std::vector<UInt32>		_amf0References;
 
@@ -21,6 +21,8 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Mona.h"
 #include "Mona/AMF.h"
 #include "Mona/Media.h"
+#include <unordered_map>
+#include <deque>
 
 namespace Mona {
 
@@ -63,11 +65,28 @@ private:
 
 	void writeText(const char* value,UInt32 size);
 
-	std::map<std::string,UInt32>	_stringReferences;
-	std::vector<UInt8>				_references;
-	UInt32							_amf0References;
-	bool							_amf3;
-	std::vector<bool>				_levels; // true if amf3
+	// key on raw bytes, to search a reference without copy (the text is copied just on new reference)
+	struct Text {
+		Text(const char* data, UInt32 size) : data(data), size(size) {}
+		bool operator==(const Text& other) const { return size == other.size && memcmp(data, other.data, size) == 0; }
+		const char*	data;
+		UInt32		size;
+	};
+	struct TextHash {
+		size_t operator()(const Text& text) const;
+	};
+	typedef std::unordered_map<Text, UInt32, TextHash> References;
+	/*!
+	Return true and assign index if text is already referenced, otherwise add the new reference and return false */
+	bool reference(References& references, const char* value, UInt32 size, UInt32& index);
+
+	References								_stringReferences;
+	References								_traitReferences; // object type => traits index
+	std::deque<std::string>					_texts; // texts referenced, deque to keep their address
+	std::vector<UInt8>						_references;
+	UInt32									_amf0References;
+	bool									_amf3;
+	std::vector<bool>						_levels; // true if amf3
 };
 
 
@@ -37,9 +37,25 @@ struct CCaption : virtual Object {
 	Channel will of 1 to 4 */
 	typedef std::function<void(UInt8 channel, const char* lang)>					OnLang;
 
+	/*!
+	Extract CEA-608 captions of H264 SEI NAL units, returns the offset of the video frame after the captions SEI, or 0 if no captions
+	A frame without SEI NAL unit is skipped on its NAL types, without parsing */
 	UInt32 extract(const Media::Video::Tag& tag, const Packet& packet, const CCaption::OnText& onText, const CCaption::OnLang& onLang);
+	/*!
+	Skip a frame when there is no text consumer, releases pending captions on first skip to restart cleanly on next extraction */
+	void   skip();
 	void   flush(const CCaption::OnText& onText = nullptr);
 
+	/*!
+	Count of frames parsed to find captions */
+	UInt32 scanned() const { return _scanned; }
+	/*!
+	Count of frames skipped without text consumer */
+	UInt32 skipped() const { return _skipped; }
+	/*!
+	Count of frames filtered without parsing, not H264 or without SEI NAL unit */
+	UInt32 filtered() const { return _filtered; }
+
 private:
 	void   decode(const Media::Video::Tag& tag, const Packet& packet, const CCaption::OnLang& onLang);
 
@@ -98,6 +114,10 @@ private:
 
 	char			_langs[4][2];
 	Channel			_channels[2];
+	bool			_extracting;
+	UInt32			_scanned;
+	UInt32			_skipped;
+	UInt32			_filtered;
 };
 
 
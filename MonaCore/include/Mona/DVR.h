@@ -0,0 +1,104 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Playlist.h"
+#include "Mona/IOFile.h"
+#include <list>
+
+namespace Mona {
+
+/*!
+Disk-backed ring of segments for DVR/time-shift, segments are appended in block files of BLOCK_SIZE written by IOFile:
+[...data...] by frame, followed by the per-frame index [UInt32=>time][UInt32=>offset][UInt8=>flags][Media::Pack] of the segment.
+Just a compact descriptor by segment stays in memory (with the segment itself until written), frames read are packets referencing
+a read-only mapping of the block (zero-copy), oldest segments are removed beyond the retention and block files deleted once no more referenced.
+Ring is not persistent, block files of a previous ring are removed on creation and its folder is deleted on destruction */
+struct DVR : virtual Object {
+	NULLABLE(_items.empty())
+
+	enum : UInt32 {
+		BLOCK_SIZE = 0x4000000, // 64MB
+		CACHE_SEGMENTS = 8 // last segments read kept to reuse their muxed cache
+	};
+
+	/*!
+	Create a DVR in the folder path with a retention in seconds, block files are written by io */
+	DVR(IOFile& io, const Path& path, UInt32 retention);
+	~DVR();
+
+	const Path		path;
+
+	UInt32			retention() const { return _retention; }
+	UInt32			setRetention(UInt32 value) { _retention = value; clean(); return value; }
+
+	UInt32			sequence() const { return _items.empty() ? 0 : _items.front().sequence; }
+	UInt32			count() const { return _items.size(); }
+	UInt32			duration() const { return _duration; }
+	/*!
+	Size of segments on disk */
+	UInt64			size() const { return _size; }
+
+	/*!
+	Append a complete segment with its sequence number */
+	bool			append(Exception& ex, UInt32 sequence, const Segment& segment);
+	/*!
+	Get segment by its sequence number, medias reference directly the mapped memory once the segment written.
+	Returns a copy sharing medias and muxed cache with the cached segment, stays valid after eviction of the cache */
+	Segment			operator()(UInt32 sequence) const;
+	/*!
+	Fill playlist with the segments of the last window seconds, all the ring by default */
+	Playlist&		to(Playlist& playlist, UInt32 window = 0xFFFFFFFF) const;
+
+private:
+	struct Block;
+	struct Mapping;
+	struct Item : virtual Object {
+		Item(const shared<Block>& pBlock, UInt32 offset, UInt32 sequence, UInt32 time, UInt16 duration, bool discontinuous) :
+			pBlock(pBlock), offset(offset), sequence(sequence), time(time), duration(duration), discontinuous(discontinuous), index(0), end(0), frames(0) {}
+		UInt32				size() const { return end - offset; }
+
+		const shared<Block>	pBlock;
+		const UInt32		offset; // segment position in the block
+		UInt32				index; // frame index position in the block
+		UInt32				end; // end position in the block
+		UInt32				frames;
+		mutable unique<const Segment> pSegment; // segment kept in memory until written
+		const UInt32		sequence;
+		const UInt32		time;
+		const UInt16		duration;
+		const bool			discontinuous;
+	};
+
+	void clean();
+	bool written(const Item& item) const;
+
+	IOFile&				_io;
+	std::deque<Item>	_items;
+	UInt32				_writing; // last items not yet written
+	shared<Block>		_pBlock; // block in writing
+	UInt32				_blocks;
+	UInt32				_retention;
+	UInt32				_duration;
+	UInt64				_size;
+	const Int64			_id; // prefix of block files to never collide with a previous ring of the same folder
+
+	mutable std::list<std::pair<UInt32, Segment>> _cache;
+};
+
+} // namespace Mona
@@ -25,7 +25,6 @@ details (or else see http://www.gnu.org/licenses/).
 
 namespace Mona {
 
-struct BitstreamReader;
 struct HEVC : virtual Static {
 	enum NAL {
 		NAL_TRAIL_N = 0,
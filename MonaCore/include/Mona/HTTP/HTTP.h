@@ -177,6 +177,7 @@ struct HTTP : virtual Static {
 		float			version;
 		const char*		origin;
 		const char*		range; // TODO supports it?
+		const char*		contentLength;
 
 		const char*		code;
 		UInt8			connection;
@@ -186,6 +187,7 @@ struct HTTP : virtual Static {
 		bool			progressive;
 
 		Date			ifModifiedSince;
+		const char*		ifNoneMatch;
 
 		const char*		secWebsocketKey;
 		const char*		secWebsocketAccept;
@@ -195,7 +197,20 @@ struct HTTP : virtual Static {
 
 		bool			rendezVous;
 
-		void			set(const char* key, const char* value);
+		/*!
+		Add a header field without copy, key and value are null terminated strings inside buffer (hold by the header).
+		Known fields are interpreted immediatly, parameters are built just on first access */
+		void			set(const Packet& buffer, const char* key, const char* value);
+		/*!
+		Write fields in params, with cookies and type/version/code infos */
+		void			fill(Parameters& params) const;
+
+	private:
+		void			onParamInit() { if (_filled) return; _filled = true; fill(self); }
+
+		std::vector<std::pair<const char*, const char*>>	_fields;
+		std::deque<Packet>									_buffers;
+		bool												_filled;
 	};
 
 	
@@ -213,24 +228,28 @@ struct HTTP : virtual Static {
 		operator const shared<const Header>&() const { return _pHeader; }
 		bool unique() const { return _pHeader.unique(); }
 	protected:
-		Message(shared<Header>& pHeader, const Packet& packet, bool flush) : lost(0), pMedia(NULL), flush(flush), Packet(std::move(packet)), _pHeader(std::move(pHeader)) { if (_pHeader) setParams(*_pHeader); }
-		Message(shared<Header>& pHeader, const shared<WSDecoder>& pDecoder) : lost(0), pMedia(NULL), flush(true), Packet(Packet::Null()), pWSDecoder(pDecoder), _pHeader(std::move(pHeader)) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, const Packet& packet, bool flush) : lost(0), pMedia(NULL), flush(flush), Packet(std::move(packet)), _pHeader(std::move(pHeader)), _filled(false) {}
+		Message(shared<Header>& pHeader, const shared<WSDecoder>& pDecoder) : lost(0), pMedia(NULL), flush(true), Packet(Packet::Null()), pWSDecoder(pDecoder), _pHeader(std::move(pHeader)), _filled(false) {}
 		/*!
 		exception */
-		Message(shared<Header>& pHeader, const Exception& ex) : lost(0), pMedia(NULL), ex(ex), flush(true), _pHeader(std::move(pHeader)) {} // Exception => no need to parse params!
+		Message(shared<Header>& pHeader, const Exception& ex) : lost(0), pMedia(NULL), ex(ex), flush(true), _pHeader(std::move(pHeader)), _filled(true) {} // Exception => no need to parse params!
 		/*!
 		media packet */
-		Message(shared<Header>& pHeader, Media::Base* pMedia) : lost(0), pMedia(pMedia), _pHeader(std::move(pHeader)), flush(false) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, Media::Base* pMedia) : lost(0), pMedia(pMedia), _pHeader(std::move(pHeader)), flush(false), _filled(false) {}
 		/*!
 		media lost infos */
-		Message(shared<Header>& pHeader, Media::Type type, UInt32 lost, UInt8 track = 0) : lost(lost), pMedia(new Media::Base(type, Packet::Null(), track)), _pHeader(std::move(pHeader)), flush(false) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, Media::Type type, UInt32 lost, UInt8 track = 0) : lost(lost), pMedia(new Media::Base(type, Packet::Null(), track)), _pHeader(std::move(pHeader)), flush(false), _filled(false) {}
 		/*!
 		media reset, flush or publish end */
-		Message(shared<Header>& pHeader, bool endMedia, bool flush) : lost(0), pMedia(endMedia ? NULL : new Media::Base()), _pHeader(std::move(pHeader)), flush(flush) { if (_pHeader) setParams(*_pHeader); }
+		Message(shared<Header>& pHeader, bool endMedia, bool flush) : lost(0), pMedia(endMedia ? NULL : new Media::Base()), _pHeader(std::move(pHeader)), flush(flush), _filled(false) {}
 
 		~Message() { if (pMedia) delete pMedia; }
 	private:
+		// params built from header just on first access, reading or writing (properties copied to the client, or scripting)
+		void onParamInit() { if (_filled) return; _filled = true; if (_pHeader) _pHeader->fill(self); }
+
 		shared<const Header> _pHeader;
+		bool				 _filled;
 	};
 
 	struct Request : Message, virtual Object {
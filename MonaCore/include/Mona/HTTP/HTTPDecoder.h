@@ -48,7 +48,6 @@ private:
 		PATH,
 		VERSION,
 		LEFT,
-		RIGHT,
 		BODY,
 		CHUNKED
 	};
@@ -91,6 +90,7 @@ private:
 	Time					_lastRequest;
 	Path					_file;
 	UInt16					_code;
+	UInt32					_fieldsSize; // header fields bytes already parsed, to limit header size
 	std::string				_www;
 	const Handler&			_handler;
 	unique<MediaReader>		_pReader;
@@ -20,38 +20,50 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/HTTP/HTTPSender.h"
-#include "Mona/Playlist.h"
+#include "Mona/Publication.h"
 
 
 namespace Mona {
 
 /*!
-Playlist send */
+Playlist send,
+playlist rendered is shared with the next requests until segments change (see Segments::playlists),
+and revalidated with its ETag (304 Not Modified) */
 struct HTTPPlaylistSender : HTTPSender, virtual Object {
 	HTTPPlaylistSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& path, const Segments& segments, std::string&& format = "ts") :
-		_playlist(path), _format(std::move(format)), HTTPSender("HTTPPlaylistSender", pRequest, pSocket) {
-		segments.to(_playlist);
+		const Path& path, const Segments& segments, std::string&& format = "ts", UInt32 dvr = 0) :
+		_playlist(path), _format(std::move(format)), _pPlaylists(segments.playlists()), HTTPSender("HTTPPlaylistSender", pRequest, pSocket) {
+		String::Assign(_key, path.extension(), '.', _format, '.', dvr);
+		_rendered = _pPlaylists->get(_key);
+		if (!_rendered) // else useless to build the playlist
+			segments.to(_playlist, dvr);
 	}
 
 private:
 	bool  run() override;
 
-	Playlist	_playlist;
-	std::string	_format;
+	Playlist						_playlist;
+	std::string						_format;
+	std::string						_key;
+	shared<const Segments::Playlists>	_pPlaylists;
+	Packet							_rendered;
 };
 
 /*!
-Master Playlist send */
+Master Playlist send of a MBR group (name_1080, name_720, ...) with BANDWIDTH, RESOLUTION and CODECS of its renditions,
+its ETag is made of the renditions states and the master rendered is shared with the playlists of the first rendition */
 struct HTTPMPlaylistSender : HTTPSender, virtual Object {
 	HTTPMPlaylistSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		Playlist::Master&& playlist) : _playlist(std::move(playlist)), HTTPSender("HTTPMPlaylistSender", pRequest, pSocket) {
-	}
+		const Path& path, const std::vector<const Publication*>& renditions);
 
 private:
 	bool  run() override;
 
-	Playlist::Master _playlist;
+	Playlist::Master					_playlist;
+	std::string							_etag;
+	std::string							_key;
+	shared<const Segments::Playlists>	_pPlaylists;
+	Packet								_rendered;
 };
 
 
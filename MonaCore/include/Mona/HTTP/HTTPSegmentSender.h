@@ -28,11 +28,13 @@ namespace Mona {
 /*!
 Media Segment send,
 send with TCPSender::send(pHTTPSender) but keep a reference on until get a onFlush,
-If after onFlush the pHTTPSender.unique() && !pHTTPSender->flushing() the media has been fully sent, otherwise recall TCPSender::send(pHTTPSender) */
+If after onFlush the pHTTPSender.unique() && !pHTTPSender->flushing() the media has been fully sent, otherwise recall TCPSender::send(pHTTPSender)
+Segment is muxed one time by format, next requests send the muxed packets cached in the segment.
+MP4 segment is a CMAF segment self-contained with its init part (ftyp+moov), init part sent alone if pInit is given with the init cache of the Segments (see Segments::initSegment) */
 struct HTTPSegmentSender : HTTPSender, private Media::Target, virtual Object {
 	
 	HTTPSegmentSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& path, const Segment& segment, Parameters& params);
+		const Path& path, const Segment& segment, Parameters& params, const Segment* pInit = NULL);
 
 	const Path& path() const override { return _path; }
 
@@ -51,6 +53,12 @@ private:
 	unique<MediaWriter>		_pWriter;
 	const Segment			_segment;
 	Segment::const_iterator _itMedia;
+	std::string				_format; // cache key of the muxed segment
+	shared<Segment::Muxed>	_pMuxing; // muxed packets to cache
+	shared<Segment::Muxed>	_pInitMuxing; // CMAF init segment
+	unique<const Segment>	_pInit; // CMAF init segment cache, if init requested
+	shared<const Segment::Muxed>	_pMuxed; // cached muxed packets to send
+	Segment::Muxed::const_iterator	_itMuxed;
 	Subscription			_subscription; // use subscription to support properties subscription
 	Path					_path;
 	UInt32					_lastTime;
@@ -21,6 +21,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Mona.h"
 #include "Mona/QueryReader.h"
 #include "Mona/FileWriter.h"
+#include "Mona/Segments.h"
 #include "Mona/HTTP/HTTPWriter.h"
 #include "Mona/HTTP/HTTPDecoder.h"
 
@@ -63,6 +64,9 @@ private:
 
 	bool			writeFile(Exception& ex, HTTP::Request& request, QueryReader& parameters);
 	bool			invoke(Exception& ex, HTTP::Request& request, QueryReader& parameters, const char* name = NULL);
+	/*!
+	LL-HLS blocking request, answer immediatly if the segment (or its part if part>=0) is available, otherwise on its availability */
+	void			wait(const Segments& segments, UInt32 sequence, Int32 part, std::function<void(const Segments&)>&& answer);
 
 	unique<HTTPWriter>  _pWriter; // pointer to release source on session::kill
 	Subscription*		_pSubscription;
@@ -70,6 +74,9 @@ private:
 	UInt32				_timeoutPublication;
 	FileWriter			_fileWriter;
 	UInt8				_EOWFlags; // 1 = end of write, 2 = has been created
+	shared<Segments::Waiter> _pWaiting; // LL-HLS blocking request
+	Time				_waitingTime;
+	UInt32				_waitingTimeout;
 
 	unique<Session>		_pUpgradeSession;
 
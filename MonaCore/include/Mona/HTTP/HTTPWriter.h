@@ -54,9 +54,9 @@ struct HTTPWriter : Writer, Media::Target, virtual Object {
 	void			writeSetCookie(const std::string& key, DataReader& reader);
 
 	void			writeFile(const Path& file, Parameters& properties);
-	void			writeSegment(const Path& path, const Segment& segment, Parameters& params);
-	void			writePlaylist(const Path& path, const Segments& segments, std::string&& format = "ts") { newSender<HTTPPlaylistSender>(true, path, segments, std::move(format)); }
-	void			writeMasterPlaylist(Playlist::Master&& playlist) { newSender<HTTPMPlaylistSender>(true, std::move(playlist)); }
+	void			writeSegment(const Path& path, const Segment& segment, Parameters& params, const Segment* pInit = NULL);
+	void			writePlaylist(const Path& path, const Segments& segments, std::string&& format = "ts", UInt32 dvr = 0) { newSender<HTTPPlaylistSender>(true, path, segments, std::move(format), dvr); }
+	void			writeMasterPlaylist(const Path& path, const std::vector<const Publication*>& renditions) { newSender<HTTPMPlaylistSender>(true, path, renditions); }
 
 	BinaryWriter&   writeRaw(const char* code);
 	DataWriter&     writeResponse(const char* subMime);
@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/DataReader.h"
+#include <vector>
 
 namespace Mona {
 
@@ -30,12 +31,23 @@ struct JSONReader : DataReader, virtual Object {
 	bool				isValid() const { return _isValid; }
 	void				reset() { reader.reset(_pos); }
 
+	/*!
+	JSON size from which structural characters are indexed in a first pass (SIMD),
+	to get string sizes and array counts without scanning again the content */
+	static UInt32		IndexSize;
+
 private:
 	enum {
 		OBJECT =	OTHER,
 		ARRAY =		OTHER+1
 	};
 
+	struct Structural {
+		Structural(UInt32 position) : position(position), value(0) {}
+		UInt32 position;
+		UInt32 value; // string size on opening quote, element count on array
+	};
+
 	bool	readOne(UInt8 type, DataWriter& writer);
 	UInt8	followingType();
 
@@ -45,11 +57,17 @@ private:
 	bool			countArrayElement(UInt32& count);
 	const UInt8*	current();
 
+	bool				index();
+	const Structural*	structural(UInt32 position);
+
 	UInt32			_size;
 	Date			_date;
 	double			_number;
 	bool			_isValid;
 	UInt32			_pos;
+
+	std::vector<Structural>	_structurals;
+	UInt32					_cursor;
 };
 
 
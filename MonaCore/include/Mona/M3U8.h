@@ -44,6 +44,11 @@ struct M3U8 : virtual Static {
 		void    write(const std::string& format, UInt32 sequence, UInt16 duration) override;
 	};
 
+private:
+	/*!
+	Write LL-HLS parts of the segment sequence, returns iterator on the following parts */
+	static std::vector<Playlist::Part>::const_iterator WriteParts(const Playlist& playlist, UInt32 sequence, std::vector<Playlist::Part>::const_iterator it, Buffer& buffer);
+
 };
 
 } // namespace Mona
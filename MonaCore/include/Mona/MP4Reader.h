@@ -24,14 +24,19 @@ details (or else see http://www.gnu.org/licenses/).
 namespace Mona {
 
 /*!
-/!\ Don't support mp4 file with mdat before moov, used -movflags faststart with ffmpeg to avoid it (or a fragmented mp4 file)*/
+Reads also mp4 file with mdat before moov when the source is a file (jumps to moov and comes back, see MediaReader::seeking),
+"start" parameter (in milliseconds) starts the reading of a not fragmented file on the nearest previous key frame */
 struct MP4Reader : virtual Object, MediaReader {
 	// http://atomicparsley.sourceforge.net/mpeg-4files.html
 	// https://www.adobe.com/content/dam/Adobe/en/devnet/flv/pdfs/video_file_format_spec_v10.pdf
 	// https://developer.apple.com/library/content/documentation/QuickTime/QTFF/QTFFChap2/qtff2.html
 	// https://w3c.github.io/media-source/isobmff-byte-stream-format.html
 	// With fragments box = > http://l.web.umkc.edu/lizhu/teaching/2016sp.video-communication/ref/mp4.pdf
-	MP4Reader() : _propVersion(0), _boxes(1), _position(0), _failed(false), _offset(0), _videos(0), _audios(0), _datas(0), _firstMoov(true), _sequence(0) {}
+	MP4Reader() : _propVersion(0), _boxes(1), _position(0), _failed(false), _offset(0), _videos(0), _audios(0), _datas(0), _firstMoov(true), _sequence(0),
+		_start(0), _mdat(0), _seek(0), _tail(false) {}
+
+	void setParams(const Parameters& parameters) override { parameters.getNumber("start", _start = 0); }
+	bool seeking(UInt64& position) override;
 
 private:
 	
@@ -109,6 +114,7 @@ private:
 		std::vector<UInt32>			sizes;   // stsz
 		Durations					durations; // stts
 		std::deque<Repeat>			compositionOffsets; // ctts
+		std::vector<UInt32>			keys; // stss => sync sample numbers, every sample is sync if empty
 
 	private:
 		UInt8 _track;
@@ -119,6 +125,9 @@ private:
 
 	UInt32  parseData(const Packet& packet, Media::Source& source);
 	void	flushMedias(Media::Source& source);
+	/*!
+	Index the key frames of the chunks and skips the chunks before the nearest key frame of time, returns its position (0 if no seek) */
+	UInt64	seek(UInt32 time);
 
 	template<typename TagType>
 	void addMedia(UInt32 time, Track& track, const TagType& tag, const Packet& packet) {
@@ -136,7 +145,7 @@ private:
 	void	frameToMedias(Track& track, UInt32 time, const Packet& packet);
 
 	UInt32										_sequence;
-	UInt32										_position;
+	UInt64										_position;
 	UInt64										_offset;
 	bool										_failed;
 	UInt8										_audios;
@@ -156,6 +165,11 @@ private:
 
 	Media::Properties							_properties;
 	UInt32										_propVersion;
+
+	UInt32										_start;
+	UInt64										_mdat; // position of mdat box skipped to read moov at the end
+	UInt64										_seek;
+	bool										_tail; // moov at the end already read
 };
 
 
@@ -49,9 +49,20 @@ struct MP4Writer : MediaWriter, virtual Object {
 
 	MP4Writer(UInt16 bufferTime = BUFFER_RESET_SIZE);
 
+	/*!
+	Returns true if packet is the initialization part (ftyp+moov), in CMAF segment writing (see setEndTime)
+	it's written in a separated packet before fragments, it's the CMAF init segment */
+	static bool IsInit(const Packet& packet) { return packet.size() >= 8 && memcmp(packet.data() + 4, EXPAND("ftyp")) == 0; }
+
 	UInt32 currentTime() const { return _timeFront; }
 	UInt32 lastTme() const { return _timeBack; }
 
+	/*!
+	CMAF segment writing, fragments end exactly on endTime without silence added to smooth a next sequence,
+	to get consecutive segments without gap or overlap, and fragment sequence numbers follow the media time
+	to increase through the segments muxed separately */
+	void setEndTime(UInt32 time) { _pEndTime.set(time); }
+
 	const UInt16 bufferTime;
 
 	void beginMedia(const OnWrite& onWrite);
@@ -122,6 +133,7 @@ private:
 	std::deque<Frames>			_audios;
 	std::deque<Frames>			_videos;
 	std::deque<Frames>			_datas;
+	unique<UInt32>				_pEndTime;
 	UInt32						_sequence;
 	UInt32						_timeFront;
 	UInt32						_timeBack;
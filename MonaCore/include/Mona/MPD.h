@@ -0,0 +1,32 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#pragma once
+
+#include "Mona/Mona.h"
+#include "Mona/Playlist.h"
+
+namespace Mona {
+
+struct MPD : virtual Static {
+	/*!
+	Write a DASH MPD with one CMAF representation, type dynamic (live-memory) or static if playlist is ended,
+	segments are the same fMP4 fragments than HLS ones (same URLs), with init segment NAME.init.mp4
+	https://dashif.org/docs/DASH-IF-IOP-v4.3.pdf */
+	static Buffer& Write(const Playlist& playlist, Buffer& buffer);
+};
+
+} // namespace Mona
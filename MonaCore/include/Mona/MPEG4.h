@@ -23,9 +23,31 @@ details (or else see http://www.gnu.org/licenses/).
 
 namespace Mona {
 
+/*!
+BitReader of H264/HEVC NAL which ignores the emulation prevention byte 03 of a serie of 0x000003 */
+struct BitstreamReader : BitReader, virtual Object {
+	BitstreamReader(const UInt8* data, UInt32 size) : BitReader(data, size) {}
+private:
+	void nextByte() {
+		if (++_current != _end && position() >= 16 && *_current == 3 && *(_current - 1) == 0 && *(_current - 2) == 0)
+			++_current; // ignore 0x03 after two 0x00
+	}
+};
+
 struct MPEG4 : virtual Static {
 
+	/*!
+	Read ue(v) and se(v) Exp-Golomb codes */
 	static UInt16	ReadExpGolomb(BitReader& reader);
+	static Int16	ReadSignedExpGolomb(BitReader& reader) {
+		UInt16 value(ReadExpGolomb(reader));
+		return (value & 1) ? Int16((value + 1) / 2) : -Int16(value / 2);
+	}
+	/*!
+	Find the next Annex-B start code 00 00 01 of a H264/HEVC byte stream (vectorized when possible),
+	returns the position of the 01 byte or end if not found.
+	zeros is the count of zero bytes ending the previous data, to detect a start code astride two buffers */
+	static const UInt8* FindStartCode(const UInt8* data, const UInt8* end, UInt8 zeros = 0);
 
 	static UInt8	ReadAudioConfig(const UInt8* data, UInt32 size, UInt32& rate, UInt8& channels);
 	static UInt8	ReadAudioConfig(const UInt8* data, UInt32 size, UInt8& rateIndex, UInt8& channels);
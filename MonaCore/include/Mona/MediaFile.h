@@ -23,6 +23,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/MediaWriter.h"
 #include "Mona/Segments.h"
 #include "Mona/MediaStream.h"
+#include <atomic>
 
 namespace Mona {
 
@@ -30,6 +31,10 @@ namespace Mona {
 struct MediaFile : virtual Static  {
 
 	struct Reader : MediaStream, virtual Object {
+		/*!
+		Process-wide memory budget in bytes of the demuxed medias kept to be shared between readers of a same file */
+		static UInt64 CacheSize;
+
 		static unique<MediaFile::Reader> New(Exception& ex, const char* request, Media::Source& source, const Timer& timer, IOFile& io, std::string&& format = "");
 	
 		Reader(const Path& path, unique<MediaReader>&& pReader, Media::Source& source, const Timer& timer, IOFile& io);
@@ -40,6 +45,9 @@ struct MediaFile : virtual Static  {
 		const Timer&	timer;
 
 		const MediaReader* operator->() const { return _pReader.get(); }
+		/*!
+		Duration in ms of the medias decoded ahead of the playing position */
+		UInt32			buffered() const;
 
 	private:
 		bool starting(const Parameters& parameters);
@@ -51,23 +59,36 @@ struct MediaFile : virtual Static  {
 		private:
 			UInt32 _lost;
 		};
+		/*!
+		Medias decoded, given by the decoder to the main thread */
+		struct Medias : std::deque<unique<Media::Base>>, virtual Object {
+			Medias() : reading(true), eof(false), time(0), readSize(0xFFFF) {}
+			bool	reading; // false when the decoder stops to read (read-ahead reached or end of file)
+			bool	eof; // end of file
+			UInt32	time; // last media time decoded
+			UInt32	readSize; // read size adapted to the bitrate, to resume reading
+		};
+		/*!
+		Decoder reads ahead pReadAhead milliseconds of medias and adapts the size of its reads to the media bitrate */
 		struct Decoder : File::Decoder, private Media::Source, virtual Object {
-			typedef Event<void()>	ON(Flush);
+			typedef Event<void(const shared<Medias>&)>	ON(Flush);
 
-			Decoder(const Handler& handler, const shared<MediaReader>& pReader, const Path& path, const std::string& name, const shared<std::deque<unique<Media::Base>>>& pMedias) :
-				_name(name), _handler(handler), _pReader(pReader), _path(path), _pMedias(pMedias) {}
+			Decoder(const Handler& handler, const shared<MediaReader>& pReader, File& file, const std::string& name, const shared<const std::atomic<UInt32>>& pReadAhead) :
+				_name(name), _handler(handler), _pReader(pReader), _file(file), _pReadAhead(pReadAhead), _pMedias(SET), _paused(true), _readen(0), _beginTime(0), _time(0), _size(0xFFFF) {}
 
 		private:
 			UInt32 decode(shared<Buffer>& pBuffer, bool end) override;
 
-			void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) { if(!_mediaTimeGotten) _mediaTimeGotten = !tag.isConfig; writeMedia<Media::Audio>(tag, packet, track); }
-			void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) { if (!_mediaTimeGotten) _mediaTimeGotten = tag.frame != Media::Video::FRAME_CONFIG; writeMedia<Media::Video>(tag, packet, track); }
+			void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) { if(!tag.isConfig) setTime(tag.time); writeMedia<Media::Audio>(tag, packet, track); }
+			void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) { if (tag.frame != Media::Video::FRAME_CONFIG) setTime(tag.time); writeMedia<Media::Video>(tag, packet, track); }
 			void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) { writeMedia<Media::Data>(type, packet, track); }
 			void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) { writeMedia<Media::Data>(type, packet, track, true); }
 			void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) { writeMedia<Lost>(type, lost, track); }
 			void flush() { } // do nothing on source flush, to do the flush in end of file reading!
 			void reset() { _pMedias->emplace_back(); }
 
+			void setTime(UInt32 time);
+
 			template <typename MediaType, typename ...Args>
 			void writeMedia(Args&&... args) {
 				_pMedias->emplace_back();
@@ -77,23 +98,81 @@ struct MediaFile : virtual Static  {
 			shared<MediaReader>		_pReader;
 			std::string				_name;
 			const Handler&			_handler;
-			Path					_path;
+			File&					_file;
+			const shared<const std::atomic<UInt32>> _pReadAhead; // changed by the main thread when readers join or leave
 			bool					_mediaTimeGotten;
-			
-			shared<std::deque<unique<Media::Base>>> _pMedias;
+			shared<Medias>			_pMedias;
+
+			// read-ahead window, from the first media time after a pause
+			bool					_paused;
+			UInt64					_readen;
+			UInt32					_beginTime;
+			UInt32					_time;
+			UInt32					_size;
 		};
 
-		Decoder::OnFlush		_onFlush;
+		/*!
+		Demuxer of a file, shared process-wide between the readers which start this file at nearby times:
+		medias are kept from the beginning of the file while CacheSize allows it, then released once played by all its readers */
+		struct Demuxer : virtual Object {
+			Demuxer(const Path& path, const char* subMime, const Parameters& parameters, IOFile& io, const std::string& name);
+			~Demuxer();
+
+			const Path			path;
+			IOFile&				io;
+			std::set<Reader*>	readers;
+			/*!
+			Read-ahead in ms of the decoding, the greatest of its readers */
+			UInt32	readAhead() const { return *_pReadAhead; }
+			/*!
+			Compute read-ahead again after a change of readers */
+			void	setReadAhead();
+
+			/*!
+			Returns a shared demuxer for this file if joinable, else a new demuxer (shared if parameters allow it) */
+			static shared<Demuxer> Join(const Path& path, const char* subMime, const Parameters& parameters, IOFile& io, const std::string& name);
+
+			UInt64	begin() const { return _begin; } // index of the first media kept
+			UInt64	end() const { return _begin + _medias.size(); } // index after the last media decoded
+			UInt32	time() const { return _time; } // last media time decoded
+			bool	ended() const { return _end; }
+			const shared<Media::Base>& operator[](UInt64 index) const { return _medias[size_t(index - _begin)]; }
+
+			/*!
+			Resume reading if paused */
+			void read();
+			/*!
+			Release medias played by all the readers, excepting the beginning of the file kept for the readers to come.
+			Over CacheSize releases too medias played by the fastest reader, then slower readers skip them */
+			void release();
 
-		File::OnError			_onFileError;
+		private:
+			Decoder::OnFlush		_onFlush;
+			File::OnError			_onFileError;
+			shared<MediaReader>		_pReader;
+			shared<File>			_pFile;
+			std::string				_key; // empty if not shared
+			shared<std::atomic<UInt32>>	_pReadAhead;
+
+			std::deque<shared<Media::Base>>	_medias;
+			UInt64					_begin;
+			UInt64					_size;
+			UInt32					_time;
+			UInt32					_readSize;
+			bool					_reading;
+			bool					_end;
+
+			static std::mutex									_Mutex;
+			static std::map<std::string, weak<Demuxer>>		_Demuxers;
+		};
 
 		shared<MediaReader>		_pReader;
-		shared<File>			_pFile;
-		shared<Decoder>			_pDecoder;
+		shared<Demuxer>			_pDemuxer;
+		UInt64					_index;
+		UInt32					_readAhead; // reading resumed when less than the half is buffered
 
 		Timer::OnTimer			_onTimer;
 		Time					_realTime;
-		shared<std::deque<unique<Media::Base>>> _pMedias;
 	};
 
 
@@ -107,6 +186,8 @@ struct MediaFile : virtual Static  {
 		const Path	path;
 		IOFile&		io;
 		UInt64		queueing() const { return _pFile ? _pFile->queueing() : 0; }
+		UInt32		latency() const { return _pFile ? UInt32(_pFile->latency) : 0; } // last write latency in microseconds, from its queueing to disk
+		UInt32		maxLatency() const { return _pFile ? UInt32(_pFile->maxLatency) : 0; } // max write latency in microseconds, from queueing to disk
 		bool		segmented() const { return _pPlaylistWriter.operator bool(); }
 		UInt32		segments() const { return _segments; }
 
@@ -138,6 +219,9 @@ struct MediaFile : virtual Static  {
 			~File();
 
 			File& open(bool append = true);
+			/*!
+			Write the block being coalesced */
+			void flush();
 			bool segmented() const { return _pPlaylistWriter.operator bool(); }
 
 			MediaWriter*	operator->() { return _pWriter.get(); }
@@ -146,9 +230,18 @@ struct MediaFile : virtual Static  {
 			const std::string				name;
 			MediaWriter::OnWrite			onWrite;
 			UInt32							segments;
+			// recorder I/O, see Mona::File writing policy
+			UInt32							block; // coalesces writes in aligned blocks of this size (0 = disabled)
+			UInt32							extent;
+			UInt32							syncSize;
+			UInt32							syncInterval;
+			std::atomic<UInt32>				latency;
+			std::atomic<UInt32>				maxLatency;
 		private:
 			const shared<Playlist::Writer>	_pPlaylistWriter;
 			shared<MediaWriter>				_pWriter;
+			shared<Buffer>					_pBlock;
+			UInt64							_offset; // file position of _pBlock
 		};
 
 
@@ -188,7 +281,10 @@ struct MediaFile : virtual Static  {
 		};
 		struct End : Write, virtual Object {
 			End(const shared<File>& pFile) : Write(pFile) {}
-			void process(Exception& ex, File& file) { file->endMedia(file.onWrite); }
+			void process(Exception& ex, File& file) {
+				file->endMedia(file.onWrite);
+				file.flush();
+			}
 		};
 
 		shared<File>			 _pFile;
@@ -197,6 +293,10 @@ struct MediaFile : virtual Static  {
 		bool					 _append;
 		UInt16					 _duration;
 		UInt32					 _segments;
+		UInt32					 _block;
+		UInt32					 _extent;
+		UInt32					 _syncSize;
+		UInt32					 _syncInterval;
 		shared<Playlist::Writer> _pPlaylistWriter;
 	};
 };
@@ -33,13 +33,20 @@ struct MediaReader : virtual Object, private StreamData<Media::Source&> {
 
 	void		 read(const Packet& packet, Media::Source& source);
 	virtual void flush(Media::Source& source);
+	/*!
+	Random access for file reading, returns true when the reader requires to continue the reading from an other position
+	(index box at the end of the file, or start time parameter), data given after the read call must then begin at this position */
+	virtual bool seeking(UInt64& position) { return false; }
+	/*!
+	Set to true by the caller which supports seeking (file reading) */
+	bool		 seekable;
 
 	const char*			format() const;
 	MIME::Type			mime() const;
 	virtual const char*	subMime() const; // Keep virtual to allow to RTPReader to redefine it
 
 protected:
-	MediaReader() {}
+	MediaReader() : seekable(false) {}
 	
 	virtual void	onFlush(Packet& buffer, Media::Source& source);
 private:
@@ -158,23 +158,27 @@ struct MediaSocket : virtual Static {
 		protected:
 			MediaWriter::OnWrite	onWrite;
 			shared<MediaWriter>		pWriter;
+			/*!
+			Send the frame parts gathered in scatter mode */
+			void flush();
 		private:
-			virtual bool run(Exception& ex) { pWriter->beginMedia(onWrite); return true; }
+			virtual bool run(Exception& ex) { pWriter->beginMedia(onWrite); flush(); return true; }
 
 			shared<Socket>			_pSocket;
 			shared<std::string>		_pName;
 			Socket::OnError			_onSocketError;
+			std::deque<Packet>		_packets;
 		};
 
 		template<typename MediaType>
 		struct MediaSend : Send, MediaType, virtual Object {
 			MediaSend(MediaStream::Type type, const shared<std::string>& pName, const shared<Socket>& pSocket, const shared<MediaWriter>& pWriter,
 				UInt8 track, const typename MediaType::Tag& tag, const Packet& packet) : Send(type, pName, pSocket,pWriter), MediaType(tag, packet, track) {}
-			bool run(Exception& ex) { pWriter->writeMedia(*this, onWrite); return true; }
+			bool run(Exception& ex) { pWriter->writeMedia(*this, onWrite); flush(); return true; }
 		};
 		struct EndSend : Send, virtual Object {
 			EndSend(MediaStream::Type type, const shared<std::string>& pName, const shared<Socket>& pSocket, const shared<MediaWriter>& pWriter) : Send(type, pName, pSocket, pWriter) {}
-			bool run(Exception& ex) { pWriter->endMedia(onWrite); return true; }
+			bool run(Exception& ex) { pWriter->endMedia(onWrite); flush(); return true; }
 		};
 
 		Socket::OnDisconnection			_onSocketDisconnection;
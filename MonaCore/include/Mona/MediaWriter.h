@@ -40,6 +40,12 @@ struct MediaWriter : virtual Object {
 
 	typedef std::function<void(const Packet& packet)> OnWrite;
 
+	MediaWriter() : scatter(false) {}
+	/*!
+	If true the writer can give a frame in many parts referencing the media packet rather than copying it in one packet (see TSWriter),
+	onWrite must concatenate the parts (to enable just when onWrite doesn't expect one packet by frame, as a stream socket) */
+	bool scatter;
+
 	/*!
 	Initialize the media and its variable */
 	virtual void beginMedia(const OnWrite& onWrite) {}
@@ -27,12 +27,20 @@ struct Playlist : Path, virtual Object {
 	NULLABLE(_durations.empty())
 
 	/*!
-	Playlist master, path+name+bandwidth */
+	Playlist master, path+name+renditions */
 	struct Master : Path {
 		NULLABLE(items.empty())
+		struct Item : virtual Object {
+			Item() : bandwidth(0), averageBandwidth(0), width(0), height(0) {}
+			UInt64		bandwidth; // peak bits/s
+			UInt64		averageBandwidth; // bits/s, 0 if unknown
+			UInt16		width; // 0 if unknown
+			UInt16		height;
+			std::string	codecs; // RFC 6381 codecs, empty if unknown
+		};
 		Master(const Path& path) : Path(path) {}
 		Master(Master&& playlist) : Path(std::move(playlist)), items(std::move(playlist.items)) {}
-		std::map<std::string, UInt64> items;
+		std::map<std::string, Item> items;
 	};
 	/*!
 	Write a master playlist */
@@ -40,7 +48,7 @@ struct Playlist : Path, virtual Object {
 
 
 	/*!
-	Write a playlist type static (VOD or live-memory) */
+	Write a playlist type static (VOD or live-memory), type is the playlist extension: m3u8 or mpd */
 	static bool Write(Exception& ex, const std::string& type, const Playlist& playlist, Buffer& buffer);
 	/*!
 	Write a playlist type event (file) */
@@ -59,11 +67,25 @@ struct Playlist : Path, virtual Object {
 	/*!
 	Represents a playlist, fix maxDuration on item addition and sequence on remove item
 	Path must informs on name and format playlist by its extension: ts/mp4 */
-	Playlist(const Path& path) : Path(path), sequence(0), maxDuration(0), _duration(0) {}
+	Playlist(const Path& path) : Path(path), sequence(0), maxDuration(0), partDuration(0), time(0), startTime(0), bandwidth(0), _duration(0) {}
 
+	/*!
+	LL-HLS part of the segment sequence */
+	struct Part {
+		UInt32	sequence;
+		UInt16	index;
+		UInt16	duration;
+		bool	independent;
+	};
 
 	UInt32						sequence;
 	UInt16						maxDuration;
+	UInt16						partDuration; // LL-HLS part target duration, 0 if playlist has no parts
+	std::vector<Part>			parts; // LL-HLS parts of the last segments and of the segment in building
+	UInt32						time; // media time of the first item
+	Int64						startTime; // wall clock time of the media time 0 for a live playlist (DASH availabilityStartTime), 0 if unknown
+	UInt32						bandwidth; // bits/s, 0 if unknown
+	std::string					codecs; // RFC 6381 codecs, empty if unknown
 	UInt32						duration() const { return _duration; }
 	const std::deque<UInt16>	durations() const { return _durations; }
 	UInt32						count() const { return _durations.size(); }
@@ -92,8 +92,13 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 	UInt32							lastTime() const;
 
 	const std::set<Subscription*>	subscriptions;
+	/*!
+	To call on subscriptions change (subscribe, unsubscribe, data track selection) to recount text consumers */
+	void							textsChange() { _texts = -1; }
 
-	void							start(unique<MediaFile::Writer>&& pRecorder = nullptr);
+	/*!
+	Start publication, with recording if pRecorder, dvr is the folder of the DVR ring written by pIOFile if "dvr" parameter sets a retention */
+	void							start(unique<MediaFile::Writer>&& pRecorder = nullptr, const Path& dvr = Path::Null(), IOFile* pIOFile = NULL);
 	void							reset();
 	typedef std::function<void()>	OnStop;
 	void							stop(const OnStop& onStop = nullptr);
@@ -102,6 +107,10 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 
 	MediaFile::Writer*				recorder();
 	bool							recording() const { return _pRecording && _pRecording->target<MediaFile::Writer>().state()>0; }
+	/*!
+	Recording backlog, bytes queued to write and latency in microseconds of the last write from its queueing to disk (0 without recording) */
+	UInt64							recordingQueueing() const { return _pRecording ? _pRecording->target<MediaFile::Writer>().queueing() : 0; }
+	UInt32							recordingLatency() const { return _pRecording ? _pRecording->target<MediaFile::Writer>().latency() : 0; }
 
 	void							reportLost(Media::Type type, UInt32 lost, UInt8 track = 0);
 
@@ -130,6 +139,9 @@ struct Publication : Media::Source, Media::Properties, virtual Object {
 
 private:
 	void flushProperties();
+	/*!
+	Returns true if closed captions have to be extracted, just if text tracks have a consumer (count cached until textsChange) */
+	bool captioning() const;
 	void stopRecording();
 
 	// Media::Properties overrides
@@ -152,6 +164,7 @@ private:
 	bool							_new;
 	bool							_newLost;
 	UInt32							_propVersion;
+	mutable Int32					_texts; // text consumers count, -1 to recount
 
 	unique<Subscription>			_pRecording;
 
@@ -24,6 +24,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/ThreadPool.h"
 #include "Mona/Socket.h"
 #include "Mona/Crypto.h"
+#include "Mona/DiffieHellman.h"
 #include "Mona/Client.h"
 #include "Mona/RendezVous.h"
 
@@ -83,9 +84,9 @@ struct RTMFP : virtual Static {
 	};
 
 	struct Engine : virtual Object {
-		Engine(const UInt8* key) : _context(EVP_CIPHER_CTX_new()) { memcpy(_key, key, KEY_SIZE); EVP_CIPHER_CTX_init(_context);	}
-		Engine(const Engine& engine) : _context(EVP_CIPHER_CTX_new()) { memcpy(_key, engine._key, KEY_SIZE); EVP_CIPHER_CTX_init(_context); }
-		virtual ~Engine() { EVP_CIPHER_CTX_cleanup(_context); EVP_CIPHER_CTX_free(_context); }
+		Engine(const UInt8* key) : _decoder(NewContext(key, 0)), _encoder(NewContext(key, 1)) { memcpy(_key, key, KEY_SIZE); }
+		Engine(const Engine& engine) : Engine(engine._key) {}
+		virtual ~Engine() { EVP_CIPHER_CTX_free(_decoder); EVP_CIPHER_CTX_free(_encoder); }
 
 		bool			decode(Exception& ex, Buffer& buffer, const SocketAddress& address);
 		shared<Buffer>&	encode(shared<Buffer>& pBuffer, UInt32 farId, const SocketAddress& address);
@@ -99,10 +100,13 @@ struct RTMFP : virtual Static {
 		void	encode(const shared<Buffer>& pBuffer, UInt32 farId);
 
 		static Engine& Default() { thread_local Engine Engine(BIN "Adobe Systems 02"); return Engine; }
+		// cipher context initialized one time with its key (key schedule kept), just IV is reset by packet
+		static EVP_CIPHER_CTX* NewContext(const UInt8* key, int enc);
 
 		enum { KEY_SIZE = 0x10 };
 		UInt8							_key[KEY_SIZE];
-		EVP_CIPHER_CTX*					_context;
+		EVP_CIPHER_CTX*					_decoder;
+		EVP_CIPHER_CTX*					_encoder;
 	};
 
 	struct Handshake : Packet, virtual Object {
@@ -156,6 +160,28 @@ struct RTMFP : virtual Static {
 		std::atomic<Int64>			initiatorTime;
 	};
 
+	/*!
+	Pool of Diffie-Hellman keypairs generated in background for handshakes,
+	to not do the costly keypair generation while a handshake is waiting (connection storms) */
+	struct KeyPool : virtual Object {
+		KeyPool(const ThreadPool& threadPool, UInt32 capacity) : _threadPool(threadPool), _pKeys(SET), _capacity(capacity) { fill(); }
+
+		/*!
+		Get a DiffieHellman with its keypair already computed, compute it in place if the pool is empty */
+		unique<DiffieHellman> pop(Exception& ex);
+	private:
+		struct Keys : std::deque<unique<DiffieHellman>>, virtual Object {
+			Keys() : filling(false) {}
+			std::mutex	mutex;
+			bool		filling;
+		};
+		void fill();
+
+		const ThreadPool&	_threadPool;
+		shared<Keys>		_pKeys;
+		const UInt32		_capacity;
+	};
+
 	struct Output : virtual Object {
 		virtual shared<RTMFPWriter>	newWriter(UInt64 flowId, const Packet& signature) = 0;
 		virtual UInt64				resetWriter(UInt64 id) = 0;
@@ -172,6 +198,12 @@ struct RTMFP : virtual Static {
 
 	static UInt32			ReadID(Buffer& buffer);
 
+	/*!
+	Cookie = session id (4 bytes) + HMAC-SHA256(id + address) (32 bytes) + random, with a secret key of the process,
+	to check cheaply before any crypto that a 38 handshake answers to a 30 handshake really sent by this server to this address */
+	static BinaryWriter&	WriteCookie(BinaryWriter& writer, UInt32 id, const SocketAddress& address);
+	static bool				CheckCookie(const UInt8* cookie, const SocketAddress& address);
+
 	static UInt16			TimeNow() { return Time(Mona::Time::Now()); }
 	static UInt16			Time(Int64 time) { return UInt16(time / RTMFP::TIMESTAMP_SCALE); }
 
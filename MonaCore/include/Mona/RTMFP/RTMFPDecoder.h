@@ -28,19 +28,25 @@ struct RTMFPDecoder : Socket::Decoder, virtual Object {
 	typedef Event<void(RTMFP::EdgeMember&)>			ON(EdgeMember);
 	typedef Event<void(shared<RTMFP::Session>&)>	ON(Session);
 
-	RTMFPDecoder(const shared<RendezVous>& pRendezVous, const Handler& handler, const ThreadPool& threadPool);
+	/*!
+	Handshakes are received in handshakeThreads and configured with RTMFP parameters:
+	- handshakeKeys, capacity of the pool of Diffie-Hellman keypairs generated in background by handshakeThreads
+	- handshakeQueue, maximum of handshake packets waiting handshakeThreads, beyond packets are ignored
+	- handshakeRate, maximum of Diffie-Hellman computations by second (0 = unlimited), beyond 38 handshakes are ignored (client repeats it) */
+	RTMFPDecoder(const shared<RendezVous>& pRendezVous, const Handler& handler, const ThreadPool& threadPool, const ThreadPool& handshakeThreads, const Parameters& parameters);
 
 private:
 	void decode(shared<Buffer>& pBuffer, const SocketAddress& address, const shared<Socket>& pSocket) override;
 
 	struct Handshake;
+	struct Handshaking;
 	bool finalizeHandshake(UInt32 id, const SocketAddress& address, shared<RTMFPReceiver>& pReceiver);
 
 	template<typename ReceiverType>
-	void receive(const shared<ReceiverType>& pReceiver, shared<Buffer>& pBuffer, const SocketAddress& address, const shared<Socket>& pSocket) {
+	void receive(const ThreadPool& threadPool, const shared<ReceiverType>& pReceiver, shared<Buffer>& pBuffer, const SocketAddress& address, const shared<Socket>& pSocket, const shared<std::atomic<UInt32>>& pReceiving, UInt32 receiving) {
 		struct Receive : Runner, virtual Object {
-			Receive(const shared<ReceiverType>& pReceiver, shared<Buffer>& pBuffer, const SocketAddress& address, const shared<Socket>& pSocket, const shared<std::atomic<UInt32>>& pReceiving) : Runner(TypeOf<ReceiverType>().c_str()), _pReceiving(pReceiving), _weakReceiver(pReceiver), _pBuffer(std::move(pBuffer)), _address(address), _pSocket(pSocket) {
-				*_pReceiving += (_receiving = _pBuffer->size());
+			Receive(const shared<ReceiverType>& pReceiver, shared<Buffer>& pBuffer, const SocketAddress& address, const shared<Socket>& pSocket, const shared<std::atomic<UInt32>>& pReceiving, UInt32 receiving) : Runner(TypeOf<ReceiverType>().c_str()), _pReceiving(pReceiving), _weakReceiver(pReceiver), _pBuffer(std::move(pBuffer)), _address(address), _pSocket(pSocket) {
+				*_pReceiving += (_receiving = receiving);
 			}
 			~Receive() {
 				*_pReceiving -= _receiving;
@@ -59,11 +65,12 @@ private:
 			shared<std::atomic<UInt32>>	_pReceiving;
 			UInt32						_receiving;
 		};
-		_threadPool.queue<Receive>(pReceiver->track, pReceiver, pBuffer, address, pSocket, _pReceiving);
+		threadPool.queue<Receive>(pReceiver->track, pReceiver, pBuffer, address, pSocket, pReceiving, receiving);
 	}
 
 
 	const ThreadPool&		_threadPool;
+	const ThreadPool&		_handshakeThreads;
 	const Handler&			_handler;
 
 	std::map<UInt32, shared<RTMFPReceiver>>																	  _receivers;
@@ -71,6 +78,9 @@ private:
 	std::map<SocketAddress, shared<Handshake>>																  _handshakes;
 	shared<RendezVous>																						  _pRendezVous;
 	shared<std::atomic<UInt32>>																				  _pReceiving;
+	shared<std::atomic<UInt32>>																				  _pHandshakesWaiting;
+	UInt32																									  _handshakeQueue;
+	shared<Handshaking>																						  _pHandshaking;
 };
 
 
@@ -49,6 +49,7 @@ private:
 	RTMFPDecoder::OnEdgeMember	_onEdgeMember;
 	RTMFPDecoder::OnSession		_onSession;
 	shared<RendezVous>			_pRendezVous;
+	unique<ThreadPool>			_pHandshakeThreads; // dedicated to handshakes to not saturate api.threadPool on connection storms
 	
 	UInt8						_certificat[77];
 };
@@ -57,6 +57,15 @@ struct RTMP : virtual Static {
 		}
 	};
 
+	/*!
+	Outbound settings of a RTMP session, configurable with RTMP parameters */
+	struct Settings : virtual Object {
+		Settings() : chunkSize(0), aggregateSize(0), aggregateTime(0) {}
+		UInt32	chunkSize; // outbound chunk size, 0 means no chunking
+		UInt32	aggregateSize; // max size of an aggregate message, 0 disables audio/video aggregation
+		UInt16	aggregateTime; // max media duration in ms gathered in one aggregate message
+	};
+
 	struct Request : virtual Object, Packet {
 		Request(AMF::Type type, UInt32 time, UInt32 channelId, UInt32 streamId, UInt32 ackBytes, const Packet& packet, bool flush) :
 			Packet(std::move(packet)), type(type), time(time), ackBytes(ackBytes), channelId(channelId), streamId(streamId), flush(flush) {}
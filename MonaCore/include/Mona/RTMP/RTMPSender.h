@@ -33,13 +33,25 @@ public:
 			   const shared<RTMP::Channel>& pChannel,
 			   const shared<Socket>& pSocket,
 			   const shared<RC4_KEY>& pEncryptKey,
+			   const shared<UInt32>& pChunkSize,
 			   Media::Data::Type packetType,
 			   const Packet& packet);
 
 	AMFWriter	writer;
 
+	/*!
+	Gather an audio/video message sender in this AMF::TYPE_AGGREGATE sender,
+	returns the size of the aggregate body (frame prefixes written later by FlashWriter are estimated) */
+	UInt32		aggregate(const shared<RTMPSender>& pSender);
+
 private:
 	bool run(Exception&);
+	/*!
+	Append the chunked RTMP message (header + body slices + continuation headers) to packets, without copy */
+	void build(std::deque<Packet>& packets);
+	/*!
+	Send gathered segments in one writing, for RTMPE they are ciphered in one RC4 pass to one new Buffer by call */
+	static int  Send(Exception& ex, Socket& socket, RC4_KEY* pEncryptKey, const std::deque<Packet>& packets);
 
 	AMF::Type				_type;
 	UInt32					_time;
@@ -48,8 +60,26 @@ private:
 	Packet					_packet;
 
 	shared<RC4_KEY>			_pEncryptKey;
+	shared<UInt32>			_pChunkSize; // outbound chunk size, updated on TYPE_CHUNKSIZE sending
 	shared<Socket>			_pSocket;
 	shared<RTMP::Channel>	_pChannel;
+
+	std::vector<shared<RTMPSender>>	_aggregation;
+	UInt32							_aggregateSize;
+
+	friend struct RTMPSenders;
+};
+
+/*!
+Send the messages of many RTMPSender in one time (one flush of a RTMPWriter),
+to do just one socket writing and for RTMPE just one RC4 pass on all gathered segments */
+struct RTMPSenders : Runner, virtual Object {
+	RTMPSenders(std::deque<shared<RTMPSender>>& senders) : Runner("RTMPSenders"), _senders(std::move(senders)) {}
+
+private:
+	bool run(Exception&);
+
+	std::deque<shared<RTMPSender>>	_senders;
 };
 
 
@@ -33,6 +33,7 @@ private:
 	bool			manage();
 	void			flush();
 	void			kill(Int32 error=0, const char* reason = NULL) override;
+	void			onParameters(const Parameters& parameters) override;
 	
 	Socket::Decoder*			newDecoder();
 	RTMPDecoder::OnRequest	   _onRequest;
@@ -42,6 +43,8 @@ private:
 	RTMPWriter					_controller;
 	FlashMainStream				_mainStream;
 	shared<RC4_KEY>				_pEncryptKey;
+	RTMP::Settings				_settings;
+	shared<UInt32>				_pChunkSize; // outbound chunk size, used by RTMPSender in the sending thread
 };
 
 
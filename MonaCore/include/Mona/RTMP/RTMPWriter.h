@@ -27,29 +27,38 @@ namespace Mona {
 
 
 struct RTMPWriter : FlashWriter, virtual Object {
-	RTMPWriter(UInt32 channelId, TCPClient& client, const shared<RC4_KEY>& pEncryptKey);
+	RTMPWriter(UInt32 channelId, TCPClient& client, const shared<RC4_KEY>& pEncryptKey, const shared<UInt32>& pChunkSize, const RTMP::Settings& settings);
 
 	UInt64			queueing() const { return _client->queueing(); }
 
 	UInt32			streamId;
 
-	void			clear() { _senders.clear(); FlashWriter::clear(); }
+	void			clear() { _senders.clear(); _pAggregate.reset(); FlashWriter::clear(); }
 
 	void			writePing(const Time& connectionTime) { write(AMF::TYPE_RAW)->write16(0x0006).write32(range<UInt32>(connectionTime.elapsed())); }
 
 	void			writeAck(UInt32 count) { write(AMF::TYPE_ACK)->write32(count); }
 	void			writeWinAckSize(UInt32 value) { write(AMF::TYPE_WIN_ACKSIZE)->write32(value); }
+	void			writeChunkSize(UInt32 value) { write(AMF::TYPE_CHUNKSIZE)->write32(value && value < 0x7FFFFFFF ? value : 0x7FFFFFFF); }
 	void			writeProtocolSettings();
 
 private:
 	AMFWriter&		write(AMF::Type type, UInt32 time=0, Media::Data::Type packetType = Media::Data::TYPE_AMF, const Packet& packet=Packet::Null(), bool reliable = true);
 	void			flushing();
+	void			closing(Int32 error, const char* reason = NULL);
 	
 	shared<RTMP::Channel>			_pChannel; // Output channel
 	TCPClient&						_client;
 	const shared<RC4_KEY>&			_pEncryptKey;
+	const shared<UInt32>&			_pChunkSize;
 
 	std::deque<shared<RTMPSender>>	_senders;
+	const RTMP::Settings&			_settings;
+
+	// aggregation of audio/video messages (AMF::TYPE_AGGREGATE)
+	shared<RTMPSender>				_pAggregate; // opened aggregate, always the last of _senders
+	UInt32							_aggregateTime;
+	Time							_aggregateOpening;
 };
 
 
@@ -29,6 +29,9 @@ struct RTMProtocol : TCProtocol, virtual Object {
 
 		setNumber("port", pTLS ? 8443 : 1935);
 		setNumber("timeout", 60); // 60 seconds
+		setNumber("chunkSize", 0); // no chunking by default (0x7FFFFFFF)
+		setNumber("aggregateSize", 0); // no audio/video aggregation by default
+		setNumber("aggregateTime", 100); // 100 ms
 
 		onConnection = [this](const shared<Socket>& pSocket) {
 			// Create session
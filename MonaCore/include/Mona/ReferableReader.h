@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 
 #include "Mona/Mona.h"
 #include "Mona/DataReader.h"
+#include <unordered_map>
 
 namespace Mona {
 
@@ -60,7 +61,7 @@ private:
 	void		endRepeatable(Reference* pReference) { if(pReference) --pReference->level; }
 	void		writeRepeatable(UInt64 readerRef, UInt64 writerRef);
 
-	std::map<UInt64, Reference> _references;
+	std::unordered_map<UInt64, Reference> _references;
 	bool						_recursive;
 };
 
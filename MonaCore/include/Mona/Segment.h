@@ -46,21 +46,40 @@ struct Segment : virtual Object  {
 	Read sequence and duration from name and returns size of basename, if file is not in a segment format NAME.S###.EXT returns string::npos */
 	static std::size_t ReadName(const std::string& name, UInt32& sequence, UInt16& duration);
 	/*!
+	Format LL-HLS part name in the format NAME.S~P with S the sequence number of its segment and P the part index */
+	template<typename BufferType>
+	static BufferType& WritePartName(const std::string& name, UInt32 sequence, UInt16 part, BufferType& buffer) {
+		return String::Append(buffer, name, '.', sequence, '~', part);
+	}
+	/*!
+	Read sequence and part index from name and returns size of basename, if file is not in a part format NAME.S~P.EXT returns string::npos */
+	static std::size_t ReadPartName(const std::string& name, UInt32& sequence, UInt16& part);
+	/*!
+	Format CMAF init segment name in the format NAME.init */
+	template<typename BufferType>
+	static BufferType& WriteInitName(const std::string& name, BufferType& buffer) {
+		return String::Append(buffer, name, ".init");
+	}
+	/*!
+	Returns size of basename if name is in the init segment format NAME.init, string::npos otherwise */
+	static std::size_t ReadInitName(const std::string& name);
+	/*!
 	Build segment path in the format PARENT/BASENAME.S### with S the sequence number and ### duration encoded */
 	static Path BuildPath(const Path& path, UInt32 sequence, UInt16 duration) {
 		std::string buffer;
 		return Path(path.parent(), path.baseName(), '.', sequence, WriteDuration(duration, buffer), '.', path.extension());
 	}
 	
-	Segment() : _lastTime(0), _discontinuous(false) {}
+	Segment() : _lastTime(0), _discontinuous(false), _pCache(SET) {}
 	Segment(const Segment& segment) : _lastTime(segment._lastTime), 
-		_discontinuous(segment._discontinuous), _medias(segment._medias) {
+		_discontinuous(segment._discontinuous), _medias(segment._medias), _pCache(segment._pCache) {
 		if (segment._pFirstTime)
 			_pFirstTime.set(*segment._pFirstTime);
 	}
 	Segment(Segment&& segment) : _lastTime(segment._lastTime), _pFirstTime(std::move(segment._pFirstTime)),
-		_discontinuous(segment._discontinuous), _medias(std::move(segment._medias)) {
+		_discontinuous(segment._discontinuous), _medias(std::move(segment._medias)), _pCache(std::move(segment._pCache)) {
 		segment._discontinuous = false;
+		segment._pCache.set();
 	}
 
 	bool discontinuous() const { return _discontinuous; }
@@ -73,7 +92,14 @@ struct Segment : virtual Object  {
 	UInt32			time() const { return _pFirstTime ? *_pFirstTime : 0;  }
 	UInt16			duration() const { return _pFirstTime ? UInt16(Util::Distance(*_pFirstTime, _lastTime)) : 0; }
 
-	void			reset() { _discontinuous = true; _medias.clear(); _pFirstTime.reset(); }
+	void			reset() { _discontinuous = true; _medias.clear(); _pFirstTime.reset(); _pCache.set(); }
+
+	/*!
+	Muxed bytes of a complete segment for one format (subMime + subscription parameters), built by a first sending
+	and shared as immutable packets with the next ones. Cache is shared by the copies of the segment, so released with it */
+	typedef std::deque<Packet> Muxed;
+	shared<const Muxed>	muxed(const std::string& format) const;
+	void				setMuxed(const std::string& format, const shared<const Muxed>& pMuxed) const;
 
 	template<typename MediaType, typename ...Args>
 	bool			add(Args&&... args) {
@@ -85,6 +111,12 @@ struct Segment : virtual Object  {
 		_medias.pop_back();
 		return false;
 	}
+	bool			add(const shared<const Media::Base>& pMedia) {
+		if (pMedia->hasTime() && !add(pMedia->time()))
+			return false;
+		_medias.emplace_back(pMedia);
+		return true;
+	}
 	bool			add(UInt32 time);
 	
 	static const Segment& Null() {
@@ -93,7 +125,13 @@ struct Segment : virtual Object  {
 	}
 
 private:
+	struct Cache : std::map<std::string, shared<const Muxed>>, virtual Object {
+		enum { MAX_FORMATS = 8 }; // protection against parameters which change on every request
+		std::mutex mutex;
+	};
+
 	std::vector<shared<const Media::Base>> _medias;
+	shared<Cache>						   _pCache;
 	unique<UInt32>						   _pFirstTime;
 	UInt32								   _lastTime;
 	bool								   _discontinuous;
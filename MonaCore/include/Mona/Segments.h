@@ -19,6 +19,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/Mona.h"
 #include "Mona/MediaWriter.h"
 #include "Mona/Playlist.h"
+#include "Mona/DVR.h"
 
 namespace Mona {
 
@@ -28,9 +29,24 @@ struct Segments : virtual Object, Media::Target, private MediaWriter {
 	NULLABLE(!_maxSegments) // no real sense to use in writing/reading if _maxSegments==0
 
 	enum : UInt8 {
-		DEFAULT_SEGMENTS = 4
+		DEFAULT_SEGMENTS = 4,
+		PART_SEGMENTS = 2 // LL-HLS parts are kept for the segment in building and the 2 last segments
 	};
 
+	/*!
+	LL-HLS partial segment, slice of a segment cut every partDuration while the segment is building,
+	independent if it starts with a key frame (or has no video) */
+	struct Part : Segment, virtual Object {
+		Part(bool independent) : independent(independent) {}
+		Part(const Part& part) : Segment(part), independent(part.independent) {}
+		Part(Part&& part) : Segment(std::move(part)), independent(part.independent) {}
+		const bool independent;
+	};
+	/*!
+	Waiter of a LL-HLS blocking request, called on every new part or segment (and on end of media) while it returns false.
+	Keep a shared pointer on the waiter to stay waiting, release it to cancel the waiting */
+	typedef std::function<bool(const Segments& segments)> Waiter;
+
 	/*!
 	Init segments and fill Playlist. Playlist properti */
 	static bool Init(Exception& ex, IOFile& io, Playlist& playlist, bool append = false);
@@ -41,7 +57,12 @@ struct Segments : virtual Object, Media::Target, private MediaWriter {
 	struct Writer : MediaWriter, virtual Object {
 		OnSegment		onSegment;
 
-		Writer(MediaWriter& writer, UInt16 duration = 0) : _writer(writer), _maxDuration(0) {
+		/*!
+		Cut segments on the duration grid of the media timeline rather than on the first key frame reaching the duration,
+		renditions of a same source with the same key frames are then cut on the same segments (switchable) */
+		bool			aligned;
+
+		Writer(MediaWriter& writer, UInt16 duration = 0) : _writer(writer), _maxDuration(0), aligned(false) {
 			setDuration(duration);
 		}
 	
@@ -90,13 +111,61 @@ struct Segments : virtual Object, Media::Target, private MediaWriter {
 	UInt32		duration() const { return _duration; }
 
 	UInt16		maxDuration() const { return _writer.duration(); }
-	UInt16		setMaxDuration(UInt16 value) { return _writer.setDuration(value); }
+	UInt16		setMaxDuration(UInt16 value) { change(); return _writer.setDuration(value); }
+	/*!
+	Keyframe-aligned segmentation for MBR renditions, see Writer::aligned */
+	bool		aligned() const { return _writer.aligned; }
+	bool		setAligned(bool value) { change(); return _writer.aligned = value; }
+
+	/*!
+	LL-HLS part duration, 0 to disable LL-HLS parts */
+	UInt16		partDuration() const { return _partDuration; }
+	UInt16		setPartDuration(UInt16 value) { change(); return _partDuration = value; }
+
+	/*!
+	DVR, disk-backed ring of the segments kept during retention seconds and written by io, 0 to disable */
+	const DVR*	dvr() const { return _pDVR.get(); }
+	bool		setDVR(IOFile& io, const Path& path, UInt32 retention);
+	void		resetDVR() { change(); _pDVR.reset(); }
 
 	Segments&	operator=(std::nullptr_t) { setMaxSegments(0);  return self; }
 	/*!
-	Get segment by its sequence number, or by a relative end index if negative */
-	const Segment& operator()(Int32 sequence) const;
-	Playlist&	   to(Playlist& playlist) const;
+	Get segment by its sequence number (searched in DVR if no more in memory), or by a relative end index if negative,
+	returns a copy because a DVR segment can be evicted of its cache by the next calls */
+	Segment		   operator()(Int32 sequence) const;
+	/*!
+	Get LL-HLS part by its segment sequence number and its part index */
+	const Segment& operator()(UInt32 sequence, UInt16 part) const;
+	/*!
+	Fill playlist with the live window, or with the last dvr seconds of the DVR ring if dvr>0 */
+	Playlist&	   to(Playlist& playlist, UInt32 dvr = 0) const;
+
+	/*!
+	Playlists rendered for the current state of segments, shared as immutable packets by all the polling requests
+	until the next change (segment, part or end) which creates a new Playlists with a new etag. Key is type + format of the playlist */
+	struct Playlists : virtual Object {
+		enum { MAX_PLAYLISTS = 8 }; // protection against parameters which change on every request
+		Playlists(Int64 id, UInt32 version) : etag(String('"', id, '-', version, '"')) {}
+
+		const std::string etag;
+
+		Packet	get(const std::string& key) const;
+		void	set(const std::string& key, const Packet& playlist) const;
+	private:
+		mutable std::map<std::string, Packet>	_playlists;
+		mutable std::mutex						_mutex;
+	};
+	shared<const Playlists>	playlists() const;
+
+	/*!
+	CMAF init segment (ftyp+moov), muxed once for all the segments of a same configuration: Segment without media used just for its muxed cache,
+	renewed when the last segment brings new audio/video configs */
+	const Segment&	initSegment() const { return _init; }
+
+	/*!
+	Returns true if the segment is complete, or if its part is available when part>=0, always true when segments are not building */
+	bool		   has(UInt32 sequence, Int32 part = -1) const;
+	void		   wait(const shared<Waiter>& pWaiter) const { _waiters.emplace_back(pWaiter); }
 	
 	typedef std::deque<Segment>::const_iterator const_iterator;
 	// iterate just on segments with duration information!
@@ -113,6 +182,7 @@ struct Segments : virtual Object, Media::Target, private MediaWriter {
 	bool endMedia() override;
 private:
 	void init();
+	void change() { ++_version; _pPlaylists.reset(); }
 	// private to explain that it's not necessary to call it, is made in "write"
 	bool beginMedia(const std::string& name) override;
 	// private to mark it explicitly as useless
@@ -134,21 +204,62 @@ private:
 		addSegment<Media::Data>(type, packet, 0, true);
 	}
 	void writeData(UInt8 track, Media::Data::Type type, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Data>(type, packet, track); }
-	void writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Audio>(tag, packet, track); }
-	void writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, const OnWrite& onWrite) override { addSegment<Media::Video>(tag, packet, track); }
+	void writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packet& packet, const OnWrite& onWrite) override {
+		if (tag.isConfig)
+			setConfig(Media::TYPE_AUDIO, track, packet);
+		addSegment<Media::Audio>(tag, packet, track);
+	}
+	void writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packet& packet, const OnWrite& onWrite) override {
+		if (tag.frame == Media::Video::FRAME_CONFIG)
+			setConfig(Media::TYPE_VIDEO, track, packet);
+		addSegment<Media::Video>(tag, packet, track);
+	}
+	void setConfig(Media::Type type, UInt8 track, const Packet& packet);
 	template <typename MediaType, typename ...Args>
 	void addSegment(Args&&... args) {
-		bool added = _segment.add<MediaType>(std::forward<Args>(args) ...);
+		if (!_partDuration) {
+			bool added = _segment.add<MediaType>(std::forward<Args>(args) ...);
+			DEBUG_ASSERT(added);
+			(void)added; // checked just in debug
+			return;
+		}
+		shared<const Media::Base> pMedia(shared<MediaType>(SET, std::forward<Args>(args)...));
+		if (pMedia->hasTime())
+			newPart(pMedia->time());
+		bool added = _segment.add(pMedia);
 		DEBUG_ASSERT(added);
+		(void)added; // checked just in debug
 	}
+	void newPart(UInt32 time);
+	void cutPart(UInt32 time);
+	void wake();
 
 	std::deque<Segment>	_segments;
 	Segment				_segment;
+
+	std::map<UInt32, std::vector<Part>>		_parts; // parts by segment sequence
+	UInt16									_partDuration;
+	bool									_partStarted;
+	UInt32									_partTime;
+	UInt32									_partBegin; // index of the first media of the current part in _segment
+	UInt32									_partHeader; // count of properties and config medias in front of _segment
+	mutable std::vector<weak<Waiter>>		_waiters;
+
 	UInt32				_sequence;
 	UInt8				_maxSegments;
 	Writer				_writer;
 	bool				_started;
 	UInt32				_duration;
+	Int64				_startTime; // wall clock time of the media time 0
+	unique<DVR>			_pDVR;
+
+	std::map<UInt16, Packet>	_configs; // audio and video configs by type<<8 | track
+	bool						_configsChanged; // configs changed in the building segment
+	Segment						_init;
+
+	mutable shared<Playlists>	_pPlaylists;
+	UInt32						_version;
+	const Int64					_id; // makes etag unique between Segments of the same name
 };
 
 } // namespace Mona
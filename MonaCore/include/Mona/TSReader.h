@@ -32,7 +32,7 @@ struct TSReader : virtual Object, MediaReader {
 	// http://dvbsnoop.sourceforge.net/examples/example-pat.html
 	// http://dvd.sourceforge.net/dvdinfo/pes-hdr.html
 
-	TSReader() : _propVersion(0), _syncFound(false), _syncError(false), _crcPAT(0), _audioTrack(0), _videoTrack(0), _startTime(-1) {}
+	TSReader() : _propVersion(0), _syncError(false), _crcPAT(0), _audioTrack(0), _videoTrack(0), _startTime(-1) {}
 	
 private:
 
@@ -64,7 +64,16 @@ private:
 		MediaTrackReader* _pReader;
 	};
 
+	// TS packet header, extracted for all the packets of a buffer before to dispatch them
+	struct Cell {
+		UInt16	pid;
+		bool	hasHeader; // payload unit start indication
+		UInt8	flags; // adaptation field, payload and continuity counter
+		UInt8	offset; // payload position
+	};
+
 	UInt32  parse(Packet& buffer, Media::Source& source);
+	void	parseCell(const Cell& cell, const Packet& buffer, const UInt8* data, Media::Source& source);
 
 	void	parsePAT(const UInt8* data, UInt32 size, Media::Source& source);
 	void	parsePSI(const UInt8* data, UInt32 size, UInt8& version, Media::Source& source);
@@ -82,7 +91,7 @@ private:
 	UInt8										_videoTrack;
 	std::map<UInt16, UInt8>						_pmts;
 	UInt32										_crcPAT;
-	bool										_syncFound;
+	std::vector<Cell>							_cells;
 	bool										_syncError;
 	double										_startTime;
 };
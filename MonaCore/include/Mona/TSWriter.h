@@ -57,6 +57,8 @@ private:
 
 	void  writeAdaptiveHeader(BinaryWriter& writer, UInt16 pid, UInt32 time, bool randomAccess, UInt8 fillSize);
 
+	void  flush(shared<Buffer>& pBuffer, const OnWrite& onWrite);
+
 	struct Track : virtual Object {
 		NULLABLE(!_pWriter)
 		Track(Media::Audio::Codec codec, MediaTrackWriter* pWriter) : type(Media::TYPE_AUDIO), _pWriter(pWriter), codec(codec) {
@@ -92,6 +94,7 @@ private:
 	UInt32						_timePMT;
 
 	std::map<UInt16, UInt8>		_pids;
+	std::deque<std::pair<UInt32, Packet>> _chain; // scatter mode, media parts referenced and their position in TS headers buffer
 	UInt16						_pidPCR;
 	bool						_firstPCR;
 	UInt32						_timePCR;
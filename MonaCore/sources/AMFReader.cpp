@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/StringWriter.h"
 #include "Mona/Logs.h"
 #include "Mona/Exceptions.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -34,7 +35,7 @@ AMFReader::AMFReader(const Packet& packet) : ReferableReader(packet),_amf3(0),_r
 void AMFReader::reset() {
 	DataReader::reset();
 	_stringReferences.clear();
-	_classDefReferences.clear();
+	_traits.clear();
 	_references.clear();
 	_amf0References.clear();
 	_amf3 = 0;
@@ -71,8 +72,8 @@ const char* AMFReader::readText(UInt32& size) {
 	if (reset)
 		reader.reset(reset);
 	else if (size) { // not record string empty
-		if (reference)
-			_stringReferences.emplace_back(reference);
+		if (reference && (_stringReferences.empty() || reference > _stringReferences.back()))
+			_stringReferences.emplace_back(reference); // not record again on a replay of referenced content
 		reader.next(size);
 	}
 	return text;
@@ -571,8 +572,8 @@ bool AMFReader::writeOne(UInt8 type, DataWriter& writer) {
 	///  AMF3
 	reader.next();
 
-	UInt32 flags = reader.read7Bit<UInt32>(4);
 	UInt32 pos(reader.position());
+	UInt32 flags = reader.read7Bit<UInt32>(4);
 	UInt32 resetObject(0);
 	bool isInline = flags&0x01;
 	flags >>= 1;
@@ -588,7 +589,7 @@ bool AMFReader::writeOne(UInt8 type, DataWriter& writer) {
 		}
 		
 		resetObject = reader.position();
-		reader.reset(_references[flags]);
+		reader.reset(pos = _references[flags]);
 		flags = reader.read7Bit<UInt32>(4) >> 1;
 		_referencing = false;
 	} else if (_referencing) {
@@ -598,27 +599,37 @@ bool AMFReader::writeOne(UInt8 type, DataWriter& writer) {
 		reference = 0;
 
 	// classdef reading
-	isInline = flags&0x01; 
-	flags >>= 1;
-	UInt32 reset=0;
-	UInt32 size(0);
-	const char* text(NULL);
-	if(isInline) {
-		 _classDefReferences.emplace_back(pos);
-		text = readText(size); // type
-	} else if(flags<_classDefReferences.size()) {
-		reset = reader.position();
-		reader.reset(_classDefReferences[flags]);
-		flags = reader.read7Bit<UInt32>(4)>>2;
-		text = readText(size);
-		_referencing = false;
-	} else
+	const Traits* pTraits(NULL);
+	if (flags & 0x01) {
+		flags >>= 1;
+		UInt32 size(0);
+		const char* text(readText(size)); // type
+		const auto& it = lower_bound(_traits.begin(), _traits.end(), pos, [](const Traits& traits, UInt32 pos) { return traits.position < pos; });
+		if (it == _traits.end()) {
+			_traits.emplace_back(pos, text, text ? size : 0, flags & 0x03);
+			Traits& traits(_traits.back());
+			for (flags >>= 2; flags; --flags) {
+				if ((text = readText(size)))
+					traits.members.emplace_back(text, size);
+			}
+			pTraits = &traits;
+		} else if (it->position == pos) { // replay of a referenced object, traits already decoded
+			pTraits = &*it;
+			for (flags >>= 2; flags; --flags)
+				readText(size);
+		}
+	} else if ((flags >>= 1) < _traits.size())
+		pTraits = &_traits[flags];
+	if (!pTraits) {
 		ERROR("AMF3 classDef reference not found")
+		if (resetObject)
+			reader.reset(resetObject);
+		_referencing = referencing;
+		return false;
+	}
 
-	if (flags & 0x01) {
+	if (pTraits->flags & 0x01) {
 		// external, support just "flex.messaging.io.ArrayCollection"
-		if (reset)
-			reader.reset(reset);
 		bool result(readNext(writer));
 		if (resetObject)
 			reader.reset(resetObject); // reset object
@@ -626,49 +637,21 @@ bool AMFReader::writeOne(UInt8 type, DataWriter& writer) {
 		return result;
 	}
 
-	if (size)
-		pReference = beginObject(writer, reference, _buffer.assign(text, size).c_str());
+	if (pTraits->size)
+		pReference = beginObject(writer, reference, _buffer.assign(pTraits->type, pTraits->size).c_str());
 	else
 		pReference = beginObject(writer, reference);
 
-	isInline = (flags&0x02) ? true : false; // is dynamic!
-
-	flags>>=2;
-
-	 // Find values position for classdef name properties
-	pos = reader.position(); // save name position
-	for (UInt32 i = 0; i < flags;++i) {
-		if (!readText(size)) {
-			// fix flags if error during properties reading
-			if (!i)
-				pos = reader.position();
-			--flags; 
-		}
-	}
-	// Reset classdef to be on values now!
-	if (reset) {
-		reader.reset(reset);
-		reset = 0;
-		if (!resetObject)
-			_referencing = referencing;
-	}
-
 	// Read classdef properties
-	while (flags--) {
-		reset = reader.position(); // save value position
-		// Read property name in classdef
-		reader.reset(pos); // reset on name
-		while(!(text = readText(size)));
-		writer.writePropertyName(_buffer.assign(text, size).c_str());
-		pos = reader.position(); // save new name position
-		// Read value
-		reader.reset(reset); // reset on value
+	for (const auto& member : pTraits->members) {
+		writer.writePropertyName(_buffer.assign(member.first, member.second).c_str());
 		if (!readNext(writer))
 			writer.writeNull();
 	}
 
-	
-	if (isInline) { // is dynamic
+	if (pTraits->flags & 0x02) { // is dynamic
+		const char* text(NULL);
+		UInt32 size(0);
 		while ((text = readText(size)) && size) { // property can't be empty
 			writer.writePropertyName(_buffer.assign(text, size).c_str());
 			if (!readNext(writer))
@@ -34,6 +34,8 @@ void AMFWriter::reset() {
 	_references.clear();
 	_amf0References = 0;
 	_stringReferences.clear();
+	_traitReferences.clear();
+	_texts.clear();
 	DataWriter::reset();
 }
 
@@ -93,14 +95,31 @@ void AMFWriter::writePropertyName(const char* name) {
 	writeText(name,size);
 }
 
+size_t AMFWriter::TextHash::operator()(const Text& text) const {
+	// FNV-1a
+	UInt64 hash(0xCBF29CE484222325ull);
+	for (UInt32 i = 0; i < text.size; ++i)
+		hash = (hash ^ UInt8(text.data[i])) * 0x100000001B3ull;
+	return size_t(hash);
+}
+
+bool AMFWriter::reference(References& references, const char* value, UInt32 size, UInt32& index) {
+	const auto& it = references.find(Text(value, size));
+	if (it != references.end()) {
+		index = it->second;
+		return true;
+	}
+	_texts.emplace_back(value, size);
+	references.emplace(SET, forward_as_tuple(_texts.back().data(), size), forward_as_tuple(index = references.size()));
+	return false;
+}
+
 void AMFWriter::writeText(const char* value,UInt32 size) {
-	if(size>0) {
-		const auto& it = _stringReferences.emplace(SET, forward_as_tuple(value, size), forward_as_tuple(_stringReferences.size()));
-		if (!it.second) {
-			// already exists
-			writer.write7Bit<UInt32>(it.first->second << 1, 4);
-			return;
-		}
+	UInt32 index;
+	if (size > 0 && reference(_stringReferences, value, size, index)) {
+		// already exists
+		writer.write7Bit<UInt32>(index << 1, 4);
+		return;
 	}
 	writer.write7Bit<UInt32>((size<<1) | 0x01, 4).write(value,size);
 }
@@ -188,11 +207,16 @@ UInt64 AMFWriter::beginObject(const char* type) {
 		flags |= (hardProperties<<4);
 	}*/
 
-	// ClassDef always inline (because never hard properties, all is dynamic)
+	// ClassDef without hard properties (all is dynamic), so one classdef by type: inline the first time and referenced then
 	// Always dynamic (but can't be externalizable AND dynamic!)
-	writer.write7Bit<UInt32>(11, 4); // 00001011 => inner object + classdef inline + dynamic
-
-	writePropertyName(type ? type : "");
+	if (!type)
+		type = "";
+	UInt32 index;
+	if (!reference(_traitReferences, type, strlen(type), index)) {
+		writer.write7Bit<UInt32>(11, 4); // 00001011 => inner object + classdef inline + dynamic
+		writePropertyName(type);
+	} else
+		writer.write7Bit<UInt32>((index << 2) | 1, 4); // inner object + classdef reference
 
 	_references.emplace_back(AMF::AMF3_OBJECT);
 	return (_references.size() << 1) | 1;
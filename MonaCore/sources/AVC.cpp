@@ -125,10 +125,10 @@ UInt32 AVC::SPSToVideoDimension(const UInt8* data, UInt32 size) {
 		return 0;
 	}
 
-	BitReader reader(data, size - 1);
+	BitstreamReader reader(data, size - 1);
 
 	UInt16 leftOffset = 0, rightOffset = 0, topOffset = 0, bottomOffset = 0;
-	UInt16 subWidthC = 0, subHeightC = 0;
+	UInt16 subWidthC = 2, subHeightC = 2; // chroma_format_idc is 4:2:0 when not present
 
 	UInt8 idc = reader.read<UInt8>();
 	reader.next(16); // constraincts
@@ -144,6 +144,9 @@ UInt32 AVC::SPSToVideoDimension(const UInt8* data, UInt32 size) {
 		case 86:
 		case 118:
 			switch (MPEG4::ReadExpGolomb(reader)) { // chroma_format_idc
+				case 0: // monochrome
+					subWidthC = subHeightC = 1;
+					break;
 				case 1: // 4:2:0
 					subWidthC = subHeightC = 2;
 					break;
@@ -152,8 +155,8 @@ UInt32 AVC::SPSToVideoDimension(const UInt8* data, UInt32 size) {
 					subHeightC = 1;
 					break;
 				case 3: // 4:4:4
-					if (!reader.read())
-						subWidthC = subHeightC = 1; // separate_colour_plane_flag 
+					reader.next(); // separate_colour_plane_flag
+					subWidthC = subHeightC = 1;
 					break;
 			}
 
@@ -166,12 +169,7 @@ UInt32 AVC::SPSToVideoDimension(const UInt8* data, UInt32 size) {
 						UInt8 sizeOfScalingList = (i < 6) ? 16 : 64;
 						UInt8 scale = 8;
 						for (UInt8 j = 0; j < sizeOfScalingList; ++j) {
-							Int16 delta = MPEG4::ReadExpGolomb(reader);
-							if (delta & 1)
-								delta = (delta + 1) / 2;
-							else
-								delta = -(delta / 2);
-							scale = (scale + delta + 256) % 256;
+							scale = (scale + MPEG4::ReadSignedExpGolomb(reader) + 256) % 256;
 							if (!scale)
 								break;
 						}
@@ -114,7 +114,22 @@ static const char* _Charsets[4][128] = {
 	}
 };
 
-CCaption::CCaption() {
+static bool HasSEI(const Packet& packet) {
+	// just NAL types of the AVCC frame, SEI of "user data registered" type
+	const UInt8* cur = packet.data();
+	const UInt8* end = cur + packet.size();
+	while ((end - cur) > 5) {
+		UInt32 size = BinaryReader(cur, 4).read32();
+		if (size > 1 && (cur[4] & 0x1f) == 6 && cur[5] == 4)
+			return true;
+		if (size > UInt32(end - cur - 4))
+			break;
+		cur += 4 + size;
+	}
+	return false;
+}
+
+CCaption::CCaption() : _extracting(false), _scanned(0), _skipped(0), _filtered(0) {
 	memset(_langs, 0, 8);
 	UInt8 id(0);
 	for (Channel& channel : _channels) {
@@ -128,6 +143,13 @@ UInt32 CCaption::extract(const Media::Video::Tag& tag, const Packet& packet, con
 	for (Channel& channel : _channels)
 		channel.flush(onText, &tag);
 
+	_extracting = true;
+	if (tag.codec != Media::Video::CODEC_H264 || !HasSEI(packet)) {
+		++_filtered;
+		return 0;
+	}
+	++_scanned;
+
 	// Search SEI frame to parse!
 	BinaryReader reader(packet.data(), packet.size());
 	UInt32 offset = 0;
@@ -307,6 +329,14 @@ void CCaption::decode(const Media::Video::Tag& tag, const Packet& packet, const
 	}
 }
 
+void CCaption::skip() {
+	++_skipped;
+	if (!_extracting)
+		return;
+	_extracting = false;
+	flush();
+}
+
 void CCaption::flush(const CCaption::OnText& onText) {
 	for (Channel& channel : _channels)
 		channel.flush(onText, NULL);
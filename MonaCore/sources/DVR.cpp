@@ -0,0 +1,328 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/DVR.h"
+#include "Mona/FileSystem.h"
+#include "Mona/Logs.h"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+using namespace std;
+
+namespace Mona {
+
+enum {
+	FLAG_PROPERTIES = 1
+};
+
+struct DVR::Block : virtual Object {
+	Block(const Path& path, UInt32 capacity) : pFile(SET, path, File::MODE_WRITE), capacity(capacity), size(0) {}
+	~Block() {
+		const Path path((const Path&)*pFile);
+		pFile.reset(); // close the file if no more written
+		Exception ex;
+		if (!FileSystem::Delete(ex, path))
+			WARN("DVR block ", path.name(), " deletion, ", ex);
+	}
+
+	shared<File>	pFile; // written by IOFile
+	const UInt32	capacity;
+	UInt32			size; // bytes queued to write
+	weak<Mapping>	mapping; // current read-only mapping, valid while referenced
+
+	UInt32			available() const { return capacity - size; }
+};
+
+struct DVR::Mapping : Binary, virtual Object {
+	Mapping(const shared<Block>& pBlock) : _pBlock(pBlock), _data(NULL), _size(0) {}
+	~Mapping() {
+		if (!_data)
+			return;
+#if defined(_WIN32)
+		UnmapViewOfFile(_data);
+#else
+		munmap(_data, _size);
+#endif
+	}
+
+	const UInt8*	data() const { return _data; }
+	UInt32			size() const { return _size; }
+
+	bool open(Exception& ex, UInt32 size) {
+		const Path& path(*_pBlock->pFile);
+		// handles can be closed once the view mapped
+#if defined(_WIN32)
+		wchar_t wFile[PATH_MAX];
+		MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wFile, sizeof(wFile));
+		HANDLE handle = CreateFileW(wFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (handle != INVALID_HANDLE_VALUE) {
+			HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, size, NULL);
+			if (mapping) {
+				_data = BIN MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+				CloseHandle(mapping);
+			}
+			CloseHandle(handle);
+		}
+#else
+		int handle = ::open(path.c_str(), O_RDONLY);
+		if (handle >= 0) {
+			void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, handle, 0);
+			if (data != MAP_FAILED)
+				_data = BIN data;
+			::close(handle);
+		}
+#endif
+		if (!_data) {
+			ex.set<Ex::System::File>("Impossible to map ", path, " of ", size, " bytes");
+			return false;
+		}
+		_size = size;
+		return true;
+	}
+
+private:
+	const shared<Block>	_pBlock; // block file deleted once no more mapped
+	UInt8*				_data;
+	UInt32				_size;
+};
+
+
+static UInt8 PackedSize(const Media::Base& media) {
+	switch (media.type) {
+		case Media::TYPE_AUDIO:
+			return Media::PackedSize(((const Media::Audio&)media).tag, media.track);
+		case Media::TYPE_VIDEO:
+			return Media::PackedSize(((const Media::Video&)media).tag, media.track);
+		default:
+			return Media::PackedSize(((const Media::Data&)media).tag, media.track);
+	}
+}
+
+static BinaryWriter& Pack(BinaryWriter& writer, const Media::Base& media) {
+	switch (media.type) {
+		case Media::TYPE_AUDIO:
+			return Media::Pack(writer.write8(0), ((const Media::Audio&)media).tag, media.track);
+		case Media::TYPE_VIDEO:
+			return Media::Pack(writer.write8(0), ((const Media::Video&)media).tag, media.track);
+		default: {
+			const Media::Data& data = (const Media::Data&)media;
+			return Media::Pack(writer.write8(data.isProperties ? FLAG_PROPERTIES : 0), data.tag, data.track);
+		}
+	}
+}
+
+
+DVR::DVR(IOFile& io, const Path& path, UInt32 retention) : _io(io), path(path), _retention(retention), _duration(0), _size(0), _blocks(0), _writing(0), _id(Time::Now()) {
+	Exception ex;
+	if (FileSystem::CreateDirectory(ex, path, FileSystem::MODE_HEAVY)) {
+		// remove just block files of a previous ring (ignore error, can be always in use)
+		string extension;
+		FileSystem::ListFiles(ex, path, [&extension](const string& file, UInt16 level) {
+			if (String::ICompare(FileSystem::GetExtension(file, extension), "blk") == 0) {
+				Exception ignore;
+				FileSystem::Delete(ignore, file);
+			}
+			return true;
+		});
+	}
+	if (ex)
+		WARN("DVR ", path, ", ", ex);
+}
+
+DVR::~DVR() {
+	// release blocks before to remove the folder (fails if a block is always in use, its file will be removed on release)
+	_cache.clear();
+	_items.clear();
+	_pBlock.reset();
+	Exception ignore;
+	FileSystem::Delete(ignore, path);
+}
+
+bool DVR::append(Exception& ex, UInt32 sequence, const Segment& segment) {
+	UInt32 size = 0;
+	UInt32 indexSize = 0;
+	for (const shared<const Media::Base>& pMedia : segment) {
+		size += pMedia->size();
+		indexSize += 9 + PackedSize(*pMedia);
+	}
+	if (!_pBlock || _pBlock->available() < (size + indexSize)) {
+		// new block, at least of the segment size
+		_pBlock.set(Path(path, _id, '.', _blocks, ".blk"), max<UInt32>(BLOCK_SIZE, size + indexSize));
+		// create the file now to be sure to delete it on release
+		if (!_pBlock->pFile->load(ex)) {
+			_pBlock.reset();
+			return false;
+		}
+		string name(path.name());
+		_io.subscribe(_pBlock->pFile, File::OnError([name](const Exception& ex) { WARN("DVR ", name, ", ", ex); }));
+		++_blocks;
+	}
+	_items.emplace_back(_pBlock, _pBlock->size, sequence, segment.time(), segment.duration(), segment.discontinuous());
+	Item& item = _items.back();
+	item.index = item.offset + size;
+	item.end = item.index + indexSize;
+	item.frames = segment.count();
+	item.pSegment.set(segment); // medias referenced (no copy) while writing
+	++_writing;
+
+	// frames are written by IOFile without copy, just the index is built here
+	shared<Buffer> pIndex(SET, indexSize);
+	BinaryWriter index(pIndex->data(), indexSize);
+	UInt32 time = segment.time();
+	UInt32 offset = 0;
+	for (const shared<const Media::Base>& pMedia : segment) {
+		if (pMedia->hasTime())
+			time = pMedia->time();
+		Pack(index.write32(time).write32(offset), *pMedia);
+		offset += pMedia->size();
+		_io.write(_pBlock->pFile, *pMedia);
+	}
+	_io.write(_pBlock->pFile, Packet(pIndex));
+	_pBlock->size += size + indexSize;
+	_size += size + indexSize;
+	_duration += item.duration;
+	clean();
+	// release the segments written
+	for (auto it = _items.end() - _writing; _writing && written(*it); ++it)
+		--_writing;
+	return true;
+}
+
+bool DVR::written(const Item& item) const {
+	if (!item.pSegment)
+		return true;
+	if (item.pBlock->pFile->written() < item.end)
+		return false;
+	item.pSegment.reset();
+	return true;
+}
+
+void DVR::clean() {
+	// keep at least the retention duration
+	UInt64 retention = _retention * 1000ull;
+	while (_items.size() > 1 && (_duration - _items.front().duration) >= retention) {
+		const Item& item = _items.front();
+		_duration -= item.duration;
+		_size -= item.size();
+		_items.pop_front(); // block released with its last segment (file deleted once no more read)
+	}
+	if (_writing > _items.size())
+		_writing = _items.size();
+	// release the cached segments removed
+	auto it = _cache.begin();
+	while (it != _cache.end()) {
+		if (it->first < sequence())
+			it = _cache.erase(it);
+		else
+			++it;
+	}
+}
+
+Segment DVR::operator()(UInt32 sequence) const {
+	if (sequence < this->sequence())
+		return Segment::Null();
+	sequence -= this->sequence();
+	if (sequence >= _items.size())
+		return Segment::Null();
+	const Item& item = _items[sequence];
+	if (!written(item))
+		return *item.pSegment; // not yet on disk
+	for (const auto& it : _cache) {
+		if (it.first == item.sequence)
+			return it.second;
+	}
+	// map all the block written, or reuse the current mapping if it includes the segment
+	shared<Mapping> pMapping(item.pBlock->mapping.lock());
+	if (!pMapping || pMapping->size() < item.end) {
+		pMapping.set(item.pBlock);
+		Exception ex;
+		if (!pMapping->open(ex, UInt32(item.pBlock->pFile->written()))) {
+			ERROR("DVR segment ", item.sequence, ", ", ex);
+			return Segment::Null();
+		}
+		item.pBlock->mapping = pMapping;
+	}
+
+	if (_cache.size() >= CACHE_SEGMENTS)
+		_cache.pop_front();
+	_cache.emplace_back(item.sequence, Segment());
+	Segment& segment = _cache.back().second;
+	if (item.discontinuous)
+		segment.reset();
+
+	shared<const Binary> pBlock(pMapping);
+	const UInt8* data = pBlock->data() + item.offset;
+	BinaryReader index(pBlock->data() + item.index, item.end - item.index);
+	UInt8 track;
+	Media::Audio::Tag audio;
+	Media::Video::Tag video;
+	Media::Data::Type type;
+	for (UInt32 frames = item.frames; frames; --frames) {
+		index.next(4); // time is useless here, just for seeking
+		UInt32 offset = index.read32();
+		UInt8 flags = index.read8();
+		Media::Type media = Media::Unpack(index, audio, video, type, track);
+		UInt32 end = frames > 1 ? BinaryReader(index.current() + 4, 4).read32() : (item.index - item.offset);
+		Packet packet(pBlock, data + offset, end - offset);
+		switch (media) {
+			case Media::TYPE_AUDIO:
+				segment.add<Media::Audio>(audio, packet, track);
+				break;
+			case Media::TYPE_VIDEO:
+				segment.add<Media::Video>(video, packet, track);
+				break;
+			case Media::TYPE_DATA:
+				segment.add<Media::Data>(type, packet, track, (flags & FLAG_PROPERTIES) ? true : false);
+				break;
+			default:
+				ERROR("DVR segment ", item.sequence, " corrupted");
+		}
+	}
+	segment.add(item.time + item.duration); // fix end time
+	return segment;
+}
+
+Playlist& DVR::to(Playlist& playlist, UInt32 window) const {
+	playlist.reset();
+	if (_items.empty())
+		return playlist;
+	// Skip the first segment, because can be deleted by retention before request
+	deque<Item>::const_iterator it = _items.begin() + (_items.size() > 1 ? 1 : 0);
+	// search the first segment of the window
+	deque<Item>::const_iterator itFirst = _items.end();
+	UInt64 duration = 0;
+	while (itFirst != it && duration < window * 1000ull)
+		duration += (--itFirst)->duration;
+	playlist.sequence = itFirst->sequence;
+	playlist.time = itFirst->time;
+	UInt64 bytes = 0;
+	for (it = itFirst; it != _items.end(); ++it) {
+		if (it->discontinuous)
+			playlist.addItem(0); // discontinuous
+		playlist.addItem(it->duration);
+		bytes += it->size();
+	}
+	if (playlist.duration())
+		playlist.bandwidth = UInt32(bytes * 8000 / playlist.duration());
+	return playlist;
+}
+
+
+} // namespace Mona
@@ -21,39 +21,6 @@ using namespace std;
 namespace Mona {
 
 
-// Custom version of BitReader wich ignore the 03 byte when readding a serie of 0x000003
-struct BitstreamReader : BitReader, virtual Object {
-	BitstreamReader(const UInt8* data, UInt32 size) : BitReader(data, size) {}
-
-	virtual bool read() {
-		if (_current == _end)
-			return false;
-		bool result = (*_current & (0x80 >> _bit++)) ? true : false;
-		if (_bit == 8) {
-			_bit = 0;
-			if (++_current != _end && position() >= 16 && *_current == 3 && *(_current - 1) == 0 && *(_current - 2) == 0)
-				++_current; // ignore 0x03 after two 0x00
-		}
-		return result;
-	}
-
-	template<typename ResultType>
-	ResultType read(UInt8 count = (sizeof(ResultType) * 8)) { return BitReader::read<ResultType>(count); }
-
-	virtual UInt64 next(UInt64 count = 1) {
-		UInt64 gotten(0);
-		while (_current != _end && count--) {
-			++gotten;
-			if (++_bit == 8) {
-				_bit = 0;
-				if (++_current != _end && position() >= 16 && *_current == 3 && *(_current - 1) == 0 && *(_current - 2) == 0)
-					++_current; // ignore 0x03 after two 0x00
-			}
-		}
-		return gotten;
-	}
-};
-
 Media::Video::Frame HEVC::Frames[] = {
 	Media::Video::FRAME_INTER, // NAL TRAIL N = 0
 	Media::Video::FRAME_INTER, // NAL TRAIL R = 1
@@ -33,6 +33,7 @@ HTTP::Header::Header(const Socket& socket, bool rendezVous) : accessControlReque
 	version(0),
 	connection(CONNECTION_KEEPALIVE), // KEEPALIVE BY DEFAULT for HTTP 1.1
 	ifModifiedSince(0),
+	ifNoneMatch(NULL),
 	subMime(NULL),
 	origin(NULL),
 	upgrade(NULL),
@@ -41,61 +42,124 @@ HTTP::Header::Header(const Socket& socket, bool rendezVous) : accessControlReque
 	accessControlRequestHeaders(NULL),
 	host(socket.address()),
 	range(NULL),
+	contentLength(NULL),
 	chunked(false),
 	code(NULL),
 	forceText(false),
-	rendezVous(rendezVous) {
+	rendezVous(rendezVous),
+	_filled(false) {
 }
 
-void HTTP::Header::set(const char* key, const char* value) {
-	value = setString(key, value).c_str();
-
-	if (String::ICompare(key, "content-type") == 0) {
-		mime = MIME::Read(value, subMime);
-		if (!mime)
-			WARN("Unknown Content-Type ", value);
-	} else if (String::ICompare(key, "connection") == 0) {
-		connection = ParseConnection(value);
-	} else if (String::ICompare(key, "range") == 0) {
-		range = strchr(value, '=');
-		if (range)
-			String::TrimLeft(++range);
-	} else if (String::ICompare(key, "host") == 0) {
-		host = value;
-	} else if (String::ICompare(key, "origin") == 0) {
-		origin = value;
-	} else if (String::ICompare(key, "upgrade") == 0) {
-		upgrade = value;
-	} else if (String::ICompare(key, "sec-websocket-key") == 0) {
-		secWebsocketKey = value;
-	} else if (String::ICompare(key, "sec-webSocket-accept") == 0) {
-		secWebsocketAccept = value;
-	} else if (String::ICompare(key, "transfer-encoding") == 0) {
-		String::ForEach forEach([this](UInt32 index, const char* value) {
-			if (String::ICompare(value, "chunked") == 0)
-				chunked = true;
-			return true;
-		});
-		String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
-	} else if (String::ICompare(key, "if-modified-since") == 0) {
-		Exception ex;
-		AUTO_ERROR(ifModifiedSince.update(ex, value, Date::FORMAT_HTTP), "HTTP header")
-	} else if (String::ICompare(key, "access-control-request-headers") == 0) {
-			accessControlRequestHeaders = value;
-	} else if (String::ICompare(key, "access-control-request-method") == 0) {
-
-		String::ForEach forEach([this](UInt32 index, const char* value) {
-			Type type(ParseType(value));
-			if (!type)
-				WARN("Access-control-request-method, unknown ", value, " type")
-			else
-				accessControlRequestMethod |= type;
-			return true;
-		});
-		String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+// perfect hash of known field names (lowercase first char), a collision would be a duplicate case compilation error
+static constexpr UInt8 FieldHash(const char* key, size_t size) { return (size + (key[0] | 0x20)) & 31; }
+
+void HTTP::Header::set(const Packet& buffer, const char* key, const char* value) {
+	// hold buffer to keep key and value valid (Packet&& constructor, a Packet copy is just a reference)
+	if (_buffers.empty() || _buffers.back().buffer() != buffer.buffer())
+		_buffers.emplace_back(std::move(buffer));
+	_fields.emplace_back(key, value);
+
+	size_t size(strlen(key));
+	switch (FieldHash(key, size)) {
+		case FieldHash(EXPAND("content-type")):
+			if (String::ICompare(key, "content-type") != 0)
+				break;
+			mime = MIME::Read(value, subMime);
+			if (!mime)
+				WARN("Unknown Content-Type ", value);
+			break;
+		case FieldHash(EXPAND("content-length")):
+			if (String::ICompare(key, "content-length") == 0)
+				contentLength = value;
+			break;
+		case FieldHash(EXPAND("connection")):
+			if (String::ICompare(key, "connection") == 0)
+				connection = ParseConnection(value);
+			break;
+		case FieldHash(EXPAND("range")):
+			if (String::ICompare(key, "range") != 0)
+				break;
+			range = strchr(value, '=');
+			if (range)
+				String::TrimLeft(++range);
+			break;
+		case FieldHash(EXPAND("host")):
+			if (String::ICompare(key, "host") == 0)
+				host = value;
+			break;
+		case FieldHash(EXPAND("origin")):
+			if (String::ICompare(key, "origin") == 0)
+				origin = value;
+			break;
+		case FieldHash(EXPAND("upgrade")):
+			if (String::ICompare(key, "upgrade") == 0)
+				upgrade = value;
+			break;
+		case FieldHash(EXPAND("sec-websocket-key")):
+			if (String::ICompare(key, "sec-websocket-key") == 0)
+				secWebsocketKey = value;
+			break;
+		case FieldHash(EXPAND("sec-websocket-accept")):
+			if (String::ICompare(key, "sec-websocket-accept") == 0)
+				secWebsocketAccept = value;
+			break;
+		case FieldHash(EXPAND("transfer-encoding")): {
+			if (String::ICompare(key, "transfer-encoding") != 0)
+				break;
+			String::ForEach forEach([this](UInt32 index, const char* value) {
+				if (String::ICompare(value, "chunked") == 0)
+					chunked = true;
+				return true;
+			});
+			String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			break;
+		}
+		case FieldHash(EXPAND("if-modified-since")): {
+			if (String::ICompare(key, "if-modified-since") != 0)
+				break;
+			Exception ex;
+			AUTO_ERROR(ifModifiedSince.update(ex, value, Date::FORMAT_HTTP), "HTTP header")
+			break;
+		}
+		case FieldHash(EXPAND("if-none-match")):
+			if (String::ICompare(key, "if-none-match") == 0)
+				ifNoneMatch = value;
+			break;
+		case FieldHash(EXPAND("access-control-request-headers")):
+			if (String::ICompare(key, "access-control-request-headers") == 0)
+				accessControlRequestHeaders = value;
+			break;
+		case FieldHash(EXPAND("access-control-request-method")): {
+			if (String::ICompare(key, "access-control-request-method") != 0)
+				break;
+			String::ForEach forEach([this](UInt32 index, const char* value) {
+				Type type(ParseType(value));
+				if (!type)
+					WARN("Access-control-request-method, unknown ", value, " type")
+				else
+					accessControlRequestMethod |= type;
+				return true;
+			});
+			String::Split(value, ",", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
+			break;
+		}
+		case FieldHash(EXPAND("cookie")):
+			break; // cookies in params, see fill
+	}
+}
 
-	} else if (String::ICompare(key, "cookie") == 0) {
-		String::ForEach forEach([this](UInt32 index, const char* data) {
+void HTTP::Header::fill(Parameters& params) const {
+	if (type)
+		params.setString("type", TypeToString(type));
+	if (!code)
+		params.setNumber("version", version);
+	for (const auto& it : _fields) {
+		if (chunked && String::ICompare(it.first, "content-length") == 0)
+			continue; // chunked => no content-length!
+		const char* value = params.setString(it.first, it.second).c_str();
+		if (String::ICompare(it.first, "cookie") != 0)
+			continue;
+		String::ForEach forEach([&params](UInt32 index, const char* data) {
 			const char* value = data;
 			// trim key right
 			while (*value && *value != '=' && !isblank(*value))
@@ -104,12 +168,11 @@ void HTTP::Header::set(const char* key, const char* value) {
 			// trim value left
 			while (*value && isblank(*++value));
 			String::Scoped scoped(endKey);
-			setString(data, value); // cookies in Map!
+			params.setString(data, value); // cookies in Map!
 			return true;
 		});
 		String::Split(value, ";", forEach, SPLIT_IGNORE_EMPTY | SPLIT_TRIM);
 	}
-	
 }
 
 const char* HTTP::ErrorToCode(Int32 error) {
@@ -24,10 +24,10 @@ using namespace std;
 namespace Mona {
 
 HTTPDecoder::HTTPDecoder(const Handler& handler, const string& www, const char* name) :
-	_name(name), _www(MAKE_FOLDER(www)), _stage(CMD), _handler(handler), _code(0), _lastRequest(0) {
+	_name(name), _www(MAKE_FOLDER(www)), _stage(CMD), _handler(handler), _code(0), _fieldsSize(0), _lastRequest(0) {
 }
 HTTPDecoder::HTTPDecoder(const Handler& handler, const string& www, const shared<HTTP::RendezVous>& pRendezVous, const char* name) : _pRendezVous(pRendezVous),
-	_name(name), _www(MAKE_FOLDER(www)), _stage(CMD), _handler(handler), _code(0), _lastRequest(0) {
+	_name(name), _www(MAKE_FOLDER(www)), _stage(CMD), _handler(handler), _code(0), _fieldsSize(0), _lastRequest(0) {
 }
 
 void HTTPDecoder::onRelease(Socket& socket) {
@@ -70,20 +70,64 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 /////////////////////////////////////////////////////////////////
 ///////////////////// PARSE HEADER //////////////////////////////
 		const char* signifiant(STR buffer.data());
-		const char* key(NULL);
 
 		while (_stage<BODY) {
 			if (!_pHeader) {
 				// reset header var to parse
 				_file.reset();
 				_code = 0;
+				_fieldsSize = 0;
 				_pHeader.set(*pSocket, _pRendezVous.operator bool());
 			}
 
+			if (_stage == LEFT) {
+				// HEADER FIELDS, line by line (memchr is vectorized by libc implementations)
+				const char* line(STR buffer.data());
+				const char* end(line);
+				while ((end = (const char*)memchr(end, '\n', buffer.size() - (end - line))) && (end == line || end[-1] != '\r'))
+					++end;
+				if (!end) {
+					// wait the end of line
+					if ((_fieldsSize + buffer.size()) <= 0x2000)
+						return buffer.size();
+					_ex.set<Ex::Protocol>("HTTP header too large (>8KB)");
+					break;
+				}
+				// fields are consumed line by line, so limit their cumulated size
+				if ((_fieldsSize += UInt32(end + 1 - line)) > 0x2000) {
+					_ex.set<Ex::Protocol>("HTTP header too large (>8KB)");
+					break;
+				}
+				if (end > line + 1) {
+					// KEY: VALUE, null terminated in the buffer hold by the header (no copy)
+					char* endLine(STR end - 1);
+					char* key(STR line);
+					while (key < endLine && isspace(*key))
+						++key;
+					char* value(STR memchr(key, ':', endLine - key));
+					char* endKey(value ? value : endLine);
+					while (endKey > key && isblank(endKey[-1]))
+						--endKey;
+					if (value) {
+						while (++value < endLine && isspace(*value));
+						char* endValue(endLine);
+						while (endValue > value && isblank(endValue[-1]))
+							--endValue;
+						*endValue = 0;
+					}
+					*endKey = 0;
+					_pHeader->set(buffer, key, value ? value : "");
+					buffer += UInt32(end + 1 - line);
+					signifiant = STR buffer.data();
+					continue;
+				}
+				// \r\n\r\n!
+			}
+
 			if (buffer.size() < 2) {
 				// useless to parse if we have not at less one line which  to carry \r\n\r\n!
-				UInt32 rest = buffer.size()  + (key ? (STR buffer.data() - key) : (STR buffer.data() - signifiant));
-				if (rest <= 0x2000)
+				UInt32 rest = buffer.size() + (STR buffer.data() - signifiant);
+				if ((_fieldsSize + rest) <= 0x2000)
 					return rest;
 				_ex.set<Ex::Protocol>("HTTP header too large (>8KB)");
 				break;	
@@ -129,12 +173,13 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 					if (_pHeader->chunked) {
 						_stage = CHUNKED;
 						_pHeader->progressive = true;
-						// force no content-length!
-						_pHeader->erase("content-length");
+						// force no content-length! (see HTTP::Header::fill)
+						_pHeader->contentLength = NULL;
 						_length = 0;
 					} else {
 						_stage = BODY;
-						_pHeader->progressive = !_pHeader->getNumber("content-length", _length = -1);
+						_length = -1;
+						_pHeader->progressive = !_pHeader->contentLength || !String::ToNumber(_pHeader->contentLength, _length);
 					}
 
 					bool invocation = false;
@@ -194,29 +239,17 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 					break; // END OF FINAL PARSE
 				}
 
-				// KEY = VALUE
+				// end of first line, null terminated in the buffer hold by the header (no copy)
 				char* endValue(STR buffer.data());
 				while (isblank(*--endValue));
-
-				String::Scoped scoped(++endValue);
+				*++endValue = 0;
 				if (_stage==VERSION) {
-					if (!_code) {
-						// Set request version!
+					if (!_code) // Set request version!
 						String::ToNumber(signifiant + 5, _pHeader->version);
-						_pHeader->setNumber("version", _pHeader->version);
-					} else // Set response code!
-						_pHeader->code = _pHeader->setString("code", signifiant).c_str();
-				} else {
-					const char* endValue(signifiant);
-					while (isblank(*--endValue)); // after the :
-					while (isblank(*--endValue)); // before the :
-					String::Scoped scoped(++endValue);
-					if(key)
-						_pHeader->set(key, signifiant);
-					else
-						_pHeader->set(signifiant, "");
-					key = NULL;
-				}
+					else // Set response code!
+						_pHeader->set(buffer, "code", _pHeader->code = signifiant);
+				} else
+					_pHeader->set(buffer, signifiant, "");
 
 				_stage = LEFT;
 				buffer += 2;
@@ -246,7 +279,6 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 							_ex.set<Ex::Protocol>("Request disabled HTTP Rendezvous service (HTTP.RDV=false)");
 							break;
 						}
-						_pHeader->setString("type", HTTP::TypeToString(_pHeader->type));
 					}
 					signifiant = STR buffer.data() + 1;
 					_stage = PATH;
@@ -277,13 +309,6 @@ UInt32 HTTPDecoder::onStreamData(Packet& buffer, const shared<Socket>& pSocket)
 					_ex.set<Ex::Protocol>("Invalid HTTP packet");
 					break;
 				}
-			} else {
-				if (!key && *buffer.data() == ':') {
-					// KEY
-					key = signifiant;
-					signifiant = STR buffer.data() + 1;
-				}
-				_stage = RIGHT;
 			}
 
 			++buffer;
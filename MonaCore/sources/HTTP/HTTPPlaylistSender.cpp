@@ -17,39 +17,127 @@ details (or else see http://www.gnu.org/licenses/).
 */
 
 #include "Mona/HTTP/HTTPPlaylistSender.h"
+#include "Mona/AVC.h"
+#include "Mona/HEVC.h"
 
 using namespace std;
 
 
 namespace Mona {
 
-template<typename SenderType, typename PlaylistType>
-static void Send(SenderType& sender, const PlaylistType& playlist, const Path& type, const HTTP::Header& request) {
-	Exception ex;
-	bool success;
-	AUTO_ERROR(success = Playlist::Write(ex, type.extension(), playlist, sender.buffer()), TypeOf<PlaylistType>());
-	if (success) {
-		const char* subMime = request.subMime;
-		MIME::Type mime = request.mime;
-		if (!mime)
-			mime = MIME::Read(type, subMime);
-		sender.send(HTTP_CODE_200, mime, subMime);
-	} else
-		sender.sendError(HTTP_CODE_406, ex);
+static bool SendNotModified(HTTPSender& sender, const HTTP::Header& request, const string& etag) {
+	if (!request.ifNoneMatch || !strstr(request.ifNoneMatch, etag.c_str()))
+		return false;
+	// playlist unchanged
+	HTTP_BEGIN_HEADER(sender.buffer())
+		HTTP_ADD_HEADER("ETag", etag)
+	HTTP_END_HEADER
+	sender.send(HTTP_CODE_304);
+	return true;
+}
+
+static void Send(HTTPSender& sender, const HTTP::Header& request, const Path& type, const string& etag, const Packet& rendered) {
+	HTTP_BEGIN_HEADER(sender.buffer())
+		HTTP_ADD_HEADER("ETag", etag)
+	HTTP_END_HEADER
+	const char* subMime = request.subMime;
+	MIME::Type mime = request.mime;
+	if (!mime)
+		mime = MIME::Read(type, subMime);
+	if (sender.send(HTTP_CODE_200, mime, subMime, rendered.size()))
+		sender.send(rendered);
 }
 
 
 bool HTTPPlaylistSender::run() {
+	const string& etag = _pPlaylists->etag;
+	if (SendNotModified(self, *pRequest, etag))
+		return true;
 	Path type = _playlist;
-	_playlist.setExtension(_format);
-	Send(self, _playlist, type, *pRequest);
+	if (!_rendered) {
+		// first request of this playlist version, render it for the next ones
+		_playlist.setExtension(_format);
+		shared<Buffer> pBuffer(SET);
+		Exception ex;
+		bool success;
+		AUTO_ERROR(success = Playlist::Write(ex, type.extension(), _playlist, *pBuffer), "Playlist");
+		if (!success) {
+			sendError(HTTP_CODE_406, ex);
+			return true;
+		}
+		_rendered.set(pBuffer);
+		_pPlaylists->set(_key, _rendered);
+	}
+	Send(self, *pRequest, type, etag, _rendered);
 	return true;
 }
 
+
+HTTPMPlaylistSender::HTTPMPlaylistSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
+	const Path& path, const vector<const Publication*>& renditions) : _playlist(path), _etag("\""), HTTPSender("HTTPMPlaylistSender", pRequest, pSocket) {
+	// master changes with the renditions (new segment of one of them, or rendition added or removed)
+	for (const Publication* pRendition : renditions) {
+		const string& etag = pRendition->segments.playlists()->etag;
+		if (_etag.size() > 1)
+			_etag += '.';
+		_etag.append(etag, 1, etag.size() - 2);
+	}
+	_etag += '"';
+	if (renditions.empty() || (pRequest->ifNoneMatch && strstr(pRequest->ifNoneMatch, _etag.c_str())))
+		return; // 304
+	_pPlaylists = renditions.front()->segments.playlists();
+	String::Assign(_key, "master.", path.name(), '.', _etag);
+	_rendered = _pPlaylists->get(_key);
+	if (_rendered)
+		return; // else build the master (here because publications are not thread-safe)
+	for (const Publication* pRendition : renditions) {
+		Playlist::Master::Item& item = _playlist.items[pRendition->name()];
+		Playlist playlist(path);
+		pRendition->segments.to(playlist);
+		item.bandwidth = pRendition->maxByteRate() * 8;
+		if (!item.bandwidth)
+			item.bandwidth = playlist.bandwidth;
+		item.averageBandwidth = playlist.bandwidth;
+		item.codecs = move(playlist.codecs);
+		// resolution of the first video track configured
+		for (const Publication::VideoTrack& track : pRendition->videos) {
+			if (!track.config)
+				continue;
+			Packet vps, sps, pps;
+			UInt32 dimension;
+			if (track.config.codec == Media::Video::CODEC_H264 && AVC::ParseVideoConfig(track.config, sps, pps))
+				dimension = AVC::SPSToVideoDimension(sps.data(), sps.size());
+			else if (track.config.codec == Media::Video::CODEC_HEVC && HEVC::ParseVideoConfig(track.config, vps, sps, pps))
+				dimension = HEVC::SPSToVideoDimension(sps.data(), sps.size());
+			else
+				continue;
+			item.width = dimension >> 16;
+			item.height = dimension & 0xFFFF;
+			break;
+		}
+	}
+}
+
 bool HTTPMPlaylistSender::run() {
+	if (SendNotModified(self, *pRequest, _etag))
+		return true;
 	Path type = _playlist;
-	_playlist.set(_playlist.parent());
-	Send(self, _playlist, type, *pRequest);
+	if (!_rendered) {
+		// first request of this master version, render it for the next ones
+		_playlist.set(_playlist.parent());
+		shared<Buffer> pBuffer(SET);
+		Exception ex;
+		bool success;
+		AUTO_ERROR(success = Playlist::Write(ex, type.extension(), _playlist, *pBuffer), "Master playlist");
+		if (!success) {
+			sendError(HTTP_CODE_406, ex);
+			return true;
+		}
+		_rendered.set(pBuffer);
+		if (_pPlaylists)
+			_pPlaylists->set(_key, _rendered);
+	}
+	Send(self, *pRequest, type, _etag, _rendered);
 	return true;
 }
 
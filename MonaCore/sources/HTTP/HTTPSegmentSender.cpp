@@ -17,6 +17,7 @@ details (or else see http://www.gnu.org/licenses/).
 */
 
 #include "Mona/HTTP/HTTPSegmentSender.h"
+#include "Mona/MP4Writer.h"
 
 using namespace std;
 
@@ -24,19 +25,31 @@ using namespace std;
 namespace Mona {
 
 HTTPSegmentSender::HTTPSegmentSender(const shared<const HTTP::Header>& pRequest, const shared<Socket>& pSocket,
-		const Path& path, const Segment& segment, Parameters& params) : _segment(segment), _path(path),
+		const Path& path, const Segment& segment, Parameters& params, const Segment* pInit) : _segment(segment), _path(path),
 		HTTPSender("HTTPSegmentSender", pRequest, pSocket), _subscription(self),
 		_onWrite([this](const Packet& packet) {
+			// CMAF init part (ftyp+moov) kept in front of the media segment to stay self-contained
+			bool init = _pInitMuxing && _pMuxing->empty() && MP4Writer::IsInit(packet);
+			if (init)
+				_pInitMuxing->emplace_back(move(packet), packet.data(), packet.size());
+			_pMuxing->emplace_back(move(packet), packet.data(), packet.size());
+			if (_pInit && !init)
+				return; // init segment requested, just its init part
 			if(!send(packet))
 				_pWriter.reset(); // connection death! Stop subscription!
 		}) {
+	// subscription parameters can change muxing, they are a part of the cache key
+	for (const auto& it : params)
+		String::Append(_format, '&', it.first, '=', it.second);
 	_subscription.setParams(move(params));
 	_itMedia = _segment.begin();
+	if (pInit)
+		_pInit.set(*pInit);
 }
 
 
 bool HTTPSegmentSender::run() {
-	if (!_pWriter) {
+	if (!_pWriter && !_pMuxed) {
 		if (_itMedia == _segment.end()) {
 			sendError(HTTP_CODE_404, "Segment ", _path.name(), " empty");
 			return true;
@@ -49,12 +62,43 @@ bool HTTPSegmentSender::run() {
 			sendError(HTTP_CODE_406, "Segment ", _path.name(), " with a non acceptable type ", subMime);
 			return true;
 		}
-		_pWriter = MediaWriter::New(subMime);
-		if (!_pWriter) {
-			sendError(HTTP_CODE_501, "Segment ", _path.name(), " not supported");
-			return true;
+		_format.insert(0, subMime);
+		_pMuxed = (_pInit ? *_pInit : _segment).muxed(_format);
+		if (_pMuxed) {
+			UInt64 size(0);
+			for (const Packet& packet : *_pMuxed)
+				size += packet.size();
+			_itMuxed = _pMuxed->begin();
+			send(HTTP_CODE_200, mime, subMime, size);
+		} else {
+			_pWriter = MediaWriter::New(subMime);
+			if (!_pWriter) {
+				sendError(HTTP_CODE_501, "Segment ", _path.name(), " not supported");
+				return true;
+			}
+			MP4Writer* pMP4Writer = dynamic_cast<MP4Writer*>(_pWriter.get());
+			if (pMP4Writer) {
+				// CMAF, fragments end exactly on the segment end
+				pMP4Writer->setEndTime(_segment.time() + _segment.duration());
+				_pInitMuxing.set();
+			} else if (_pInit) {
+				sendError(HTTP_CODE_406, "Segment ", _path.name(), " has no init part, init segment is just for MP4 format");
+				return true;
+			}
+			_pMuxing.set();
+			send(HTTP_CODE_200, mime, subMime, UINT64_MAX);
 		}
-		send(HTTP_CODE_200, mime, subMime, UINT64_MAX);
+	}
+
+	if (_pMuxed) {
+		// already muxed, zero-copy sending
+		while (_itMuxed != _pMuxed->end()) {
+			if (HTTPSender::flushing())
+				return false; // socket queueing, wait!
+			if (!send(*_itMuxed++))
+				return true; // connection death!
+		}
+		return true;
 	}
 
 	// use subscription to support properties subscription
@@ -68,6 +112,13 @@ bool HTTPSegmentSender::run() {
 			return true; // connection death!
 	}
 	_subscription.reset();
+	if (_pWriter) { // fully muxed, cache it for the next requests
+		_segment.setMuxed(_format, _pMuxing);
+		if (_pInit && _pInitMuxing)
+			_pInit->setMuxed(_format, _pInitMuxing);
+	}
+	_pMuxing.reset();
+	_pInitMuxing.reset();
 	return true;
 }
 
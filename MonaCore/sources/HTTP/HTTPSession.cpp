@@ -46,6 +46,12 @@ HTTPSession::HTTPSession(Protocol& protocol, const shared<Socket>& pSocket) : TC
 
 		if (request) { // else progressive! => PUT or POST media!
 
+			if (_pWaiting) {
+				// a new request cancels the LL-HLS blocking request
+				_pWaiting.reset();
+				_pWriter->writeError(HTTP_CODE_503, "Blocking request canceled by a new request");
+				_pWriter->flush();
+			}
 			_pWriter->beginRequest(request);
 
 			////  Fill peers infos
@@ -247,11 +253,18 @@ bool HTTPSession::manage() {
 	// If answering waits end of response, usefull for VLC file playing for example (which can to ::recv after a quantity of data in socket.available())
 	// In HTTP we can use some "auto feature" like RDV which doesn't pass over main thread (implemented in HTTPDecoder)
 	// So timeout just on nothing more is sending during timeout (send = valid HTTP response)
-	else if ((_pSubscription && _pSubscription->streaming()) || _pWriter->answering() || !self->sendTime().isElapsed(timeout))
+	else if ((_pSubscription && _pSubscription->streaming()) || _pWriter->answering() || _pWaiting || !self->sendTime().isElapsed(timeout))
 		(UInt32&)this->timeout = 0;
 		
 	if (!TCPSession::manage())
 		return false;
+
+	// LL-HLS blocking request has to be answered in less than 3 target durations
+	if (_pWaiting && _waitingTime.isElapsed(_waitingTimeout)) {
+		_pWaiting.reset();
+		_pWriter->writeError(HTTP_CODE_503, "Part or segment unavailable after ", _waitingTimeout, "ms");
+		flush();
+	}
 	
 	// check subscription
 	if (_pSubscription) {
@@ -298,6 +311,7 @@ void HTTPSession::kill(Int32 error, const char* reason){
 	// Stop decoding
 	_onRequest = nullptr;
 	_onResponse = nullptr;
+	_pWaiting.reset();
 
 	if (_pUpgradeSession)
 		_pUpgradeSession->kill(error, reason);
@@ -348,6 +362,23 @@ void HTTPSession::unpublish() {
 	_pPublication = NULL;
 }
 
+void HTTPSession::wait(const Segments& segments, UInt32 sequence, Int32 part, function<void(const Segments&)>&& answer) {
+	_pWaiting.reset(); // only one blocking request
+	if (segments.has(sequence, part))
+		return answer(segments);
+	_waitingTimeout = 3 * max(UInt32(segments.maxDuration()), 1000u);
+	_waitingTime.update();
+	_pWaiting.set([this, sequence, part, answer](const Segments& segments) {
+		if (!segments.has(sequence, part))
+			return false;
+		answer(segments);
+		_pWaiting.reset();
+		flush();
+		return true;
+	});
+	segments.wait(_pWaiting);
+}
+
 void HTTPSession::processOptions(Exception& ex, const HTTP::Header& request) {
 	// Control methods quiested
 	HTTP_BEGIN_HEADER(_pWriter->writeRaw(HTTP_CODE_200))
@@ -402,8 +433,8 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 					// subtitle?
 					if (String::ICompare(file.extension(), "srt") == 0)
 						break;
-					// m3u8?
-					if((isPlaylist = String::ICompare(file.extension(), "m3u8") == 0))
+					// m3u8 or mpd?
+					if((isPlaylist = String::ICompare(file.extension(), "m3u8") == 0 || String::ICompare(file.extension(), "mpd") == 0))
 						break;
 				default:;
 					_pWriter->writeFile(file, fileProperties);
@@ -441,8 +472,12 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 			// - media => search if it's a segment, otherwise attempt a subscription (wait publication)
 			Int32 sequence;
 			UInt16 duration = 0;
+			UInt16 part;
+			bool isPart = false, isInit = false;
 			size_t size;
-			if (isPlaylist || (size = Segment::ReadName(file.baseName(), (UInt32&)sequence, duration)) != string::npos) {
+			if (isPlaylist || (size = Segment::ReadName(file.baseName(), (UInt32&)sequence, duration)) != string::npos ||
+				(isPart = (size = Segment::ReadPartName(file.baseName(), (UInt32&)sequence, part)) != string::npos) ||
+				(isInit = (size = Segment::ReadInitName(file.baseName())) != string::npos)) {
 
 				string publication = file.baseName();
 				if (!isPlaylist)
@@ -467,7 +502,48 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 							Parameters params;
 							MapWriter<Parameters> writeParams(params);
 							parameters.read(writeParams);
-							_pWriter->writePlaylist(file, *pSegments, params.getString("format", "ts"));
+							// DASH requires CMAF segments (mp4)
+							string format(params.getString("format", String::ICompare(file.extension(), "mpd") == 0 ? "mp4" : "ts"));
+							UInt32 msn;
+							if (!params.getNumber("_HLS_msn", msn)) {
+								// DVR window in seconds, all the DVR ring if no value
+								const char* dvr = params.getString("dvr");
+								_pWriter->writePlaylist(file, *pSegments, move(format), dvr ? String::ToNumber<UInt32, 0xFFFFFFFF>(dvr) : 0);
+								return true;
+							}
+							// LL-HLS blocking playlist reload
+							wait(*pSegments, msn, params.getNumber<Int32, -1>("_HLS_part"), [this, file, format](const Segments& segments) {
+								_pWriter->writePlaylist(file, segments, string(format));
+							});
+							return true;
+						}
+
+						if (isPart) {
+							// LL-HLS part, blocking if it's the preload hint part
+							shared<Parameters> pParams(SET);
+							MapWriter<Parameters> writeParams(*pParams);
+							parameters.read(writeParams);
+							wait(*pSegments, sequence, part, [this, file, sequence, part, pParams](const Segments& segments) {
+								const Segment& segment = segments(UInt32(sequence), part);
+								if (segment)
+									_pWriter->writeSegment(file, segment, *pParams);
+								else
+									_pWriter->writeError(HTTP_CODE_404, "Part ", part, " of segment ", UInt32(sequence), " unavailable");
+							});
+							return true;
+						}
+
+						if (isInit) {
+							// CMAF init segment, muxed from the last segment to get the current configs and cached by the Segments
+							const Segment segment = (*pSegments)(-1);
+							if (!segment) {
+								ex.set<Ex::Unfound>("Init segment of publication ", publication, " unavailable");
+								return false;
+							}
+							Parameters params;
+							MapWriter<Parameters> writeParams(params);
+							parameters.read(writeParams);
+							_pWriter->writeSegment(file, segment, params, &pSegments->initSegment());
 							return true;
 						}
 
@@ -477,7 +553,7 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 							/// test1AAA.ts, before last segment => -2
 							sequence = -(sequence+1);
 						}
-						const Segment& segment = (*pSegments)(sequence);
+						const Segment segment = (*pSegments)(sequence);
 						if (!segment) {
 							ex.set<Ex::Unfound>("Segment ", sequence, " of publication ", publication, " unavailable");
 							return false;
@@ -498,15 +574,15 @@ bool HTTPSession::processGet(Exception& ex, HTTP::Request& request, QueryReader&
 
 				} else {
 					if (isPlaylist) {
-						// search if it can be a master-playlist request
-						Playlist::Master playlist(file);
+						// search if it can be a master-playlist request, renditions are the publications prefixed by its name (name_1080, name_720, ...)
+						vector<const Publication*> renditions;
 						while (it != api.publications().end() && it->first.compare(0, publication.size(), publication) == 0) {
 							const Publication& publication((it++)->second);
 							if(publication.segmenting())
-								playlist.items[publication.name()] = publication.maxByteRate();
+								renditions.emplace_back(&publication);
 						}
-						if(playlist) {
-							_pWriter->writeMasterPlaylist(move(playlist));
+						if(!renditions.empty()) {
+							_pWriter->writeMasterPlaylist(file, renditions);
 							return true;
 						}
 					}
@@ -600,7 +676,7 @@ bool HTTPSession::invoke(Exception& ex, HTTP::Request& request, QueryReader& par
 	if (!name && !request.file.isFolder())
 		name = request.file.name().c_str();
 
-	bool hasContent = request->hasKey("content-length");
+	bool hasContent = request->contentLength != NULL;
 	string method;
 	Media::Data::Type type = Media::Data::ToType(request->subMime);
 	DataReader* pReader = hasContent ? Media::Data::NewReader<ByteReader>(type, request).release() : &parameters;
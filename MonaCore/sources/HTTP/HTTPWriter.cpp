@@ -211,8 +211,8 @@ void HTTPWriter::writeFile(const Path& file, Parameters& properties) {
 		newSender<HTTPFolderSender>(true, file, properties);
 }
 
-void HTTPWriter::writeSegment(const Path& path, const Segment& segment, Parameters& params) {
-	shared<HTTPSegmentSender> pSender = newSender<HTTPSegmentSender>(true, path, segment, params);
+void HTTPWriter::writeSegment(const Path& path, const Segment& segment, Parameters& params, const Segment* pInit) {
+	shared<HTTPSegmentSender> pSender = newSender<HTTPSegmentSender>(true, path, segment, params, pInit);
 	if (pSender)
 		pSender->onEnd = _onSenderEnd;
 }
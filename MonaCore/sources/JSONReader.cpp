@@ -20,13 +20,134 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/Logs.h"
 #include "Mona/Util.h"
 #include <sstream>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define JSON_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define JSON_NEON
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
 
 using namespace std;
 
 namespace Mona {
 
+UInt32 JSONReader::IndexSize(512);
 
-JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataReader(packet), _isValid(false) {
+struct Masks {
+	UInt64 quotes;
+	UInt64 backslashes;
+	UInt64 operators; // { } [ ] : ,
+};
+
+#if defined(JSON_NEON)
+static UInt64 Movemask(uint8x16_t value) {
+	static const uint8_t Bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t masked(vandq_u8(value, vld1q_u8(Bits)));
+	return vaddv_u8(vget_low_u8(masked)) | (UInt64(vaddv_u8(vget_high_u8(masked))) << 8);
+}
+#endif
+
+// classify 64 bytes
+static void Classify(const UInt8* data, Masks& masks) {
+	masks.quotes = masks.backslashes = masks.operators = 0;
+#if defined(JSON_SSE2)
+	const __m128i quote(_mm_set1_epi8('"')), backslash(_mm_set1_epi8('\\')), lower(_mm_set1_epi8(0x20));
+	const __m128i open(_mm_set1_epi8('{')), close(_mm_set1_epi8('}')), colon(_mm_set1_epi8(':')), comma(_mm_set1_epi8(','));
+	for (UInt8 i = 0; i < 64; i += 16) {
+		__m128i chunk(_mm_loadu_si128((const __m128i*)(data + i)));
+		__m128i folded(_mm_or_si128(chunk, lower)); // [ => { and ] => }
+		masks.quotes |= UInt64(UInt16(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << i;
+		masks.backslashes |= UInt64(UInt16(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << i;
+		masks.operators |= UInt64(UInt16(_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma))
+		)))) << i;
+	}
+#elif defined(JSON_NEON)
+	const uint8x16_t quote(vdupq_n_u8('"')), backslash(vdupq_n_u8('\\')), lower(vdupq_n_u8(0x20));
+	const uint8x16_t open(vdupq_n_u8('{')), close(vdupq_n_u8('}')), colon(vdupq_n_u8(':')), comma(vdupq_n_u8(','));
+	for (UInt8 i = 0; i < 64; i += 16) {
+		uint8x16_t chunk(vld1q_u8(data + i));
+		uint8x16_t folded(vorrq_u8(chunk, lower)); // [ => { and ] => }
+		masks.quotes |= Movemask(vceqq_u8(chunk, quote)) << i;
+		masks.backslashes |= Movemask(vceqq_u8(chunk, backslash)) << i;
+		masks.operators |= Movemask(vorrq_u8(vorrq_u8(vceqq_u8(folded, open), vceqq_u8(folded, close)), vorrq_u8(vceqq_u8(chunk, colon), vceqq_u8(chunk, comma)))) << i;
+	}
+#else
+	for (UInt8 i = 0; i < 64; ++i) {
+		switch (data[i]) {
+			case '"':
+				masks.quotes |= 1ull << i;
+				break;
+			case '\\':
+				masks.backslashes |= 1ull << i;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				masks.operators |= 1ull << i;
+			default:;
+		}
+	}
+#endif
+}
+
+// characters escaped by an odd sequence of backslashes, prevEscaped carries it to the next block
+static UInt64 FindEscaped(UInt64 backslashes, UInt64& prevEscaped) {
+	static const UInt64 EvenBits(0x5555555555555555ull);
+	backslashes &= ~prevEscaped;
+	UInt64 followsEscape((backslashes << 1) | prevEscaped);
+	UInt64 oddStarts(backslashes & ~EvenBits & ~followsEscape);
+	UInt64 evenStarts(oddStarts + backslashes);
+	prevEscaped = evenStarts < oddStarts ? 1 : 0; // overflow
+	return (EvenBits ^ (evenStarts << 1)) & followsEscape;
+}
+
+// bit i = xor of bits 0 to i, so bits inside of quotes
+static UInt64 PrefixXor(UInt64 mask) {
+	mask ^= mask << 1;
+	mask ^= mask << 2;
+	mask ^= mask << 4;
+	mask ^= mask << 8;
+	mask ^= mask << 16;
+	return mask ^ (mask << 32);
+}
+
+static UInt8 FirstBit(UInt64 mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return UInt8(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, UInt32(mask)))
+		return UInt8(index);
+	_BitScanForward(&index, UInt32(mask >> 32));
+	return UInt8(index + 32);
+#else
+	return UInt8(__builtin_ctzll(mask));
+#endif
+}
+
+static bool IsBlank(const UInt8* cur, const UInt8* end) {
+	while (cur < end) {
+		if (!isspace(*cur++))
+			return false;
+	}
+	return true;
+}
+
+
+JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataReader(packet), _isValid(false), _cursor(0) {
 
 	// check first '[' and last ']' or '{ and '}'
 
@@ -56,11 +177,117 @@ JSONReader::JSONReader(const Packet& packet) : _pos(reader.position()), DataRead
 				}
 			} else if (*end == '}')
 				_isValid = true;
+			if (_isValid && reader.available() >= IndexSize && !index())
+				_structurals.clear(); // irregular JSON, let's the parser report it
 			return;
 		}
 	}
 }
 
+bool JSONReader::index() {
+	const UInt8* data(reader.data());
+	UInt32 position(reader.position());
+	UInt32 end(position + reader.available());
+	_structurals.reserve(reader.available() / 16);
+
+	// Stage 1, structural characters outside strings, and quotes of strings
+	UInt64 prevEscaped(0), inString(0);
+	Masks masks;
+	UInt8 tail[64];
+	for (; position < end; position += 64) {
+		if ((end - position) >= 64)
+			Classify(data + position, masks);
+		else {
+			memset(tail, ' ', sizeof(tail));
+			memcpy(tail, data + position, end - position);
+			Classify(tail, masks);
+		}
+		UInt64 quotes(masks.quotes & ~FindEscaped(masks.backslashes, prevEscaped));
+		UInt64 strings(PrefixXor(quotes) ^ inString);
+		UInt64 structurals(quotes | (masks.operators & ~strings));
+		inString = UInt64(-Int64(strings >> 63)); // last bit extended to the next block
+		while (structurals) {
+			_structurals.emplace_back(position + FirstBit(structurals));
+			structurals &= structurals - 1;
+		}
+	}
+	if (inString)
+		return false; // string without end
+
+	// Stage 2, string sizes and array counts (as countArrayElement), irregularities are let to the parser
+	struct Frame {
+		Frame(UInt8 marker, Structural* pArray = NULL) : marker(marker), pArray(pArray), done(false) {}
+		UInt8		marker;
+		Structural*	pArray;
+		bool		done;
+		void value() { if (pArray && !done) { ++pArray->value; done = true; } }
+	};
+	vector<Frame> frames;
+	frames.emplace_back(0);
+	bool expected(true); // value expected after { [ , :
+	position = reader.position();
+	for (auto it = _structurals.begin(); it != _structurals.end(); ++it) {
+		// scalar value before
+		if (!IsBlank(data + position, data + it->position)) {
+			frames.back().value();
+			expected = false;
+		}
+		position = it->position + 1;
+		switch (data[it->position]) {
+			case '"': {
+				Structural& quote(*it);
+				quote.value = (++it)->position - position;
+				it->value = 0xFFFFFFFF; // end of string
+				position = it->position + 1;
+				frames.back().value();
+				expected = false;
+				break;
+			}
+			case '[':
+				frames.back().value();
+				frames.emplace_back(']', &*it);
+				expected = true;
+				break;
+			case '{':
+				frames.back().value();
+				frames.emplace_back('}');
+				expected = true;
+				break;
+			case ']':
+			case '}':
+				if (data[it->position] != frames.back().marker)
+					return false;
+				frames.pop_back();
+				expected = false;
+				break;
+			case ',':
+				if (expected)
+					return false;
+				frames.back().done = false;
+				expected = true;
+				break;
+			default: // :
+				if (expected)
+					return false;
+				frames.back().value();
+				expected = true;
+		}
+	}
+	return frames.size() == 1;
+}
+
+const JSONReader::Structural* JSONReader::structural(UInt32 position) {
+	if (_structurals.empty())
+		return NULL;
+	if (_cursor >= _structurals.size() || _structurals[_cursor].position > position) // reseted
+		_cursor = lower_bound(_structurals.begin(), _structurals.end(), position, [](const Structural& structural, UInt32 position) { return structural.position < position; }) - _structurals.begin();
+	else {
+		while (_cursor < _structurals.size() && _structurals[_cursor].position < position)
+			++_cursor;
+	}
+	return (_cursor < _structurals.size() && _structurals[_cursor].position == position) ? &_structurals[_cursor] : NULL;
+}
+
 
 UInt8 JSONReader::followingType() {
 	if (!_isValid)
@@ -172,10 +399,14 @@ bool JSONReader::readOne(UInt8 type, DataWriter& writer) {
 			return true;
 
 		case ARRAY: {
+			const Structural* pArray(structural(reader.position()));
 			reader.next(); // skip [
 			// count number of elements
 			UInt32 count(0);
-			countArrayElement(count);
+			if (pArray)
+				count = pArray->value;
+			else
+				countArrayElement(count);
 			// write array
 			writer.beginArray(count);
 			while (count-- > 0) {
@@ -302,6 +533,11 @@ bool JSONReader::readOne(UInt8 type, DataWriter& writer) {
 const char* JSONReader::jumpToString(UInt32& size) {
 	if (!jumpTo('"'))
 		return NULL;
+	const Structural* pQuote(structural(reader.position()));
+	if (pQuote && pQuote->value != 0xFFFFFFFF) {
+		size = pQuote->value;
+		return (const char*)reader.current() + 1;
+	}
 	const UInt8* cur(reader.current()+1);
 	const UInt8* end(cur+reader.available()-1);
 	size = 0;
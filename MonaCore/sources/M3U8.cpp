@@ -30,7 +30,14 @@ namespace Mona {
 Buffer& M3U8::Write(const Playlist::Master& playlist, Buffer& buffer) {
 	String::Append(buffer, HEADER);
 	for (const auto& it : playlist.items) {
-		String::Append(buffer, "\n#EXT-X-STREAM-INF:BANDWIDTH=", it.second*8); // bit/s
+		const Playlist::Master::Item& item = it.second;
+		String::Append(buffer, "\n#EXT-X-STREAM-INF:BANDWIDTH=", item.bandwidth);
+		if (item.averageBandwidth)
+			String::Append(buffer, ",AVERAGE-BANDWIDTH=", item.averageBandwidth);
+		if (item.width && item.height)
+			String::Append(buffer, ",RESOLUTION=", item.width, 'x', item.height);
+		if (!item.codecs.empty())
+			String::Append(buffer, ",CODECS=\"", item.codecs, '"');
 		String::Append(buffer, "\n", playlist.parent(), playlist.name(), '/', it.first, ".m3u8");
 	}
 	return buffer;
@@ -40,24 +47,53 @@ Buffer& M3U8::Write(const Playlist& playlist, Buffer& buffer, const char* type)
 	UInt32 sequence = playlist.sequence;
 	//  Round maxDuration, HLS tolerate a segment duration superior of 0.5 to target-duration
 	// "Media Segments MUST NOT exceed the target duration by more than 0.5 seconds"
-	String::Append(buffer, HEADER, "\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:",
+	// live-memory MP4 segments are CMAF fragments sharing the same init segment
+	bool cmaf = !type && String::ICompare(playlist.extension(), "mp4") == 0;
+	String::Append(buffer, HEADER, "\n#EXT-X-VERSION:", (playlist.partDuration || cmaf) ? 6 : 3, "\n#EXT-X-TARGETDURATION:",
 		(playlist.maxDuration+500) / 1000, "\n#EXT-X-MEDIA-SEQUENCE:", sequence); 
+	if (playlist.partDuration) {
+		// LL-HLS, PART-HOLD-BACK = 3 x PART-TARGET as recommended
+		String::Append(buffer, "\n#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=", String::Format<double>("%.3f", playlist.partDuration * 3 / 1000.0));
+		String::Append(buffer, "\n#EXT-X-PART-INF:PART-TARGET=", String::Format<double>("%.3f", playlist.partDuration / 1000.0));
+	}
 	if (type)
 		String::Append(buffer, "\n#EXT-X-PLAYLIST-TYPE:", type);
 	else // else is a live playlist (not VOD or EVENT)
 		String::Append(buffer, "\n#EXT-X-ALLOW-CACHE:NO");
+	if (cmaf)
+		String::Append(Segment::WriteInitName(playlist.baseName(), String::Append(buffer, "\n#EXT-X-MAP:URI=\"")), '.', playlist.extension(), '"');
+	vector<Playlist::Part>::const_iterator itPart = playlist.parts.begin();
 	UInt32 i = 0;
 	for (UInt32 duration : playlist.durations()) {
 		++i;
 		if (duration) {
+			itPart = WriteParts(playlist, sequence, itPart, buffer);
 			WRITE_EXTINF(buffer, duration);
 			String::Append(Segment::WriteName(playlist.baseName(), sequence++, duration, buffer), '.', playlist.extension());
 		} else if(i==playlist.count())
 			String::Append(buffer, i < playlist.count() ? DISCONTINUITY : ENDLIST);
 	}
+	if (playlist.partDuration) {
+		// parts of the segment in building, and the next part as preload hint
+		vector<Playlist::Part>::const_iterator itEnd = WriteParts(playlist, sequence, itPart, buffer);
+		UInt16 part = (itEnd != playlist.parts.begin() && (itEnd - 1)->sequence == sequence) ? ((itEnd - 1)->index + 1) : 0;
+		String::Append(Segment::WritePartName(playlist.baseName(), sequence, part, String::Append(buffer, "\n#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"")), '.', playlist.extension(), '"');
+	}
 	return buffer;
 }
 
+vector<Playlist::Part>::const_iterator M3U8::WriteParts(const Playlist& playlist, UInt32 sequence, vector<Playlist::Part>::const_iterator it, Buffer& buffer) {
+	for (; it != playlist.parts.end() && it->sequence <= sequence; ++it) {
+		if (it->sequence < sequence)
+			continue; // part of a segment not present in the playlist
+		String::Append(buffer, "\n#EXT-X-PART:DURATION=", String::Format<double>("%.3f", it->duration / 1000.0), ",URI=\"");
+		String::Append(Segment::WritePartName(playlist.baseName(), sequence, it->index, buffer), '.', playlist.extension(), '"');
+		if (it->independent)
+			String::Append(buffer, ",INDEPENDENT=YES");
+	}
+	return it;
+}
+
 
 M3U8::Writer::~Writer() {
 	if (!opened())
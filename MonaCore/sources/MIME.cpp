@@ -52,6 +52,7 @@ MIME::Type MIME::Read(const Path& file, const char*& subType) {
 		{ "265",{ TYPE_VIDEO, "hevc" } },
 		{ "mp3",{ TYPE_AUDIO, "mp3" } },
 		{ "m3u8",{ TYPE_APPLICATION, "x-mpegURL" } },
+		{ "mpd",{ TYPE_APPLICATION, "dash+xml" } },
 		{ "aac",{ TYPE_AUDIO, "aac" } },
 		{ "svg", { TYPE_APPLICATION, "svg+xml"} },
 		{ "m3u", { TYPE_AUDIO, "m3u"} },
@@ -174,10 +174,23 @@ MP4Reader::Box& MP4Reader::Box::operator-=(UInt32 readen) {
 
 UInt32 MP4Reader::parse(Packet& buffer, Media::Source& source) {
 	UInt32 rest = parseData(buffer, source);
+	if (_seek) {
+		// jump, next data will begin at _seek position
+		_position = _seek;
+		return 0;
+	}
 	_position += buffer.size() - rest;
 	return rest;
 }
 
+bool MP4Reader::seeking(UInt64& position) {
+	if (!_seek)
+		return false;
+	position = _seek;
+	_seek = 0;
+	return true;
+}
+
 UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 
 	BinaryReader reader(packet.data(), packet.size());
@@ -206,6 +219,8 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 				_boxes.emplace_back();
 				continue;
 			case FOURCC('m', 'o', 'o', 'v'): // MOOV
+				if (_tail)
+					break; // moov at the end already read before mdat, skip it
 				// Reset resources =>
 				_times.clear(); // force to flush all Medias!
 				if (!_firstMoov) {
@@ -485,6 +500,23 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 				}
 				break;
 			}
+			case FOURCC('s', 't', 's', 's'): { // STSS
+				// Sync sample
+				if (_tracks.empty()) {
+					ERROR("Sync sample box not through a Track box");
+					break;
+				}
+				if (reader.available()<box)
+					return reader.available();
+				Track& track = _tracks.back();
+				BinaryReader stss(reader.current(), box);
+				stss.next(4); // version + flags
+				UInt32 count = stss.read32();
+				track.keys.reserve(min(count, stss.available() / 4));
+				while (count-- && stss.available() >= 4)
+					track.keys.emplace_back(stss.read32());
+				break;
+			}
 			case FOURCC('s', 't', 's', 'z'): { // STSZ
 				// Sample size
 				if (_tracks.empty()) {
@@ -726,9 +758,31 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 				// DATA
 				if (_failed)
 					break;
+				if (seekable && _boxes.size() == 1 && box == box.contentSize()) {
+					// beginning of mdat
+					UInt64 position = _position + reader.position();
+					if (_tracks.empty()) {
+						if (!_tail) {
+							// moov after mdat, read it and come back here then
+							_mdat = position - 8;
+							_seek = position + box;
+							_boxes.back() = nullptr;
+							return 0;
+						}
+					} else if (_start) {
+						// start on the key frame chunk
+						UInt64 target = seek(_start);
+						_start = 0;
+						if (target > position) {
+							box -= UInt32(target - position);
+							_seek = target;
+							return 0;
+						}
+					}
+				}
 				while(reader.available()) {
 					if (_tracks.empty()) {
-						ERROR("No tracks information before mdat (No support of mdat box before moov box)");
+						ERROR("No tracks information before mdat (mdat box before moov box requires a file reading)");
 						_failed = true;
 						break;
 					}
@@ -736,9 +790,9 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 						break;
 
 					// consume
-					UInt32 value = reader.position() + _position;				
-					if (value < _chunks.begin()->first)
-						box -= reader.next(UInt32(_chunks.begin()->first - value));
+					UInt64 position = reader.position() + _position;
+					if (position < _chunks.begin()->first)
+						box -= reader.next(UInt32(_chunks.begin()->first - position));
 
 					Track& track = *_chunks.begin()->second;
 					if (!track.timeStep) {
@@ -768,7 +822,7 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 					while (track.sample<samples) {
 						
 						// determine size
-						value = track.sample + track.samples;
+						UInt32 value = track.sample + track.samples;
 						UInt32 size = value < track.sizes.size() ? track.sizes[value] : track.size;
 						if (reader.available() < size) {
 							flushMedias(source); // flush when all read buffer is readen
@@ -904,12 +958,23 @@ UInt32 MP4Reader::parseData(const Packet& packet, Media::Source& source) {
 			continue;
 		// pop last box
 		UInt32 size;
+		bool moov = false;
 		do {
 			size = _boxes.back().size();
+			if (_boxes.back().code() == FOURCC('m', 'o', 'o', 'v'))
+				moov = true;
 			_boxes.pop_back();
 		} while (!_boxes.empty() && !(_boxes.back() -= size)); // remove parent box if empty one time box children removed!
 
 		_boxes.emplace_back(); // always at less one box!
+
+		if (moov && _mdat) {
+			// moov at the end read, come back to mdat
+			_seek = _mdat;
+			_mdat = 0;
+			_tail = true;
+			return 0;
+		}
 		
 	} while (reader.available());
 
@@ -942,6 +1007,94 @@ void MP4Reader::flushMedias(Media::Source& source) {
 	_medias.erase(_medias.begin(), it);
 }
 
+UInt64 MP4Reader::seek(UInt32 time) {
+	// Key frames of the video tracks (or chunks of the other tracks if no video), time => chunk position
+	bool hasVideo = false;
+	for (const Track& track : _tracks) {
+		if (!track.types.empty() && track.types.front() == Media::TYPE_VIDEO)
+			hasVideo = true;
+	}
+	struct Cursor : virtual Object {
+		Cursor(const Track& track) : time(track.time), sample(0), chunk(0), duration(0), repeat(0), key(0), change(track.changes.begin()) {}
+		double	time;
+		UInt32	sample;
+		UInt32	chunk;
+		UInt32	duration;
+		UInt32	repeat;
+		UInt32	key;
+		std::map<UInt32, UInt64>::const_iterator change;
+	};
+	map<const Track*, Cursor> cursors;
+	map<UInt32, UInt64> keys;
+	for (const auto& it : _chunks) {
+		const Track& track = *it.second;
+		if (track.changes.empty() || track.durations.empty())
+			continue; // invalid track, reading will fail
+		Cursor& cursor = cursors.emplace(&track, track).first->second;
+		bool indexed = !hasVideo || (!track.types.empty() && track.types.front() == Media::TYPE_VIDEO);
+		if (cursor.chunk < cursor.change->first)
+			cursor.chunk = cursor.change->first;
+		UInt32 samples = cursor.change->second >> 32;
+		for (UInt32 i = 0; i < samples; ++i) {
+			++cursor.sample; // number of sample starts to 1
+			if (indexed) {
+				if (track.keys.empty()) {
+					if (!i)
+						keys.emplace(UInt32(round(cursor.time)), it.first);
+				} else {
+					while (cursor.key < track.keys.size() && track.keys[cursor.key] < cursor.sample)
+						++cursor.key;
+					if (cursor.key < track.keys.size() && track.keys[cursor.key] == cursor.sample)
+						keys.emplace(UInt32(round(cursor.time)), it.first);
+				}
+			}
+			const Repeat& repeat = track.durations[cursor.duration];
+			cursor.time += repeat.value*track.timeStep;
+			if (++cursor.repeat >= repeat.count && (cursor.duration + 1) < track.durations.size()) {
+				++cursor.duration;
+				cursor.repeat = 0;
+			}
+		}
+		auto itNext = cursor.change;
+		if (++itNext != track.changes.end() && ++cursor.chunk >= itNext->first)
+			cursor.change = itNext;
+	}
+	auto itKey = keys.upper_bound(time);
+	if (itKey == keys.begin())
+		return 0;
+	UInt64 position = (--itKey)->second;
+	DEBUG("Start on key frame ", itKey->first, " (position=", position, ")");
+
+	// Skip chunks before the key frame position as if they had been read
+	while (!_chunks.empty() && _chunks.begin()->first < position) {
+		Track& track = *_chunks.begin()->second;
+		_chunks.erase(_chunks.begin());
+		if (track.changes.empty() || track.durations.empty())
+			continue;
+		auto it = track.changes.begin();
+		if (track.chunk < it->first)
+			track.chunk = it->first;
+		UInt32 samples = it->second >> 32;
+		while (track.sample < samples) {
+			const auto& itTime = _times.find(UInt32(round(track.time)));
+			if (itTime != _times.end() && !--itTime->second)
+				_times.erase(itTime);
+			if (!track.compositionOffsets.empty() && !--track.compositionOffsets.front().count)
+				track.compositionOffsets.pop_front();
+			Repeat& repeat = track.durations.front();
+			track.time += repeat.value*track.timeStep;
+			if (track.durations.size() > 1 && !--repeat.count)
+				track.durations.pop_front();
+			++track.sample;
+		}
+		if (++it != track.changes.end() && ++track.chunk >= it->first)
+			track.changes.erase(track.changes.begin());
+		track.samples += samples;
+		track.sample = 0;
+	}
+	return position;
+}
+
 void MP4Reader::onFlush(Packet& buffer, Media::Source& source) {
 	// release resources
 	_times.clear(); // to force media flush (and clear _medias)
@@ -954,6 +1107,8 @@ void MP4Reader::onFlush(Packet& buffer, Media::Source& source) {
 
 	_offset = _position = 0;
 	_firstMoov = true;
+	_mdat = _seek = 0;
+	_tail = false;
 
 	MediaReader::onFlush(buffer, source);
 }
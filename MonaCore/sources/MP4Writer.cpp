@@ -554,10 +554,16 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 
 		BinaryWriter(pBuffer->data() + sizePos, 4).write32(writer.size() - sizePos);
 	}
+	UInt32 sizeInit = writer.size(); // ftyp+moov size, CMAF init segment
 	if (reset) {
 		if (reset < 0) { // end (flushing)
-			// End all tracks on the same _timeBack time to add a silence to allow on a onEnd/onBegin without interval (smooth transition, especially on chrome)
-			_timeBack += BUFFER_MIN_SIZE;
+			if (_pEndTime) {
+				// CMAF segment, end all tracks exactly on the segment end
+				UInt32 endTime = *_pEndTime + _seekTime;
+				if (Util::Distance(_timeBack, endTime) > 0)
+					_timeBack = endTime;
+			} else // End all tracks on the same _timeBack time to add a silence to allow on a onEnd/onBegin without interval (smooth transition, especially on chrome)
+				_timeBack += BUFFER_MIN_SIZE;
 			_buffering = max(bufferTime - BUFFER_MIN_SIZE, BUFFER_RESET_SIZE);
 		} else {
 			DEBUG("MP4 dynamic configuration change");
@@ -571,7 +577,13 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 	writer.write(EXPAND("moof"));
 	{	// mfhd
 		writer.write(EXPAND("\x00\x00\x00\x10""mfhd\x00\x00\x00\x00"));
-		writer.write32(++_sequence); 
+		if (_pEndTime) {
+			// CMAF segment muxed alone, sequence on the media time to keep it increasing through the segments
+			UInt32 sequence = _timeFront - _seekTime + 1;
+			_sequence = sequence > _sequence ? sequence : (_sequence + 1);
+		} else
+			++_sequence;
+		writer.write32(_sequence);
 	}
 
 	UInt32 dataOffset(sizeMoof + 8); // 8 for [size]mdat
@@ -612,7 +624,13 @@ void MP4Writer::flush(const OnWrite& onWrite, Int8 reset) {
 	if (!onWrite)
 		return;
 	// header
-	onWrite(Packet(pBuffer)); 
+	if (sizeInit && _pEndTime) {
+		// CMAF segment, init segment in a separated packet
+		Packet header(pBuffer);
+		onWrite(Packet(header, header.data(), sizeInit));
+		onWrite(Packet(move(header), header.data() + sizeInit, header.size() - sizeInit));
+	} else
+		onWrite(Packet(pBuffer));
 	// payload
 	for (const deque<Frame>& frames : mediaFrames) {
 		for (const Frame& frame : frames)
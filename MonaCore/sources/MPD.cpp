@@ -0,0 +1,71 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or
+modify it under the terms of the the Mozilla Public License v2.0.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+Mozilla Public License v. 2.0 received along this program for more
+details (or else see http://mozilla.org/MPL/2.0/).
+
+*/
+
+#include "Mona/MPD.h"
+
+
+using namespace std;
+
+namespace Mona {
+
+#define WRITE_DURATION(BUFFER, NAME, DURATION) String::Append(BUFFER, " " NAME "=\"PT", String::Format<double>("%.3f", (DURATION) / 1000.0), "S\"")
+
+Buffer& MPD::Write(const Playlist& playlist, Buffer& buffer) {
+	const deque<UInt16>& durations = playlist.durations();
+	bool live = durations.empty() || durations.back(); // ended if last item is a 0 duration
+	UInt16 maxDuration = max<UInt16>(playlist.maxDuration, 1000);
+
+	String::Append(buffer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\"");
+	WRITE_DURATION(buffer, "minBufferTime", maxDuration);
+	if (live) {
+		Int64 now = Time::Now();
+		// wall clock time of the media time 0, if unknown consider last segment end as now
+		Int64 startTime = playlist.startTime ? playlist.startTime : (now - playlist.time - playlist.duration());
+		String::Append(buffer, " type=\"dynamic\" availabilityStartTime=\"", String::Date(Date(startTime, Timezone::GMT), Date::FORMAT_ISO8601));
+		String::Append(buffer, "\" publishTime=\"", String::Date(Date(now, Timezone::GMT), Date::FORMAT_ISO8601), '"');
+		WRITE_DURATION(buffer, "minimumUpdatePeriod", maxDuration);
+		WRITE_DURATION(buffer, "timeShiftBufferDepth", playlist.duration());
+		WRITE_DURATION(buffer, "suggestedPresentationDelay", maxDuration * 3);
+	} else {
+		String::Append(buffer, " type=\"static\"");
+		WRITE_DURATION(buffer, "mediaPresentationDuration", playlist.duration());
+	}
+
+	bool audioOnly = !playlist.codecs.empty() && playlist.codecs.find("avc1") == string::npos && playlist.codecs.find("hev1") == string::npos;
+	String::Append(buffer, ">\n<Period id=\"0\" start=\"PT0S\">\n<AdaptationSet mimeType=\"", audioOnly ? "audio" : "video", "/mp4\" segmentAlignment=\"true\" startWithSAP=\"1\">");
+	String::Append(buffer, "\n<Representation id=\"", playlist.baseName(), "\" bandwidth=\"", playlist.bandwidth, '"');
+	if (!playlist.codecs.empty())
+		String::Append(buffer, " codecs=\"", playlist.codecs, '"');
+	String::Append(buffer, ">\n<SegmentList timescale=\"1000\" startNumber=\"", playlist.sequence, "\">\n<Initialization sourceURL=\"");
+	String::Append(Segment::WriteInitName(playlist.baseName(), buffer), '.', playlist.extension(), "\"/>\n<SegmentTimeline>");
+	UInt32 time = playlist.time;
+	for (UInt16 duration : durations) {
+		if (!duration)
+			continue; // discontinuity or end
+		String::Append(buffer, "\n<S t=\"", time, "\" d=\"", duration, "\"/>");
+		time += duration;
+	}
+	String::Append(buffer, "\n</SegmentTimeline>");
+	UInt32 sequence = playlist.sequence;
+	for (UInt16 duration : durations) {
+		if (duration)
+			String::Append(Segment::WriteName(playlist.baseName(), sequence++, duration, String::Append(buffer, "\n<SegmentURL media=\"")), '.', playlist.extension(), "\"/>");
+	}
+	return String::Append(buffer, "\n</SegmentList>\n</Representation>\n</AdaptationSet>\n</Period>\n</MPD>\n");
+}
+
+
+} // namespace Mona
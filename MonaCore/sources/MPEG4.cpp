@@ -17,6 +17,18 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/MPEG4.h"
 #include "Mona/Logs.h"
 
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MPEG4_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
 using namespace std;
 
 namespace Mona {
@@ -99,16 +111,76 @@ UInt8 MPEG4::RateToIndex(UInt32 rate) {
 	return it->second;
 }
 
+#if defined(__AVX2__) || defined(MPEG4_SSE2)
+static UInt8 FirstBit(UInt32 mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return UInt8(index);
+#else
+	return UInt8(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+const UInt8* MPEG4::FindStartCode(const UInt8* data, const UInt8* end, UInt8 zeros) {
+	// start code astride the previous data
+	if (data < end && zeros >= 2 && *data == 1)
+		return data;
+	if ((end - data) >= 2 && zeros && !data[0] && data[1] == 1)
+		return data + 1;
+	if ((end - data) < 3)
+		return end;
+	// cur is the position of a candidate 01 byte, preceded by two bytes
+	const UInt8* cur(data + 2);
+#if defined(__AVX2__)
+	const __m256i zero(_mm256_setzero_si256()), one(_mm256_set1_epi8(1));
+	for (; (end - cur) >= 32; cur += 32) {
+		__m256i ones(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)cur), one));
+		__m256i prefixes(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(cur - 1)), zero), _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(cur - 2)), zero)));
+		UInt32 mask(_mm256_movemask_epi8(_mm256_and_si256(ones, prefixes)));
+		if (mask)
+			return cur + FirstBit(mask);
+	}
+#elif defined(MPEG4_SSE2)
+	const __m128i zero(_mm_setzero_si128()), one(_mm_set1_epi8(1));
+	for (; (end - cur) >= 16; cur += 16) {
+		__m128i ones(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)cur), one));
+		__m128i prefixes(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(cur - 1)), zero), _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(cur - 2)), zero)));
+		UInt32 mask(_mm_movemask_epi8(_mm_and_si128(ones, prefixes)));
+		if (mask)
+			return cur + FirstBit(mask);
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	const uint8x16_t one(vdupq_n_u8(1));
+	for (; (end - cur) >= 16; cur += 16) {
+		uint8x16_t prefixes(vandq_u8(vceqzq_u8(vld1q_u8(cur - 1)), vceqzq_u8(vld1q_u8(cur - 2))));
+		if (vmaxvq_u8(vandq_u8(vceqq_u8(vld1q_u8(cur), one), prefixes)))
+			break; // locate it with the scalar search
+	}
+#endif
+	// scalar search, a byte greater than 1 can't be part of a start code ending in the 2 next bytes
+	while (cur < end) {
+		if (*cur > 1)
+			cur += 3;
+		else if (!*cur)
+			++cur;
+		else if (!cur[-1] && !cur[-2])
+			return cur;
+		else
+			cur += 3;
+	}
+	return end;
+}
+
 UInt16 MPEG4::ReadExpGolomb(BitReader& reader) {
-	UInt8 i(0);
-	while (reader.available() && !reader.read())
-		++i;
-	UInt16 result = reader.read<UInt16>(i);
-	if (i > 15) {
+	UInt32 zeros(reader.readZeros());
+	if (zeros > 15) {
+		reader.next(zeros);
 		WARN("Exponential-Golomb code exceeding unsigned 16 bits");
 		return 0;
 	}
-	return result + (1 << i) - 1;
+	return reader.read<UInt16>(zeros) + (1 << zeros) - 1;
 }
 
 } // namespace Mona
@@ -35,19 +35,54 @@ unique<MediaFile::Reader> MediaFile::Reader::New(Exception& ex, const char* requ
 	return make_unique<MediaFile::Reader>(path, move(pReader), source, timer, io);
 }
 
+void MediaFile::Reader::Decoder::setTime(UInt32 time) {
+	_mediaTimeGotten = true;
+	_time = time;
+	if (!_paused)
+		return;
+	// new read-ahead window
+	_paused = false;
+	_beginTime = time;
+	_readen = 0;
+}
+
 UInt32 MediaFile::Reader::Decoder::decode(shared<Buffer>& pBuffer, bool end) {
-	DUMP_RESPONSE(_name.c_str(), pBuffer->data(), pBuffer->size(), _path);
+	DUMP_RESPONSE(_name.c_str(), pBuffer->data(), pBuffer->size(), _file.path());
 	Packet packet(pBuffer); // to capture pBuffer!
 	if (!_pReader || _pReader.unique())
 		return 0;
 	_mediaTimeGotten = false;
 	_pReader->read(packet, self);
-	if (end)
-		_pReader.reset(); // no flush, because will be done by the main thread (end of file call stop())
-	else if(!_mediaTimeGotten)
-		return packet.size(); // continue to read if no flush
-	_handler.queue(onFlush);
-	return 0;
+	_readen += packet.size();
+	UInt64 position;
+	if (_pReader->seeking(position)) {
+		// random access, continue to read from position
+		if (_file.reset(position))
+			end = false;
+		else
+			WARN(_name, " impossible to seek to ", position, " in ", _file.path());
+	}
+	if (end) {
+		_pReader->flush(self); // flush remaining medias and reset, played by the readers before their stop
+		_pReader.reset();
+	} else if(!_mediaTimeGotten)
+		return _size; // continue to read if no flush
+	Int32 duration = Util::Distance(_beginTime, _time);
+	// adapt the read size to the bitrate, around 250ms of medias by read
+	if (duration > 0)
+		_size = UInt32(max(min(_readen * 250 / duration, 0x100000u), 0xFFFFu));
+	bool reading = _pMedias->reading = !end && duration < Int32(*_pReadAhead);
+	_pMedias->eof = end;
+	_pMedias->time = _time;
+	_pMedias->readSize = _size; // for the main thread which resumes reading
+	_handler.queue(onFlush, _pMedias);
+	_pMedias.set();
+	if (!reading) {
+		// read-ahead reached, wait the main thread resumes reading
+		_paused = true;
+		return 0;
+	}
+	return _size;
 }
 
 static bool ReadMediaTime(Media::Base& media, UInt32& time) {
@@ -70,25 +105,155 @@ static bool ReadMediaTime(Media::Base& media, UInt32& time) {
 	}
 	return false;
 }
+static bool ReadMediaTime(const shared<Media::Base>& pMedia, UInt32& time) { return pMedia && ReadMediaTime(*pMedia, time); }
+
+UInt64 MediaFile::Reader::CacheSize(0x4000000); // 64MB
+
+static atomic<UInt64> _Cached(0);
+mutex	MediaFile::Reader::Demuxer::_Mutex;
+map<string, weak<MediaFile::Reader::Demuxer>> MediaFile::Reader::Demuxer::_Demuxers;
+
+shared<MediaFile::Reader::Demuxer> MediaFile::Reader::Demuxer::Join(const Path& path, const char* subMime, const Parameters& parameters, IOFile& io, const string& name) {
+	if (!parameters.getBoolean<true>("cache") || parameters.hasKey("start")) // random access is specific to one reader
+		return make_shared<Demuxer>(path, subMime, parameters, io, name);
+	string key(String(subMime, ':', path));
+	lock_guard<mutex> lock(_Mutex);
+	weak<Demuxer>& weakDemuxer = _Demuxers[key];
+	shared<Demuxer> pDemuxer = weakDemuxer.lock();
+	if (pDemuxer && &pDemuxer->io == &io && !pDemuxer->begin())
+		return pDemuxer; // beginning of the file always available!
+	pDemuxer.set(path, subMime, parameters, io, name);
+	pDemuxer->_key = move(key);
+	weakDemuxer = pDemuxer; // replace the previous demuxer which is no more joinable
+	return pDemuxer;
+}
+
+MediaFile::Reader::Demuxer::Demuxer(const Path& path, const char* subMime, const Parameters& parameters, IOFile& io, const string& name) :
+		path(path), io(io), _pReadAhead(SET, parameters.getNumber<UInt32, 2000>("readAhead")), _pReader(MediaReader::New(subMime)), _pFile(SET, path, File::MODE_READ),
+		_begin(0), _size(0), _time(0), _readSize(0xFFFF), _reading(true), _end(false) {
+	_pReader->setParams(parameters);
+	_pReader->seekable = true;
+	_onFileError = [this](const Exception& ex) {
+		_end = true;
+		for (Reader* pReader : set<Reader*>(readers)) // copy because stop() removes reader (and can delete this demuxer)
+			pReader->stop(LOG_ERROR, ex);
+	};
+	_onFlush = [this](const shared<Medias>& pMedias) {
+		UInt64 size = _size;
+		for (unique<Media::Base>& pMedia : *pMedias) {
+			if (pMedia)
+				_size += pMedia->size();
+			_medias.emplace_back(move(pMedia));
+		}
+		_Cached += _size - size;
+		_time = pMedias->time;
+		_readSize = pMedias->readSize;
+		_reading = pMedias->reading;
+		_end = pMedias->eof;
+		if (readers.empty())
+			return;
+		// hold this demuxer because _onTimer() can stop its readers
+		shared<Demuxer> pThis((*readers.begin())->_pDemuxer);
+		for (Reader* pReader : set<Reader*>(readers)) {
+			if (readers.count(pReader))
+				pReader->timer.set(pReader->_onTimer, pReader->_onTimer());
+		}
+	};
+	Decoder* pDecoder = new Decoder(io.handler, _pReader, *_pFile, name, _pReadAhead);
+	pDecoder->onFlush = _onFlush;
+	io.subscribe(_pFile, pDecoder, nullptr, _onFileError);
+	io.read(_pFile);
+}
+
+MediaFile::Reader::Demuxer::~Demuxer() {
+	io.unsubscribe(_pFile);
+	_Cached -= _size;
+	if (_key.empty())
+		return;
+	lock_guard<mutex> lock(_Mutex);
+	const auto& it = _Demuxers.find(_key);
+	if (it != _Demuxers.end() && it->second.expired())
+		_Demuxers.erase(it);
+}
+
+void MediaFile::Reader::Demuxer::setReadAhead() {
+	// each reader gets at least its read-ahead, so decode the greatest one
+	UInt32 readAhead = 0;
+	for (Reader* pReader : readers)
+		readAhead = max(readAhead, pReader->_readAhead);
+	if (readAhead)
+		*_pReadAhead = readAhead;
+}
+
+void MediaFile::Reader::Demuxer::read() {
+	if (_reading || _end)
+		return;
+	_reading = true;
+	io.read(_pFile, _readSize); // keep the read size adapted by the decoder
+}
+
+void MediaFile::Reader::Demuxer::release() {
+	// keep the beginning of the file for the readers to come while the budget allows it
+	if (!_begin && !_key.empty() && _Cached <= CacheSize)
+		return;
+	UInt64 index = end(), fastest = 0;
+	UInt32 readAhead = this->readAhead();
+	for (Reader* pReader : readers) {
+		index = min(index, pReader->_index);
+		fastest = max(fastest, pReader->_index);
+	}
+	// over budget with readers spread more than readAhead, release too medias played by the fastest reader
+	// to keep just readAhead/2 behind it (half to not release again on every play), slower readers skip them
+	UInt32 fastestTime, time;
+	bool spread(false);
+	if (index < fastest && _Cached > CacheSize) {
+		UInt64 last = fastest, first = index;
+		while (last > index && !ReadMediaTime(self[last - 1], fastestTime))
+			--last;
+		while (first < last && !ReadMediaTime(self[first], time))
+			++first;
+		spread = first < last && Util::Distance(time, fastestTime) > Int32(readAhead);
+	}
+	UInt64 size = _size;
+	while (_begin < index || (spread && _begin < fastest && (_Cached - (size - _size)) > CacheSize && (!ReadMediaTime(_medias.front(), time) || Util::Distance(time, fastestTime) > Int32(readAhead / 2)))) {
+		if (_medias.front())
+			_size -= _medias.front()->size();
+		_medias.pop_front();
+		++_begin;
+	}
+	_Cached -= size - _size;
+}
 
 MediaFile::Reader::Reader(const Path& path, unique<MediaReader>&& pReader, Media::Source& source, const Timer& timer, IOFile& io) :
-		path(path), io(io), _pReader(move(pReader)), timer(timer), _pMedias(SET),
+		path(path), io(io), _pReader(move(pReader)), timer(timer), _index(0), _readAhead(0),
 		MediaStream(TYPE_FILE, source, "Stream source file://...", Path(path.parent()).name(), '/', path.baseName(), '.', path.extension().empty() ? pReader->format() : path.extension().c_str()),
 		_onTimer([this, &source](UInt32 delay) {
-			UInt32 size = _pMedias->size();
-			bool end = _pReader.unique();
-			while (!_pMedias->empty()) {
-				if (_pMedias->front()) {
-					Media::Base& media(*_pMedias->front());
+			if (_index < _pDemuxer->begin()) {
+				// medias released by the demuxer to hold the cache budget, readers spread too much
+				WARN(description, " skips ", _pDemuxer->begin() - _index, " medias, cache size exceeded");
+				_index = _pDemuxer->begin();
+				_realTime = 0; // reset realTime
+				source.reset();
+			}
+			UInt64 index = _index;
+			while (_index < _pDemuxer->end()) {
+				const shared<Media::Base>& pMedia = (*_pDemuxer)[_index];
+				if (pMedia) {
+					Media::Base& media(*pMedia);
 					if (media || typeid(media) != typeid(Lost)) {
 						UInt32 time;
-						if(ReadMediaTime(media, time) && !end){
+						if(ReadMediaTime(media, time)){
 							if (_realTime) {
 								Int32 delta = range<Int32>(time - _realTime.elapsed());
 								if (delta > 20) { // 20 ms for timer performance reason (to limit timer raising), not more otherwise not progressive (and player load data by wave)
 									// wait delta time!
-									if(_pMedias->size()<size)
+									if (_index > index) {
 										source.flush();
+										_pDemuxer->release();
+									}
+									// resume reading when less than the half of read-ahead is buffered
+									if (Util::Distance(time, _pDemuxer->time()) < Int32(_readAhead / 2))
+										_pDemuxer->read();
 									return delta;
 								}
 								if (delta < -1000) {
@@ -104,20 +269,21 @@ MediaFile::Reader::Reader(const Path& path, unique<MediaReader>&& pReader, Media
 						source.reportLost(media.type, (Lost&)media, media.track);
 				} else
 					source.reset();
-				_pMedias->pop_front();
+				++_index;
 			} // end of while medias
-			if (_pMedias->size()<size)
+			if (_index > index) {
 				source.flush(); // flush read before because reading can take time (and to avoid too large amout of data transfer)
-			// Here _pMedias is empty!
-			if (end) {
+				_pDemuxer->release();
+			}
+			// Here every medias decoded are played!
+			if (_pDemuxer->ended()) {
 				// end of file!
 				stop();
 				return 0;
 			}
-			this->io.read(_pFile); // continue to read immediatly
+			_pDemuxer->read(); // continue to read immediatly
 			return 0;
 		}) {
-	_onFileError = [this](const Exception& ex) { stop(LOG_ERROR, ex); };
 }
 
 bool MediaFile::Reader::starting(const Parameters& parameters) {
@@ -125,29 +291,41 @@ bool MediaFile::Reader::starting(const Parameters& parameters) {
 		stop<Ex::Intern>(LOG_ERROR, "Unknown format type to read");
 		return false;
 	}
-	_pReader->setParams(parameters);
 	_realTime =	0; // reset realTime
-	Decoder* pDecoder = new Decoder(io.handler, _pReader, path, source.name(), _pMedias);
-	pDecoder->onFlush = _onFlush = [this]() { timer.set(_onTimer, _onTimer()); };
-	_pFile.set(path, File::MODE_READ);
-	io.subscribe(_pFile, pDecoder, nullptr, _onFileError);
-	io.read(_pFile);
-	return run();
+	_readAhead = parameters.getNumber<UInt32, 2000>("readAhead");
+	_pDemuxer = Demuxer::Join(path, _pReader->subMime(), parameters, io, source.name());
+	_pDemuxer->readers.emplace(this);
+	_pDemuxer->setReadAhead(); // a joined demuxer can have to read more ahead for this reader
+	_index = _pDemuxer->begin();
+	if (!run())
+		return false;
+	if (_index < _pDemuxer->end()) // joins a demuxer which has already decoded medias
+		timer.set(_onTimer, _onTimer());
+	return true;
+}
+
+UInt32 MediaFile::Reader::buffered() const {
+	if (!_pDemuxer)
+		return 0;
+	UInt32 time;
+	for (UInt64 index = _index; index < _pDemuxer->end(); ++index) {
+		if (ReadMediaTime((*_pDemuxer)[index], time))
+			return UInt32(max(Util::Distance(time, _pDemuxer->time()), 0));
+	}
+	return 0;
 }
 
 void MediaFile::Reader::stopping() {
 	timer.set(_onTimer, 0);
-	io.unsubscribe(_pFile);
-	_onFlush = nullptr;
-	// reset _pReader because could be used by different thread by new Socket and its decoding thread
-	if (_pReader.unique()) { // else always used by the decoder, impossible to flush!
-		_onTimer(); // flush possible current media remaining
-		_pReader->flush(source); // reset + flush!
-	} else
-		source.reset(); // because _pReader could be used always by the decoder (parallel!)
-	// new resource for next start
-	_pMedias.set();
-	_pReader = MediaReader::New(_pReader->subMime());
+	if (!_pDemuxer)
+		return;
+	// reset source if stopped before the end, else already done by the flush of end of file
+	if (!_pDemuxer->ended() || _index < _pDemuxer->end())
+		source.reset();
+	_pDemuxer->readers.erase(this);
+	_pDemuxer->setReadAhead();
+	_pDemuxer->release();
+	_pDemuxer.reset(); // the last reader deletes the demuxer, cancels reading
 }
 
 
@@ -171,10 +349,41 @@ unique<MediaFile::Writer> MediaFile::Writer::New(Exception& ex, const char* requ
 
 MediaFile::Writer::File::File(const string& name, const Path& path, const shared<MediaWriter>& pWriter, const shared<Playlist::Writer>& pPlaylistWriter, UInt32 segments, UInt16 duration, IOFile& io) :
 	Playlist(path), name(name), segments(segments), FileWriter(io), _pPlaylistWriter(pPlaylistWriter),
+	block(0), extent(0), syncSize(0), syncInterval(0), latency(0), maxLatency(0), _offset(0),
 	onWrite([this, address = String(path.parent(), path.name())](const Packet& packet) {
 		DUMP_REQUEST(this->name.c_str(), packet.data(), packet.size(), address);
-		write(packet);
 		// Exception ex; _pFile->write(ex, packet.data(), packet.size()); // Just usefull to test!
+		if (FileWriter::operator bool()) { // latency of previous write, from its queueing to its end on disk
+			latency = FileWriter::operator->()->delay();
+			if (latency > maxLatency)
+				maxLatency = UInt32(latency);
+		}
+		if (!block)
+			return write(packet);
+		// coalesce writes in blocks aligned on the file offset
+		Packet data(packet);
+		if (!data)
+			return;
+		if (!_pBlock)
+			_pBlock.set();
+		UInt32 size = block - (_offset + _pBlock->size()) % block; // until the next aligned position
+		if (_pBlock->size() || size < block) {
+			if (data.size() < size)
+				return (void)_pBlock->append(data.data(), data.size());
+			_pBlock->append(data.data(), size);
+			_offset += _pBlock->size();
+			write(Packet(_pBlock)); // reset _pBlock
+			data += size;
+		}
+		// large packet, write directly its aligned part
+		size = data.size() - data.size() % block;
+		if (size) {
+			write(Packet(data, data.data(), size));
+			_offset += size;
+			data += size;
+		}
+		if (data)
+			_pBlock.set(data.data(), data.size());
 	}) {
 	if (_pPlaylistWriter) {
 		setExtension(pWriter->format());// change path to match pWriter
@@ -182,6 +391,7 @@ MediaFile::Writer::File::File(const string& name, const Path& path, const shared
 			// hold pWriter in this event, deleta the event in Writer::File::~File
 			[this, pWriter = shared<MediaWriter>(pWriter)](UInt16 duration) {
 				// close and rename segment with its definitive name
+				flush();
 				close(Segment::BuildPath(self, sequence + count(), duration));
 				// add item to the playlist
 				_pPlaylistWriter->write(self, duration);
@@ -215,11 +425,24 @@ MediaFile::Writer::File& MediaFile::Writer::File::open(bool append) {
 		FileWriter::open(Segment::BuildPath(self, sequence + count(), 0));
 	} else
 		FileWriter::open(self, append);
+	Mona::File& file = *FileWriter::operator->();
+	_offset = (block && file.mode == Mona::File::MODE_APPEND) ? Path(file.path()).size(true) : 0; // blocks aligned on the file offset, end of file when appending
+	file.extent = extent;
+	file.syncSize = syncSize;
+	file.syncInterval = syncInterval;
 	return self;
 }
 
+void MediaFile::Writer::File::flush() {
+	if (_pBlock && _pBlock->size()) {
+		_offset += _pBlock->size();
+		write(Packet(_pBlock));
+	}
+	_pBlock.reset();
+}
+
 MediaFile::Writer::Writer(const Path& path, unique<MediaWriter>&& pWriter, IOFile& io) : 
-	path(path), io(io), _writeTrack(0), _pWriter(move(pWriter)), _duration(0), _segments(0), _append(false),
+	path(path), io(io), _writeTrack(0), _pWriter(move(pWriter)), _duration(0), _segments(0), _append(false), _block(0), _extent(0), _syncSize(0), _syncInterval(0),
 	MediaStream(TYPE_FILE, "Stream target file://...", Path(path.parent()).name(), '/', path.baseName(), '.', path.extension().empty() ? pWriter->format() : path.extension().c_str()) {
 	if (String::ICompare(path.extension(), "m3u8") == 0)
 		_pPlaylistWriter.set<M3U8::Writer>(io).onError = [this](const Exception& ex) { WARN(description, ", ", ex); };
@@ -232,6 +455,11 @@ bool MediaFile::Writer::starting(const Parameters& parameters) {
 	}
 	// pulse starting, nothing todo (wait beginMedia to create _pFile)
 	parameters.getBoolean("append", _append);
+	// recorder I/O
+	parameters.getNumber("block", _block);
+	parameters.getNumber("extent", _extent);
+	parameters.getNumber("syncSize", _syncSize);
+	parameters.getNumber("syncInterval", _syncInterval);
 	if (parameters.getNumber("duration", _duration)) {
 		if (!_pPlaylistWriter)
 			WARN(description, ", duration is available just in segments mode")
@@ -256,6 +484,10 @@ bool MediaFile::Writer::beginMedia(const string& name) {
 	if (!run())
 		return false;
 	_pFile.set(name, path, _pWriter, _pPlaylistWriter, _segments, _duration, io).onError = [this](const Exception& ex) { stop(LOG_ERROR, ex); };
+	_pFile->block = _block;
+	_pFile->extent = _extent;
+	_pFile->syncSize = _syncSize;
+	_pFile->syncInterval = _syncInterval;
 	write<Begin>(_append);
 	return true;
 }
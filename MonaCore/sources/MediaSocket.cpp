@@ -188,6 +188,10 @@ void MediaSocket::Reader::stopping() {
 MediaSocket::Writer::Send::Send(Type type, const shared<string>& pName, const shared<Socket>& pSocket, const shared<MediaWriter>& pWriter) : Runner("MediaSocketSend"),
 	_pSocket(pSocket), pWriter(pWriter), _pName(pName),
 	onWrite([this, type](const Packet& packet) {
+		if (this->pWriter->scatter) {
+			_packets.emplace_back(std::move(packet)); // shares the media buffers, no copy
+			return;
+		}
 		UInt32 size = 0;
 		Packet chunk(packet);
 		while (chunk += size) {
@@ -201,17 +205,32 @@ MediaSocket::Writer::Send::Send(Type type, const shared<string>& pName, const sh
 	}) {
 }
 
+void MediaSocket::Writer::Send::flush() {
+	if (_packets.empty())
+		return;
+	for (const Packet& packet : _packets)
+		DUMP_RESPONSE(_pName->c_str(), packet.data(), packet.size(), _pSocket->peerAddress());
+	Exception ex;
+	if (_pSocket->write(ex, _packets) < 0) // write has failed, no more reliable!
+		_pSocket->shutdown();
+	_packets.clear();
+}
+
 MediaSocket::Writer::Writer(Type type, string&& request, unique<MediaWriter>&& pWriter, const SocketAddress& address, IOSocket& io, const shared<TLS>& pTLS) :
 	_pTLS(pTLS), request(move(request)), io(io), _sendTrack(0), _pWriter(move(pWriter)), _httpAnswer(false), _subscribed(false), address(address.host() ? address.host() : IPAddress::Loopback(), address.port()),
 	MediaStream(type, "Stream target ", TypeToString(type), "://", address, request.empty() ? "" : "/", request, '|', String::Upper(pWriter->format())) {
 	_onSocketDisconnection = [this]() { stop<Ex::Net::Socket>(LOG_DEBUG, this->address, " disconnection"); };
 	_onSocketError = [this](const Exception& ex) { stop(state() == STATE_STARTING ? LOG_DEBUG : LOG_WARN, ex); };
+	if (_pWriter) // stream socket, frame parts can be sent in one gathered write rather than copied in one packet
+		_pWriter->scatter = type == TYPE_TCP || type == TYPE_HTTP;
 }
 MediaSocket::Writer::Writer(Type type, string&& request, unique<MediaWriter>&& pWriter, const shared<Socket>& pSocket, IOSocket& io) : _pSocket(pSocket),
 	io(io), request(move(request)), _sendTrack(0), _pWriter(move(pWriter)), _httpAnswer(true), _subscribed(false), address(pSocket->peerAddress()),
 	MediaStream(type, "Stream target ", TypeToString(type), "://", pSocket->peerAddress(), request.empty() ? "" : "/", request, '|', String::Upper(pWriter->format())) {
 	_onSocketDisconnection = [this]() { stop<Ex::Net::Socket>(LOG_DEBUG, this->address, " disconnection"); };
 	_onSocketError = [this](const Exception& ex) { stop(state() == STATE_STARTING ? LOG_DEBUG : LOG_WARN, ex); };
+	if (_pWriter) // stream socket, frame parts can be sent in one gathered write rather than copied in one packet
+		_pWriter->scatter = type == TYPE_TCP || type == TYPE_HTTP;
 }
 
 bool MediaSocket::Writer::initSocket(const Parameters& parameters) {
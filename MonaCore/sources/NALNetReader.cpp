@@ -31,6 +31,18 @@ NALNetReader<AVC>::NALNetReader(UInt8 track) : MediaTrackReader(track), _tag(Med
 template <>
 NALNetReader<HEVC>::NALNetReader(UInt8 track) : MediaTrackReader(track), _tag(Media::Video::CODEC_HEVC), _state(0), _type(0xFF), _position(0) {}
 
+static UInt8 CountZeros(const UInt8* begin, const UInt8* end, UInt8 state) {
+	// count zeros before end (3 max), state is the count of zeros preceding begin
+	UInt8 zeros(0);
+	for (; zeros < 3; ++zeros) {
+		if (end == begin)
+			return min<UInt8>(zeros + state, 3);
+		if (*--end)
+			break;
+	}
+	return zeros;
+}
+
 template <class VideoType>
 UInt32 NALNetReader<VideoType>::parse(Packet& buffer, Media::Source& source) {
 
@@ -38,42 +50,19 @@ UInt32 NALNetReader<VideoType>::parse(Packet& buffer, Media::Source& source) {
 	const UInt8* end(buffer.data() + buffer.size());
 	const UInt8* nal(cur);	// assume that the copy will be from start-of-data
 
-
-	while(cur<end) {
-		
-		UInt8 value(*cur++);
-
-		// About 00 00 01 and 00 00 00 01 difference => http://stackoverflow.com/questions/23516805/h264-nal-unit-prefixes
-	
-		switch(_state) {
-			case 0:
-				if(value == 0x00)
-					_state = 1;
-				break;
-			case 1:
-				_state = value == 0x00 ? 2 : 0;
-				break;
-			case 2:
-				if (value == 0x00) {  // 3 zeros
-					_state = 3;
-					break;
-				}
-			case 3:
-				if(value == 0x00)  // more than 2 or 3 zeros... no problem  
-					break; // state stays at 3 (or 2)
-				if (value == 0x01) {
-					writeNal(nal, cur - nal, source, true);
-					nal = cur;
-					_type = 0xFF; // new NAL!	
-				}
-			default:
-				_state = 0;
-				break;
-		} // switch _scState
+	// About 00 00 01 and 00 00 00 01 difference => http://stackoverflow.com/questions/23516805/h264-nal-unit-prefixes
+	// _state is the count of zeros preceding (more than 3 zeros... no problem, stays at 3)
+	while ((cur = MPEG4::FindStartCode(cur, end, _state)) < end) {
+		_state = CountZeros(nal, cur++, _state);
+		writeNal(nal, cur - nal, source, true);
+		nal = cur;
+		_type = 0xFF; // new NAL!
+		_state = 0;
 	}
+	_state = CountZeros(nal, end, _state);
 
-	if (cur != nal)
-		writeNal(nal, cur - nal, source);
+	if (end != nal)
+		writeNal(nal, end - nal, source);
 
 	return 0;
 }
@@ -16,6 +16,7 @@ details (or else see http://mozilla.org/MPL/2.0/).
 
 #include "Mona/Playlist.h"
 #include "Mona/M3U8.h"
+#include "Mona/MPD.h"
 
 using namespace std;
 
@@ -35,6 +36,10 @@ bool Playlist::Write(Exception& ex, const string& type, const Playlist& playlist
 		M3U8::Write(playlist, buffer);
 		return true;
 	}
+	if (String::ICompare(type, EXPAND("mpd")) == 0) {
+		MPD::Write(playlist, buffer);
+		return true;
+	}
 	ex.set<Ex::Unsupported>("Playlist ", type, " unsupported");
 	return false;
 }
@@ -71,6 +76,12 @@ Playlist& Playlist::removeItem() {
 Playlist& Playlist::reset() {
 	sequence = 0;
 	maxDuration = 0;
+	partDuration = 0;
+	parts.clear();
+	time = 0;
+	startTime = 0;
+	bandwidth = 0;
+	codecs.clear();
 	_duration = 0;
 	_durations.clear();
 	return self;
@@ -26,7 +26,7 @@ using namespace std;
 namespace Mona {
 
 Publication::Publication(const string& name): _latency(0), segments(_segments), _segments(0), _segmenting(false),
-	audios(_audios), videos(_videos), datas(_datas), _lostRate(_byteRate), _maxByteRate(0), _propVersion(0),
+	audios(_audios), videos(_videos), datas(_datas), _lostRate(_byteRate), _maxByteRate(0), _propVersion(0), _texts(0),
 	_publishing(0),_new(false), _newLost(false), _name(name) {
 	DEBUG("New publication ",name);
 	_segments.onSegment = [this](UInt16 duration) {
@@ -99,10 +99,11 @@ void Publication::reportLost(Media::Type type, UInt32 lost, UInt8 track) {
 void Publication::stopRecording() {
 	if (!_pRecording)
 		return;
-	NOTE("Stop ", _name, "=>", _pRecording->target<MediaFile::Writer>().path.name(), " recording");
+	MediaFile::Writer& writer = _pRecording->target<MediaFile::Writer>();
+	NOTE("Stop ", _name, "=>", writer.path.name(), " recording (max write latency ", writer.maxLatency(), "us)");
 	((set<Subscription*>&)subscriptions).erase(_pRecording.get());
+	textsChange();
 	_pRecording->pPublication = NULL;
-	MediaFile::Writer& writer = _pRecording->target<MediaFile::Writer>();
 	if (writer.segmented())
 		_segmenting = false;
 	delete &writer;
@@ -118,7 +119,7 @@ MediaFile::Writer* Publication::recorder() {
 	return &_pRecording->target<MediaFile::Writer>();
 }
 
-void Publication::start(unique<MediaFile::Writer>&& pRecorder) {
+void Publication::start(unique<MediaFile::Writer>&& pRecorder, const Path& dvr, IOFile* pIOFile) {
 	// if already started => RESET LOG
 	// if reseted => JUST RECORDING/sEGMENTS LOGS
 	// if stopped => START LOG
@@ -143,14 +144,23 @@ void Publication::start(unique<MediaFile::Writer>&& pRecorder) {
 		_pRecording.set(*pRecorder.release());
 		_pRecording->pPublication = this;
 		((set<Subscription*>&)subscriptions).emplace(_pRecording.get());
+		textsChange();
 	}
 	// start or stop live segmenting
 	const char* strSegments = _segmenting ? NULL : getString("segments");
-	if (_segments.setMaxSegments(strSegments ? String::ToNumber<UInt8, Segments::DEFAULT_SEGMENTS>(strSegments) : 0)) {
+	UInt32 retention = _segmenting ? 0 : getNumber<UInt32>("dvr"); // DVR retention in seconds, requires live segmenting
+	if (_segments.setMaxSegments(strSegments ? String::ToNumber<UInt8, Segments::DEFAULT_SEGMENTS>(strSegments) : (retention ? UInt8(Segments::DEFAULT_SEGMENTS) : 0))) {
 		_segmenting = true;
 		segments = _segments.maxSegments();
 		_segments.setMaxDuration(getNumber<UInt16>("duration"));
-	}
+		_segments.setAligned(getBoolean<false>("aligned")); // MBR renditions
+		_segments.setPartDuration(getNumber<UInt16>("partDuration")); // LL-HLS
+	} else
+		retention = 0;
+	if (pIOFile && _segments.setDVR(*pIOFile, dvr, retention))
+		INFO("Publication ", _name, " DVR of ", retention, " seconds in ", dvr)
+	else
+		_segments.resetDVR();
 
 	// display segmenting log =>
 	if (!_segmenting)
@@ -168,6 +178,12 @@ void Publication::reset() {
 		INFO("Publication ", _name, " reseted");
 	_publishing = -1;
 	_audios.clear();
+	UInt8 track(0);
+	for (const VideoTrack& video : _videos) {
+		++track;
+		if (video.cc.scanned() || video.cc.skipped() || video.cc.filtered())
+			DEBUG("Publication ", _name, " video track ", track, " captions, ", video.cc.scanned(), " frames scanned, ", video.cc.skipped(), " frames skipped, ", video.cc.filtered(), " frames without SEI");
+	}
 	_videos.clear();
 	_datas.clear();
 	_latency = 0;
@@ -281,6 +297,24 @@ void Publication::writeAudio(const Media::Audio::Tag& tag, const Packet& packet,
 		pAudio->config.set(tag, packet);
 }
 
+static bool TextSelected(const Subscription& subscription) {
+	return subscription.datas.pSelection ? *subscription.datas.pSelection>0 : subscription.datas.multiTracks;
+}
+
+bool Publication::captioning() const {
+	// text tracks consumed by HLS segments (VTT) or at less one subscription
+	if (_segments)
+		return true;
+	if (_texts < 0) {
+		_texts = 0;
+		for (Subscription* pSubscription : subscriptions) {
+			if (TextSelected(*pSubscription))
+				++_texts;
+		}
+	}
+	return _texts>0;
+}
+
 void Publication::writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track) {
 	if (!_publishing) {
 		ERROR("Video packet on stopped ", _name, " publication");
@@ -306,19 +340,23 @@ void Publication::writeVideo(const Media::Video::Tag& tag, const Packet& packet,
 			}
 			if(tag.frame == Media::Video::FRAME_KEY)
 				DEBUG(name(), " KEYFRAME ", tag.time);
-			CCaption::OnText onText([this, track](UInt8 channel, shared<Buffer>& pBuffer) {
-			//	DEBUG("cc", channel, " => ", *pBuffer);
-				writeData(Media::Data::TYPE_TEXT, Packet(pBuffer), (track - 1) * 4 + channel);
-			});
-			CCaption::OnLang onLang([this, track](UInt8 channel, const char* lang) {
-				// 1 <= channel <= 4
-				if (lang) {
-					DEBUG("Subtitle lang ", lang);
-					setString(String((track - 1) * 4 + channel, ".textLang"), lang);
-				} else
-					erase(String((track - 1) * 4 + channel, ".textLang"));
-			});
-			offsetCC = pVideo->cc.extract(tag, packet, onText, onLang);
+			if (!captioning())
+				pVideo->cc.skip(); // nobody to consume text tracks, useless to extract captions
+			else {
+				CCaption::OnText onText([this, track](UInt8 channel, shared<Buffer>& pBuffer) {
+				//	DEBUG("cc", channel, " => ", *pBuffer);
+					writeData(Media::Data::TYPE_TEXT, Packet(pBuffer), (track - 1) * 4 + channel);
+				});
+				CCaption::OnLang onLang([this, track](UInt8 channel, const char* lang) {
+					// 1 <= channel <= 4
+					if (lang) {
+						DEBUG("Subtitle lang ", lang);
+						setString(String((track - 1) * 4 + channel, ".textLang"), lang);
+					} else
+						erase(String((track - 1) * 4 + channel, ".textLang"));
+				});
+				offsetCC = pVideo->cc.extract(tag, packet, onText, onLang);
+			}
 		}
 	} else if(packet) // if empty it's config packet to maintain subtitle alive!
 		DEBUG("Video configuration received on publication ", _name, " (size=", packet.size(), ")");
@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/RTMFP/RTMFPWriter.h"
 #include "Mona/Crypto.h"
 #include "Mona/Logs.h"
+#include "Mona/Util.h"
 
 
 using namespace std;
@@ -106,6 +107,80 @@ Buffer& RTMFP::InitBuffer(shared<Buffer>& pBuffer, std::atomic<Int64>& initiator
 	return BinaryWriter(*pBuffer).write8(marker + 4).write16(RTMFP::TimeNow()).write16(RTMFP::Time(time)).buffer();
 }
 
+static const UInt8* ComputeCookie(UInt32 id, const SocketAddress& address, UInt8* value) {
+	static struct Key { UInt8 data[Crypto::SHA256_SIZE]; Key() { Util::Random(data, sizeof(data)); } } Key; // secret of the process
+	UInt8 data[4 + 16 + 2];
+	BinaryWriter writer(data, sizeof(data));
+	writer.write32(id).write(address.host().data(), address.host().size()).write16(address.port());
+	return Crypto::HMAC::SHA256(Key.data, sizeof(Key.data), writer.data(), writer.size(), value);
+}
+
+BinaryWriter& RTMFP::WriteCookie(BinaryWriter& writer, UInt32 id, const SocketAddress& address) {
+	UInt8 value[Crypto::SHA256_SIZE];
+	writer.write32(id).write(ComputeCookie(id, address, value), sizeof(value));
+	return writer.writeRandom(SIZE_COOKIE - 4 - sizeof(value));
+}
+
+bool RTMFP::CheckCookie(const UInt8* cookie, const SocketAddress& address) {
+	UInt8 value[Crypto::SHA256_SIZE];
+	return memcmp(ComputeCookie(BinaryReader(cookie, 4).read32(), address, value), cookie + 4, sizeof(value)) == 0;
+}
+
+unique<DiffieHellman> RTMFP::KeyPool::pop(Exception& ex) {
+	unique<DiffieHellman> pDH;
+	{
+		lock_guard<mutex> lock(_pKeys->mutex);
+		if (!_pKeys->empty()) {
+			pDH = move(_pKeys->front());
+			_pKeys->pop_front();
+		}
+	}
+	fill();
+	if (pDH)
+		return pDH;
+	// pool empty (connection storm), compute in place
+	pDH.set();
+	if (!pDH->computeKeys(ex))
+		pDH.reset();
+	return pDH;
+}
+
+void RTMFP::KeyPool::fill() {
+	struct Filler : Runner, virtual Object {
+		Filler(const shared<Keys>& pKeys, UInt32 capacity) : Runner("RTMFPKeyPool"), _pKeys(pKeys), _capacity(capacity) {}
+	private:
+		bool run(Exception& ex) {
+			for (;;) {
+				{
+					lock_guard<mutex> lock(_pKeys->mutex);
+					if (_pKeys->size() >= _capacity || _pKeys.unique()) { // full or pool deleted
+						_pKeys->filling = false;
+						return true;
+					}
+				}
+				unique<DiffieHellman> pDH(SET);
+				if (!pDH->computeKeys(ex)) {
+					lock_guard<mutex> lock(_pKeys->mutex);
+					_pKeys->filling = false;
+					return false;
+				}
+				lock_guard<mutex> lock(_pKeys->mutex);
+				_pKeys->emplace_back(move(pDH));
+			}
+		}
+		shared<Keys>	_pKeys;
+		UInt32			_capacity;
+	};
+	{
+		// refill when under the half of the capacity
+		lock_guard<mutex> lock(_pKeys->mutex);
+		if (!_capacity || _pKeys->filling || _pKeys->size() > (_capacity / 2))
+			return;
+		_pKeys->filling = true;
+	}
+	_threadPool.queue<Filler>(0, _pKeys, _capacity);
+}
+
 bool RTMFP::Send(Socket& socket, const Packet& packet, const SocketAddress& address) {
 	Exception ex;
 	int sent = socket.write(ex, packet, address);
@@ -118,11 +193,19 @@ bool RTMFP::Send(Socket& socket, const Packet& packet, const SocketAddress& addr
 	return true;
 }
 
+EVP_CIPHER_CTX* RTMFP::Engine::NewContext(const UInt8* key, int enc) {
+	static UInt8 IV[KEY_SIZE];
+	EVP_CIPHER_CTX* pContext(EVP_CIPHER_CTX_new());
+	EVP_CipherInit_ex(pContext, EVP_aes_128_cbc(), NULL, key, IV, enc);
+	EVP_CIPHER_CTX_set_padding(pContext, 0); // RTMFP packets are already padded, and like that no last block is kept back on decryption
+	return pContext;
+}
+
 bool RTMFP::Engine::decode(Exception& ex, Buffer& buffer, const SocketAddress& address) {
 	static UInt8 IV[KEY_SIZE];
-	EVP_CipherInit_ex(_context, EVP_aes_128_cbc(), NULL, _key, IV, 0);
+	EVP_CipherInit_ex(_decoder, NULL, NULL, NULL, IV, -1);
 	int temp;
-	EVP_CipherUpdate(_context, buffer.data(), &temp, buffer.data(), buffer.size());
+	EVP_CipherUpdate(_decoder, buffer.data(), &temp, buffer.data(), buffer.size());
 	// Check CRC
 	BinaryReader reader(buffer.data(), buffer.size());
 	UInt16 crc(reader.read16());
@@ -169,8 +252,8 @@ void RTMFP::Engine::encode(const shared<Buffer>& pBuffer, UInt32 farId) {
 	BinaryWriter(data + 4, 2).write16(Crypto::ComputeChecksum(reader));
 	// Encrypt the resulted request
 	static UInt8 IV[KEY_SIZE];
-	EVP_CipherInit_ex(_context, EVP_aes_128_cbc(), NULL, _key, IV, 1);
-	EVP_CipherUpdate(_context, data+4, &temp, data + 4, size-4);
+	EVP_CipherInit_ex(_encoder, NULL, NULL, NULL, IV, -1);
+	EVP_CipherUpdate(_encoder, data+4, &temp, data + 4, size-4);
 
 	reader.reset(4);
 	BinaryWriter(data, 4).write32(reader.read32() ^ reader.read32() ^ farId);
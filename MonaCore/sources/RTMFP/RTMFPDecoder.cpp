@@ -25,11 +25,37 @@ using namespace std;
 namespace Mona {
 
 
+// Shared between handshakes: Diffie-Hellman keypair pool and rate limiter of Diffie-Hellman computations
+struct RTMFPDecoder::Handshaking : virtual Object {
+	Handshaking(const ThreadPool& threadPool, UInt32 keys, UInt32 rate) : keyPool(threadPool, keys), _rate(rate), _tokens(rate), _time(Time::Now()) {}
+
+	RTMFP::KeyPool	keyPool;
+
+	// token bucket, returns false if the rate is exceeded
+	bool allow() {
+		if (!_rate)
+			return true;
+		lock_guard<mutex> lock(_mutex);
+		Int64 now(Time::Now());
+		_tokens = min(double(_rate), _tokens + (now - _time) * _rate / 1000.0);
+		_time = now;
+		if (_tokens < 1)
+			return false;
+		--_tokens;
+		return true;
+	}
+private:
+	const UInt32	_rate;
+	double			_tokens;
+	Int64			_time;
+	mutex			_mutex;
+};
+
 struct RTMFPDecoder::Handshake : virtual Object {
 	OnHandshake		onHandshake;
 	OnEdgeMember	onEdgeMember;
 
-	Handshake(const Handler& handler, const shared<RendezVous>& pRendezVous) : _recvTime(Time::Now()), track(0), _pResponse(SET), _pRendezVous(pRendezVous), _handler(handler) {}
+	Handshake(const Handler& handler, const shared<RendezVous>& pRendezVous, const shared<Handshaking>& pHandshaking) : _recvTime(Time::Now()), track(0), _pResponse(SET), _pRendezVous(pRendezVous), _pHandshaking(pHandshaking), _handler(handler) {}
 
 	Packet					tag;
 	UInt16					track;
@@ -196,6 +222,14 @@ struct RTMFPDecoder::Handshake : virtual Object {
 					return;
 				}
 
+				if (reader.available() < RTMFP::SIZE_COOKIE) {
+					DEBUG("38 handshake ignored, truncated cookie");
+					return;
+				}
+				if (!RTMFP::CheckCookie(reader.current(), address)) {
+					DEBUG("38 handshake ignored, cookie not delivered to ", address);
+					return; // spoofed address or flood, no crypto for it!
+				}
 				UInt32 id = Byte::From32Network(*(UInt32*)reader.current());
 				reader.next(RTMFP::SIZE_COOKIE);
 
@@ -206,7 +240,15 @@ struct RTMFPDecoder::Handshake : virtual Object {
 				reader.next(2); // unknown
 				const UInt8* key = reader.current(); reader.next(size);
 
-				DiffieHellman dh;
+				if (!_pHandshaking->allow()) {
+					DEBUG("38 handshake ignored, handshakeRate exceeded");
+					return; // client will repeat it
+				}
+				unique<DiffieHellman> pDH;
+				AUTO_ERROR(pDH = _pHandshaking->keyPool.pop(ex = nullptr), "DiffieHellman");
+				if (!pDH)
+					return;
+				DiffieHellman& dh(*pDH);
 				UInt8 secret[DiffieHellman::SIZE];
 				UInt8 secretSize;
 				AUTO_ERROR(secretSize = dh.computeSecret(ex = nullptr, key, size, secret), "DiffieHellman");
@@ -253,11 +295,14 @@ struct RTMFPDecoder::Handshake : virtual Object {
 	const Handler&			_handler;
 	Time					_recvTime;
 	shared<RendezVous>		_pRendezVous;
+	shared<Handshaking>		_pHandshaking;
 	shared<Packet>			_pResponse;
 };
 
-RTMFPDecoder::RTMFPDecoder(const shared<RendezVous>& pRendezVous, const Handler& handler, const ThreadPool& threadPool) :
-	_pRendezVous(pRendezVous), _handler(handler), _threadPool(threadPool), _pReceiving(SET) {
+RTMFPDecoder::RTMFPDecoder(const shared<RendezVous>& pRendezVous, const Handler& handler, const ThreadPool& threadPool, const ThreadPool& handshakeThreads, const Parameters& parameters) :
+	_pRendezVous(pRendezVous), _handler(handler), _threadPool(threadPool), _handshakeThreads(handshakeThreads), _pReceiving(SET), _pHandshakesWaiting(SET),
+	_handshakeQueue(parameters.getNumber<UInt32, 1000>("handshakeQueue")),
+	_pHandshaking(SET, handshakeThreads, parameters.getNumber<UInt32, 64>("handshakeKeys"), parameters.getNumber<UInt32>("handshakeRate")) {
 }
 
 bool RTMFPDecoder::finalizeHandshake(UInt32 id, const SocketAddress& address, shared<RTMFPReceiver>& pReceiver) {
@@ -326,17 +371,21 @@ void RTMFPDecoder::decode(shared<Buffer>& pData, const SocketAddress& address, c
 	//DEBUG("RTMFP Session ",id," size ",pBuffer->size());
 	if (!id) {
 		// HANDSHAKE
+		if (*_pHandshakesWaiting >= _handshakeQueue) {
+			DEBUG("Handshake ignored because ", _handshakeQueue, " handshakes are already waiting (handshakeQueue)");
+			return; // shed load, client will repeat it
+		}
 		Exception ex;
 		auto it = _handshakes.lower_bound(address);
 		if (it != _handshakes.end() && it->second.unique() && it->second->obsolete())
 			it = _handshakes.erase(it);
 		if (it == _handshakes.end() || it->first != address) {
 			// Create handshake
-			it = _handshakes.emplace_hint(it, SET, forward_as_tuple(address), forward_as_tuple(SET, _handler, _pRendezVous));
+			it = _handshakes.emplace_hint(it, SET, forward_as_tuple(address), forward_as_tuple(SET, _handler, _pRendezVous, _pHandshaking));
 			it->second->onHandshake = onHandshake;
 			it->second->onEdgeMember = onEdgeMember;
 		}
-		receive(it->second, pBuffer, address, pSocket);
+		receive(_handshakeThreads, it->second, pBuffer, address, pSocket, _pHandshakesWaiting, 1);
 	} else {
 		auto it = _receivers.lower_bound(id);
 		if (it == _receivers.end() || it->first != id) {
@@ -357,7 +406,7 @@ void RTMFPDecoder::decode(shared<Buffer>& pData, const SocketAddress& address, c
 				return;
 			}
 		}
-		receive(it->second, pBuffer, address, pSocket);
+		receive(_threadPool, it->second, pBuffer, address, pSocket, _pReceiving, pBuffer->size());
 	}
 }
 
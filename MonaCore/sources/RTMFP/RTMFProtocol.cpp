@@ -35,6 +35,10 @@ RTMFProtocol::RTMFProtocol(const char* name, ServerAPI& api, Sessions& sessions)
 	setNumber("port", 1935);
 	setNumber("keepalivePeer",   10);
 	setNumber("keepaliveServer", 15);
+	setNumber("handshakeThreads", 2);
+	setNumber("handshakeQueue", 1000);
+	setNumber("handshakeRate", 0);
+	setNumber("handshakeKeys", 64);
 
 	_onHandshake = [this](RTMFP::Handshake& handshake) {
 		BinaryReader reader(handshake.data(), handshake.size());
@@ -63,8 +67,7 @@ RTMFProtocol::RTMFProtocol(const char* name, ServerAPI& api, Sessions& sessions)
 		}else {
 			// Create session and write id in cookie response!
 			writer.write8(RTMFP::SIZE_COOKIE);
-			writer.write32(this->sessions.create<RTMFPSession>(self, this->api, pPeer).id());
-			writer.writeRandom(RTMFP::SIZE_COOKIE - 4);
+			RTMFP::WriteCookie(writer, this->sessions.create<RTMFPSession>(self, this->api, pPeer).id(), handshake.address);
 			// instance id (certificat in the middle)
 			writer.write(_certificat, sizeof(_certificat));
 			send(0x70, pBuffer, handshake.address, handshake.pResponse);
@@ -113,6 +116,10 @@ void RTMFProtocol::manage() {
 
 SocketAddress RTMFProtocol::load(Exception& ex) {
 
+	// before UDProtocol::load which creates the decoder
+	if (!_pHandshakeThreads)
+		_pHandshakeThreads.set(Thread::PRIORITY_NORMAL, max<UInt16>(getNumber<UInt16, 2>("handshakeThreads"), 1));
+
 	SocketAddress address = UDProtocol::load(ex);
 	if (!address)
 		return address;
@@ -142,7 +149,7 @@ SocketAddress RTMFProtocol::load(Exception& ex) {
 
 
 Socket::Decoder* RTMFProtocol::newDecoder() {
-	RTMFPDecoder* pDecoder = new RTMFPDecoder(_pRendezVous, api.handler, api.threadPool);
+	RTMFPDecoder* pDecoder = new RTMFPDecoder(_pRendezVous, api.handler, api.threadPool, *_pHandshakeThreads, self);
 	pDecoder->onSession = _onSession;
 	pDecoder->onEdgeMember = _onEdgeMember;
 	pDecoder->onHandshake = _onHandshake;
@@ -189,8 +189,11 @@ UInt32 RTMPDecoder::onStreamData(Packet& buffer, Socket& socket) {
 		if (reader.size() < headerSize) // want read in first the header!
 			return buffer.size();
 
-		if (channelId < 2)
-			channelId = (channelId == 0 ? reader.read8() : reader.read16()) + 64;
+		if (channelId == 1) {
+			channelId = reader.read8() + 64;
+			channelId += reader.read8() << 8; // little endian
+		} else if (!channelId)
+			channelId = reader.read8() + 64;
 
 		Channel& channel(_channels.emplace(SET, forward_as_tuple(channelId), forward_as_tuple(channelId)).first->second);
 
@@ -287,7 +290,32 @@ UInt32 RTMPDecoder::onStreamData(Packet& buffer, Socket& socket) {
 						ackBytes = _unackBytes;
 						_unackBytes = 0;
 					}
-					_handler.queue(onRequest, channel.type, channel.absoluteTime, channel.id, channel.streamId, ackBytes, packet, !buffer);
+					if (channel.type != AMF::TYPE_AGGREGATE) {
+						_handler.queue(onRequest, channel.type, channel.absoluteTime, channel.id, channel.streamId, ackBytes, packet, !buffer);
+						break;
+					}
+					// Aggregate message, every sub-message is a FLV tag [type(1) size(3) time(3) timeExtended(1) streamId(3)] [body] [back pointer(4)]
+					// => split it without copying, sub-message references the aggregate packet
+					BinaryReader reader(packet.data(), packet.size());
+					UInt32 firstTime(0);
+					while (reader.available() >= 11) {
+						AMF::Type type(AMF::Type(reader.read8()));
+						UInt32 size(reader.read24());
+						UInt32 time(reader.read24());
+						time |= reader.read8() << 24;
+						if (reader.position() == 8)
+							firstTime = time;
+						reader.next(3); // stream id, keep the one of the aggregate message
+						if (size > reader.available()) {
+							ERROR("Invalid RTMP aggregate message, sub-message of ", size, " bytes exceeds message size");
+							break;
+						}
+						const UInt8* data(reader.current());
+						reader.next(size + 4); // + back pointer
+						// time of sub-message is relative to the time of the aggregate message
+						_handler.queue(onRequest, type, channel.absoluteTime + (time - firstTime), channel.id, channel.streamId, ackBytes, Packet(packet, data, size), !buffer && reader.available() < 11);
+						ackBytes = 0;
+					}
 					break;
 				}
 			}
@@ -27,19 +27,65 @@ RTMPSender::RTMPSender(AMF::Type type, UInt32 time, UInt32	streamId,
 					   const shared<RTMP::Channel>& pChannel,
 					   const shared<Socket>& pSocket,
 					   const shared<RC4_KEY>& pEncryptKey,
+					   const shared<UInt32>& pChunkSize,
 					   Media::Data::Type packetType,
 					   const Packet& packet) : Runner("RTMPSender"),  _type(type), _time(time), _streamId(streamId), _packetType(packetType), _packet(move(packet)),
-							_pChannel(pChannel), _pSocket(pSocket), _pEncryptKey(pEncryptKey),
+							_pChannel(pChannel), _pSocket(pSocket), _pEncryptKey(pEncryptKey), _pChunkSize(pChunkSize), _aggregateSize(0),
 							writer(_pBuffer.set(18)) {  // 18 => maximum header size!
 }
 
+UInt32 RTMPSender::aggregate(const shared<RTMPSender>& pSender) {
+	_aggregation.emplace_back(pSender);
+	// 11 bytes of sub-header + 5 bytes max of FLV audio/video prefix + 4 bytes of back pointer
+	return _aggregateSize += 20 + pSender->_packet.size();
+}
+
 bool RTMPSender::run(Exception&) {
-	_packetType = writer.convert(_packetType, _packet);
+	deque<Packet> packets;
+	build(packets);
+	Exception ex;
+	int result(Send(ex, *_pSocket, _pEncryptKey.get(), packets));
+	if (ex || result<0)
+		DEBUG(ex);
+	return true;
+}
+
+void RTMPSender::build(deque<Packet>& packets) {
+	deque<Packet> body;
+	UInt32 bodySize(0);
+	if (_aggregation.empty()) {
+		_packetType = writer.convert(_packetType, _packet);
+		bodySize = writer->size() + _packet.size();
+	} else {
+		// Build the aggregate body, every sub-message is a FLV tag: [type(1) size(3) time(3) timeExtended(1) streamId(3)] [body] [back pointer(4)]
+		// => previous back pointer and sub-header are written in the free header space of the frame sender to not copy frames
+		UInt32 backPointer(0);
+		for (shared<RTMPSender>& pSender : _aggregation) {
+			RTMPSender& sender(*pSender);
+			sender._packetType = sender.writer.convert(sender._packetType, sender._packet);
+			UInt32 size(sender.writer->size() + sender._packet.size());
+			UInt8 headerSize(backPointer ? 15 : 11);
+			sender._pBuffer->clip(18 - headerSize);
+			BinaryWriter writer(sender._pBuffer->data(), headerSize);
+			if (backPointer)
+				writer.write32(backPointer);
+			writer.write8(sender._type).write24(size);
+			writer.write24(sender._time & 0xFFFFFF).write8(sender._time >> 24);
+			writer.write24(_streamId);
+			bodySize += headerSize + size;
+			body.emplace_back(sender._pBuffer);
+			if (sender._packet)
+				body.emplace_back(move(sender._packet));
+			backPointer = 11 + size;
+		}
+		writer->write32(backPointer);
+		bodySize += 4;
+		_aggregation.clear();
+	}
 	
 	UInt32 absoluteTime(_time);
 	UInt8 headerFlag(0);
 	RTMP::Channel& channel(*_pChannel);
-	UInt32 bodySize(writer->size() + _packet.size());
 
 	if (channel.id == 2)
 		_streamId = 0; // channel 2 sends always message to streamId 0 (see specification)
@@ -79,7 +125,7 @@ bool RTMPSender::run(Exception&) {
 	if (channel.id>319) {
 		writer.write8((headerFlag << 6) | 1);
 		writer.write8((channel.id - 64) & 0x00FF);
-		writer.write8((channel.id - 64) & 0xFF00);
+		writer.write8((channel.id - 64) >> 8);
 	} else if (channel.id > 63) {
 		writer.write8((headerFlag << 6) | 0);
 		writer.write8(channel.id - 64);
@@ -102,36 +148,89 @@ bool RTMPSender::run(Exception&) {
 	if (_time >= 0xFFFFFF)
 		writer.write32(absoluteTime); // must be absolute here
 
-	if (_pEncryptKey) {
-		DUMP_RESPONSE("RTMPE", _pBuffer->data(), _pBuffer->size(), _pSocket->peerAddress());
-		RC4(_pEncryptKey.get(), _pBuffer->size(), _pBuffer->data(), _pBuffer->data());
+	if (_type == AMF::TYPE_CHUNKSIZE) { // new chunk size for next messages
+		UInt32 chunkSize(BinaryReader(_pBuffer->data() + headerSize, _pBuffer->size() - headerSize).read32());
+		if (chunkSize)
+			*_pChunkSize = chunkSize;
+	}
+
+	// Body = [writer content][packet], or for an aggregate [frames...][last back pointer]
+	Packet buffer(_pBuffer);
+	body.emplace_back(buffer + headerSize);
+	if (_packet)
+		body.emplace_back(move(_packet));
+
+	// Chunk the body without copying: continuation headers (Chunk Message Type 3) are interleaved with slices of the body
+	packets.emplace_back(move(buffer), buffer.data(), headerSize);
+	UInt8 continuation[7];
+	BinaryWriter continuationWriter(continuation, sizeof(continuation));
+	if (channel.id>319) {
+		continuationWriter.write8(0xC1);
+		continuationWriter.write8((channel.id - 64) & 0x00FF);
+		continuationWriter.write8((channel.id - 64) >> 8);
+	} else if (channel.id > 63) {
+		continuationWriter.write8(0xC0);
+		continuationWriter.write8(channel.id - 64);
 	} else
-		DUMP_RESPONSE(_pSocket->isSecure() ? "RTMPS" : "RTMP", _pBuffer->data(), _pBuffer->size(), _pSocket->peerAddress());
+		continuationWriter.write8(0xC0 | channel.id);
+	if (_time >= 0xFFFFFF)
+		continuationWriter.write32(absoluteTime); // extended time is repeated on every chunk
+	Packet header;
+	UInt32 available(*_pChunkSize);
+	for (Packet& packet : body) {
+		while (packet) {
+			if (!available) {
+				if (!header) {
+					shared<Buffer> pHeader(SET, continuation, continuationWriter.size());
+					header.set(pHeader);
+				}
+				packets.emplace_back(move(header));
+				available = *_pChunkSize;
+			}
+			UInt32 size(min(available, packet.size()));
+			packets.emplace_back(move(packet), packet.data(), size);
+			packet += size;
+			available -= size;
+		}
+	}
 
-	Exception ex;
-	int result = _pSocket->write(ex, Packet(_pBuffer));
-	if (ex || result<0)
-		DEBUG(ex);
-	if (result < 0)
-		return true;
+}
 
-	if (_packet.size()) {
-		if (_pEncryptKey) {
-			DUMP_RESPONSE("RTMPE", _packet.data(), _packet.size(), _pSocket->peerAddress());
-			_pBuffer.set(_packet.size());
-			RC4(_pEncryptKey.get(), _packet.size(), _packet.data(), _pBuffer->data());
-			_packet.set(_pBuffer);
-		} else
-			DUMP_RESPONSE(_pSocket->isSecure() ? "RTMPS" : "RTMP", _packet.data(), _packet.size(), _pSocket->peerAddress());
-		if(_pSocket->write(ex, _packet)<0 && !ex)
-			DEBUG(ex);
+int RTMPSender::Send(Exception& ex, Socket& socket, RC4_KEY* pEncryptKey, const deque<Packet>& packets) {
+	if (!pEncryptKey) {
+		if (Logs::GetDump()) {
+			for (const Packet& packet : packets)
+				DUMP_RESPONSE(socket.isSecure() ? "RTMPS" : "RTMP", packet.data(), packet.size(), socket.peerAddress());
+		}
+		return socket.write(ex, packets);
 	}
-	
-	if (ex)
-		DEBUG(ex);
+	// RTMPE, cipher all the segments in one RC4 pass to one Buffer: source packets stay untouched (shared between subscribers)
+	UInt32 size(0);
+	for (const Packet& packet : packets)
+		size += packet.size();
+	// allocated by flush (the socket can keep it queued), its memory is recycled by Buffer::Allocator when poolBuffers is on
+	shared<Buffer> pBuffer(SET, size);
+	UInt8* data(pBuffer->data());
+	for (const Packet& packet : packets) {
+		DUMP_RESPONSE("RTMPE", packet.data(), packet.size(), socket.peerAddress());
+		RC4(pEncryptKey, packet.size(), packet.data(), data);
+		data += packet.size();
+	}
+	return socket.write(ex, Packet(pBuffer));
+}
 
+bool RTMPSenders::run(Exception&) {
+	if (_senders.empty())
+		return true;
+	deque<Packet> packets;
+	for (shared<RTMPSender>& pSender : _senders)
+		pSender->build(packets);
+	RTMPSender& sender(*_senders.front()); // all the senders of one writer share the same socket and key
+	Exception ex;
+	int result(RTMPSender::Send(ex, *sender._pSocket, sender._pEncryptKey.get(), packets));
+	if (ex || result<0)
+		DEBUG(ex);
 	return true;
 }
 
-
 } // namespace Mona
@@ -27,9 +27,9 @@ using namespace std;
 namespace Mona {
 
 
-RTMPSession::RTMPSession(Protocol& protocol, const shared<Socket>& pSocket) : _first(true), _controller(2, *this, _pEncryptKey), _mainStream(api,peer), TCPSession(protocol, pSocket),
+RTMPSession::RTMPSession(Protocol& protocol, const shared<Socket>& pSocket) : _first(true), _controller(2, *this, _pEncryptKey, _pChunkSize, _settings), _pChunkSize(SET, RTMP::DEFAULT_CHUNKSIZE), _mainStream(api,peer), TCPSession(protocol, pSocket),
 	_onRequest([this](RTMP::Request& request) {
-		RTMPWriter& writer(request.channelId == 2 ? _controller : _writers.emplace(SET, forward_as_tuple(request.channelId), forward_as_tuple(request.channelId, *this, _pEncryptKey)).first->second);
+		RTMPWriter& writer(request.channelId == 2 ? _controller : _writers.emplace(SET, forward_as_tuple(request.channelId), forward_as_tuple(request.channelId, *this, _pEncryptKey, _pChunkSize, _settings)).first->second);
 		writer.streamId = request.streamId;
 
 		if (_first) {
@@ -77,6 +77,11 @@ RTMPSession::RTMPSession(Protocol& protocol, const shared<Socket>& pSocket) : _f
 		// publication flush
 		_mainStream.flush();
 	}) {
+	// protocol settings, can be overloaded by client parameters (see onParameters)
+	protocol.getNumber("chunkSize", _settings.chunkSize);
+	protocol.getNumber("aggregateSize", _settings.aggregateSize);
+	protocol.getNumber("aggregateTime", _settings.aggregateTime);
+
 	_mainStream.onStart = [this](UInt16 id, FlashWriter& writer) {
 		// Stream Begin signal
 		_controller.writeRaw().write16(0).write32(id);
@@ -100,6 +105,21 @@ Socket::Decoder* RTMPSession::newDecoder() {
 	return pDecoder;
 }
 
+void RTMPSession::onParameters(const Parameters& parameters) {
+	TCPSession::onParameters(parameters);
+	UInt32 chunkSize(_settings.chunkSize);
+	if (parameters.getNumber("chunkSize", chunkSize) && chunkSize != _settings.chunkSize) {
+		_settings.chunkSize = chunkSize;
+		if (!_first) { // else will be sent with protocol settings
+			_controller.writeChunkSize(chunkSize);
+			_controller.flush();
+		}
+	}
+	// audio/video aggregation (AMF::TYPE_AGGREGATE)
+	parameters.getNumber("aggregateSize", _settings.aggregateSize);
+	parameters.getNumber("aggregateTime", _settings.aggregateTime);
+}
+
 void RTMPSession::kill(Int32 error, const char* reason) {
 	if (died)
 		return;
@@ -134,6 +154,11 @@ bool RTMPSession::manage() {
 		_controller.writePing(peer.connection);
 		peer.pingTime.update();
 	}
+	if (_settings.aggregateSize) {
+		// release aggregates opened for too long (publication silent)
+		for (auto& it : _writers)
+			it.second.flush();
+	}
 	return true;
 }
 
@@ -25,13 +25,13 @@ using namespace std;
 
 namespace Mona {
 
-RTMPWriter::RTMPWriter(UInt32 channelId, TCPClient& client, const shared<RC4_KEY>& pEncryptKey) : streamId(0),
-	_pChannel(SET, channelId), _pEncryptKey(pEncryptKey), _client(client) {
+RTMPWriter::RTMPWriter(UInt32 channelId, TCPClient& client, const shared<RC4_KEY>& pEncryptKey, const shared<UInt32>& pChunkSize, const RTMP::Settings& settings) : streamId(0),
+	_pChannel(SET, channelId), _pEncryptKey(pEncryptKey), _pChunkSize(pChunkSize), _client(client), _settings(settings), _aggregateTime(0), _aggregateOpening(0) {
 }
 
 void RTMPWriter::writeProtocolSettings() {
-	// to eliminate chunks of packet in the server->client direction
-	write(AMF::TYPE_CHUNKSIZE)->write32(0x7FFFFFFF);
+	// chunk size in the server->client direction, no chunking by default (0x7FFFFFFF)
+	writeChunkSize(_settings.chunkSize);
 	// to increase the window ack size in the server->client direction
 	writeWinAckSize(2500000);
 	// to increase the window ack size in the client->server direction
@@ -40,17 +40,46 @@ void RTMPWriter::writeProtocolSettings() {
 	write(AMF::TYPE_RAW)->write16(0).write32(0);
 }
 
+void RTMPWriter::closing(Int32 error, const char* reason) {
+	FlashWriter::closing(error, reason);
+	_pAggregate.reset(); // release the opened aggregate to send it on the last flush
+}
+
 void RTMPWriter::flushing() {
-	for (auto& pSender : _senders)
-		_client.send(pSender);
+	// Keep the opened aggregate to fill it with next medias while its time bound is not reached
+	if (_pAggregate && _aggregateOpening.isElapsed(_settings.aggregateTime))
+		_pAggregate.reset();
+	if (_pAggregate)
+		_senders.pop_back();
+	if (_senders.size() > 1)
+		_client.send<RTMPSenders>(_senders); // one writing (and one RC4 pass for RTMPE) for all the messages
+	else if (!_senders.empty())
+		_client.send(_senders.front());
 	_senders.clear();
+	if (_pAggregate)
+		_senders.emplace_back(_pAggregate);
 }
 
 AMFWriter& RTMPWriter::write(AMF::Type type, UInt32 time, Media::Data::Type packetType, const Packet& packet, bool reliable) {
 	if(closed())
         return AMFWriter::Null();
-	_senders.emplace_back(SET, type, time, streamId, _pChannel, _client.socket(), _pEncryptKey, packetType, packet);
-	return _senders.back()->writer;
+	if (!_settings.aggregateSize || (type != AMF::TYPE_AUDIO && type != AMF::TYPE_VIDEO)) {
+		_pAggregate.reset(); // close the aggregate to keep the messages order
+		_senders.emplace_back(SET, type, time, streamId, _pChannel, _client.socket(), _pEncryptKey, _pChunkSize, packetType, packet);
+		return _senders.back()->writer;
+	}
+	// Aggregate audio/video messages while under size and time bounds
+	shared<RTMPSender> pSender(SET, type, time, streamId, _pChannel, _client.socket(), _pEncryptKey, _pChunkSize, packetType, packet);
+	if (_pAggregate && (time < _aggregateTime || (time - _aggregateTime) >= _settings.aggregateTime))
+		_pAggregate.reset();
+	if (!_pAggregate) {
+		_senders.emplace_back(SET, AMF::TYPE_AGGREGATE, _aggregateTime = time, streamId, _pChannel, _client.socket(), _pEncryptKey, _pChunkSize, Media::Data::TYPE_AMF, Packet::Null());
+		_pAggregate = _senders.back();
+		_aggregateOpening.update();
+	}
+	if (_pAggregate->aggregate(pSender) >= _settings.aggregateSize)
+		_pAggregate.reset(); // full, next media will open a new aggregate
+	return pSender->writer;
 }
 
 
@@ -42,6 +42,39 @@ size_t Segment::ReadName(const string& name, UInt32& sequence, UInt16& duration)
 }
 
 
+size_t Segment::ReadPartName(const string& name, UInt32& sequence, UInt16& part) {
+	// check format NAME.S~P
+	size_t size = name.rfind('.');
+	if (size == string::npos)
+		return string::npos;
+	size_t tilde = name.find('~', size);
+	if (tilde == string::npos)
+		return string::npos;
+	const char* seq = name.c_str() + size + 1;
+	if (!String::ToNumber(seq, name.c_str() + tilde - seq, sequence) || !String::ToNumber(name.c_str() + tilde + 1, name.size() - tilde - 1, part))
+		return string::npos;
+	return size;
+}
+
+size_t Segment::ReadInitName(const string& name) {
+	if (name.size() < 6 || String::ICompare(name.c_str() + name.size() - 5, ".init") != 0)
+		return string::npos;
+	return name.size() - 5;
+}
+
+shared<const Segment::Muxed> Segment::muxed(const string& format) const {
+	lock_guard<mutex> lock(_pCache->mutex);
+	const auto& it = _pCache->find(format);
+	if (it == _pCache->end())
+		return nullptr;
+	return it->second;
+}
+
+void Segment::setMuxed(const string& format, const shared<const Muxed>& pMuxed) const {
+	lock_guard<mutex> lock(_pCache->mutex);
+	if (_pCache->size() < Cache::MAX_FORMATS)
+		_pCache->emplace(format, pMuxed);
+}
 
 bool Segment::add(UInt32 time) {
 	if (!_pFirstTime) {
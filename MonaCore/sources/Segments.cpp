@@ -17,11 +17,85 @@ details (or else see http://mozilla.org/MPL/2.0/).
 #include "Mona/Segments.h"
 #include "Mona/FileWriter.h"
 #include "Mona/Util.h"
+#include "Mona/AVC.h"
+#include "Mona/HEVC.h"
 
 using namespace std;
 
 namespace Mona {
 
+static string& WriteCodecs(const Segment& segment, string& codecs) {
+	// RFC 6381 codecs from segment configs
+	// https://developer.apple.com/documentation/http_live_streaming/hls_authoring_specification_for_apple_devices
+	bool hasVideo = false, hasAudio = false;
+	for (const shared<const Media::Base>& pMedia : segment) {
+		if (!pMedia->isConfig())
+			continue;
+		if (pMedia->type == Media::TYPE_VIDEO && !hasVideo) {
+			Packet vps, sps, pps;
+			switch (((const Media::Video&)*pMedia).tag.codec) {
+				case Media::Video::CODEC_H264:
+					if (!AVC::ParseVideoConfig(*pMedia, sps, pps) || sps.size() < 4)
+						break;
+					hasVideo = true;
+					String::Append(codecs, codecs.empty() ? "" : ",", "avc1.", String::Format<UInt32>("%06X", (sps.data()[1] << 16) | (sps.data()[2] << 8) | sps.data()[3]));
+					break;
+				case Media::Video::CODEC_HEVC: {
+					if (!HEVC::ParseVideoConfig(*pMedia, vps, sps, pps))
+						break;
+					// profile_tier_level after 2 bytes of NAL header and 1 byte of sps ids, remove emulation prevention bytes
+					UInt8 ptl[12];
+					UInt8 size = 0, zeros = 0;
+					for (UInt32 i = 3; i < sps.size() && size < sizeof(ptl); ++i) {
+						if (zeros >= 2 && sps.data()[i] == 3) {
+							zeros = 0;
+							continue;
+						}
+						zeros = sps.data()[i] ? 0 : zeros + 1;
+						ptl[size++] = sps.data()[i];
+					}
+					if (size < sizeof(ptl))
+						break;
+					hasVideo = true;
+					UInt32 compatibility = 0; // reversed bit order
+					for (UInt8 i = 0; i < 32; ++i) {
+						if (ptl[1 + i / 8] & (0x80 >> (i % 8)))
+							compatibility |= 1 << i;
+					}
+					String::Append(codecs, codecs.empty() ? "" : ",", "hev1.");
+					if (ptl[0] >> 6)
+						String::Append(codecs, char('A' + (ptl[0] >> 6) - 1));
+					String::Append(codecs, ptl[0] & 0x1F, '.', String::Format<UInt32>("%X", compatibility), '.', (ptl[0] & 0x20) ? 'H' : 'L', UInt16(ptl[11]));
+					UInt8 constraints = 6;
+					while (constraints && !ptl[4 + constraints])
+						--constraints;
+					for (UInt8 i = 0; i < constraints; ++i)
+						String::Append(codecs, '.', String::Format<UInt8>("%02X", ptl[5 + i]));
+					break;
+				}
+				default:;
+			}
+		} else if (pMedia->type == Media::TYPE_AUDIO && !hasAudio) {
+			switch (((const Media::Audio&)*pMedia).tag.codec) {
+				case Media::Audio::CODEC_AAC:
+					if (!pMedia->size())
+						break;
+					hasAudio = true;
+					String::Append(codecs, codecs.empty() ? "" : ",", "mp4a.40.", *pMedia->data() >> 3);
+					break;
+				case Media::Audio::CODEC_MP3:
+					hasAudio = true;
+					String::Append(codecs, codecs.empty() ? "" : ",", "mp4a.69"); // MPEG-2 audio object type as written by MP4Writer
+					break;
+				default:;
+			}
+		}
+		if (hasVideo && hasAudio)
+			break;
+	}
+	return codecs;
+}
+
 bool Segments::Init(Exception& ex, IOFile& io, Playlist& playlist, bool append) {
 	playlist.reset();
 
@@ -94,9 +168,12 @@ bool Segments::Writer::newSegment(UInt32 time, const OnWrite& onWrite) {
 		// Is on key sequence
 		if (!_keys)
 			return false; // wait at less one video key sequence		
-		// wait at less a segment superior to targetduration = round(maxDuration)/3
-		if (duration/1000  < ((_maxDuration+500)/3000))
-			return false; // wait one other key-frames sequence
+		if (aligned) {
+			// cut on the first key frame of a new duration slot of the timeline
+			if ((time / _duration) == (_segTime / _duration))
+				return false; // wait one other key-frames sequence
+		} else if (duration/1000  < ((_maxDuration+500)/3000))
+			return false; // wait at less a segment superior to targetduration = round(maxDuration)/3
 	} else {
 		if (_keys) // has video
 			return false; // wait video keying
@@ -207,27 +284,123 @@ void Segments::Writer::writeVideo(UInt8 track, const Media::Video::Tag& tag, con
 
 /// SEGMENTS //////
 
-Segments::Segments(UInt8 maxSegments) : _started(false), _duration(0), _maxSegments(maxSegments), _sequence(0), _writer(self) {
+Segments::Segments(UInt8 maxSegments) : _started(false), _duration(0), _maxSegments(maxSegments), _sequence(0), _writer(self),
+	_partDuration(0), _partStarted(false), _partTime(0), _partBegin(0), _partHeader(0), _startTime(0), _configsChanged(false), _version(0), _id(Time::Now()) {
 	init();
 }
-Segments::Segments(Segments&& segments) : _started(false), _duration(segments._duration), _maxSegments(segments._maxSegments), _sequence(segments._sequence), _writer(self) {
+Segments::Segments(Segments&& segments) : _started(false), _duration(segments._duration), _maxSegments(segments._maxSegments), _sequence(segments._sequence), _writer(self),
+	_partDuration(segments._partDuration), _partStarted(false), _partTime(0), _partBegin(0), _partHeader(0), _startTime(segments._startTime), _pDVR(std::move(segments._pDVR)), _configsChanged(false), _init(std::move(segments._init)),
+	_version(segments._version + 1), _id(segments._id) {
 	init();
 	segments._sequence += segments.count();
 	segments._duration = 0;
 	_segments = std::move(segments._segments);
+	_parts = std::move(segments._parts);
+	_waiters = std::move(segments._waiters);
+	segments.change();
 }
 
 void Segments::init() {
 	_writer.onSegment = [this](UInt16 duration) {
 		// add the valid segment to _segments
 		_segment.add(_segment.time() + duration);
+		if (_partStarted) {
+			// last part of the segment
+			cutPart(_segment.time() + duration);
+			_partStarted = false;
+		}
+		_partBegin = 0;
 		_duration += duration;
+		if (!_startTime) // wall clock time of the media time 0
+			_startTime = Time::Now() - (_segment.time() + duration);
 		_segments.emplace_back(move(_segment));
+		if (_configsChanged) {
+			// last segment has new configs, renew the init segment cache
+			_configsChanged = false;
+			_init.reset();
+		}
+		if (_pDVR) {
+			Exception ex;
+			AUTO_WARN(_pDVR->append(ex, _sequence + _segments.size() - 1, _segments.back()), "DVR ", _pDVR->path.name());
+		}
 		setMaxSegments(_maxSegments); // clean segments
+		change();
 		onSegment(duration);
+		wake();
 	};
 }
 
+void Segments::setConfig(Media::Type type, UInt8 track, const Packet& packet) {
+	// configs are rewritten on every segment beginning, compare content to detect a real change
+	UInt16 key = (type << 8) | track;
+	if (!packet) {
+		if (_configs.erase(key))
+			_configsChanged = true;
+		return;
+	}
+	Packet& config = _configs[key];
+	if (config.size() == packet.size() && memcmp(config.data(), packet.data(), packet.size()) == 0)
+		return;
+	config.set(move(packet)); // bufferize, packet can reference a temporary memory zone
+	_configsChanged = true;
+}
+
+void Segments::newPart(UInt32 time) {
+	if (!_partStarted) {
+		// first media with time of the segment, medias before are properties and configs
+		_partStarted = true;
+		_partTime = time;
+		_partHeader = _segment.count();
+		return;
+	}
+	if (Util::Distance(_partTime, time) < _partDuration)
+		return;
+	cutPart(time);
+	_partTime = time;
+	wake();
+}
+
+void Segments::cutPart(UInt32 time) {
+	UInt32 sequence = _sequence + _segments.size();
+	// erase parts of old segments
+	while (!_parts.empty() && (_parts.begin()->first + PART_SEGMENTS) < sequence)
+		_parts.erase(_parts.begin());
+
+	Segment::const_iterator it(_segment.begin() + _partBegin);
+	// independent if starts with a key frame or has no video
+	bool independent = true;
+	for (Segment::const_iterator itMedia = it; itMedia != _segment.end(); ++itMedia) {
+		if ((*itMedia)->type != Media::TYPE_VIDEO || (*itMedia)->isConfig())
+			continue;
+		independent = ((const Media::Video&)**itMedia).tag.frame == Media::Video::FRAME_KEY;
+		break;
+	}
+	vector<Part>& parts = _parts[sequence];
+	parts.emplace_back(independent);
+	Part& part = parts.back();
+	// Rewrite properties + configs to make part readable individualy
+	if (_partBegin) {
+		for (Segment::const_iterator itHeader = _segment.begin(); itHeader != _segment.begin() + _partHeader; ++itHeader)
+			part.add(*itHeader);
+	}
+	while (it != _segment.end())
+		part.add(*it++);
+	part.add(time); // fix end time of the part
+	_partBegin = _segment.count();
+	change();
+}
+
+void Segments::wake() {
+	auto it = _waiters.begin();
+	while (it != _waiters.end()) {
+		shared<Waiter> pWaiter = it->lock();
+		if (!pWaiter || (*pWaiter)(self))
+			it = _waiters.erase(it);
+		else
+			++it;
+	}
+}
+
 UInt8 Segments::setMaxSegments(UInt8 maxSegments) {
 	// erase obsolete segments (keep one more if maxDuration not reached)
 	UInt32 maxDuration = maxSegments * this->maxDuration();
@@ -236,7 +409,21 @@ UInt8 Segments::setMaxSegments(UInt8 maxSegments) {
 		_duration -= _segments.front().duration();
 		_segments.pop_front();
 	}
-	return _maxSegments = maxSegments;;
+	change();
+	return _maxSegments = maxSegments;
+}
+
+bool Segments::setDVR(IOFile& io, const Path& path, UInt32 retention) {
+	if (!retention || !path) {
+		resetDVR();
+		return false;
+	}
+	change();
+	if (_pDVR && _pDVR->path == path)
+		_pDVR->setRetention(retention);
+	else
+		_pDVR.set(io, path, retention);
+	return true;
 }
 
 bool Segments::beginMedia(const string& name) {
@@ -244,6 +431,8 @@ bool Segments::beginMedia(const string& name) {
 	if (_started)
 		_writer.endMedia(nullptr);
 	_started = true;
+	_startTime = 0;
+	change();
 	_writer.beginMedia(nullptr);
 	return true;
 }
@@ -254,14 +443,21 @@ bool Segments::endMedia() {
 	_writer.endMedia(nullptr);
 	// reset segment after endMedia because onSegment will emplace_back this last segment
 	_segment.reset();
+	_configs.clear(); // next media will renew the init segment
+	_partStarted = false;
+	_partBegin = 0;
+	change();
+	wake(); // no more part or segment to wait
 	// Don't reset _maxDuration and segments, must stays alive for playlist usage (delete the Segments object to reset all)
 	return true;
 }
 
 
-const Segment& Segments::operator()(Int32 sequence) const {
+Segment Segments::operator()(Int32 sequence) const {
 	if (sequence < 0)
 		sequence += _segments.size();
+	else if (_pDVR && UInt32(sequence) < _sequence)
+		return (*_pDVR)(sequence); // no more in memory
 	else
 		sequence -= _sequence;
 	if(sequence < 0)
@@ -272,11 +468,74 @@ const Segment& Segments::operator()(Int32 sequence) const {
 	return _segments[(UInt32)sequence];
 }
 
-Playlist& Segments::to(Playlist& playlist) const {
+const Segment& Segments::operator()(UInt32 sequence, UInt16 part) const {
+	const auto& it = _parts.find(sequence);
+	if (it == _parts.end() || part >= it->second.size())
+		return Segment::Null();
+	return it->second[part];
+}
+
+bool Segments::has(UInt32 sequence, Int32 part) const {
+	if (!_started)
+		return true; // nothing to wait
+	UInt32 current = _sequence + _segments.size();
+	if (sequence < current)
+		return true;
+	if (sequence > current || part < 0)
+		return false;
+	const auto& it = _parts.find(sequence);
+	return it != _parts.end() && UInt32(part) < it->second.size();
+}
+
+Packet Segments::Playlists::get(const string& key) const {
+	lock_guard<mutex> lock(_mutex);
+	const auto& it = _playlists.find(key);
+	return it == _playlists.end() ? Packet() : Packet(it->second);
+}
+
+void Segments::Playlists::set(const string& key, const Packet& playlist) const {
+	lock_guard<mutex> lock(_mutex);
+	if (_playlists.size() < MAX_PLAYLISTS)
+		_playlists.emplace(key, std::move(playlist));
+}
+
+shared<const Segments::Playlists> Segments::playlists() const {
+	if (!_pPlaylists)
+		_pPlaylists.set(_id, _version);
+	return _pPlaylists;
+}
+
+Playlist& Segments::to(Playlist& playlist, UInt32 dvr) const {
+	if (dvr && _pDVR && *_pDVR) {
+		// DVR window from the disk-backed ring (without LL-HLS parts)
+		_pDVR->to(playlist, dvr);
+		if (playlist.maxDuration < maxDuration())
+			playlist.maxDuration = maxDuration();
+		playlist.startTime = _startTime;
+		if (!_segments.empty())
+			WriteCodecs(_segments.back(), playlist.codecs);
+		if (!_started)
+			playlist.addItem(0); // end
+		return playlist;
+	}
 	playlist.reset().sequence = _sequence;
-	(UInt64&)playlist.maxDuration = maxDuration();
+	playlist.maxDuration = maxDuration();
+	if (_partDuration && _started) {
+		// LL-HLS parts, PART-TARGET has to be superior to every part duration
+		playlist.partDuration = _partDuration;
+		for (const auto& it : _parts) {
+			UInt16 index = 0;
+			for (const Part& part : it.second) {
+				if (part.duration() > playlist.partDuration)
+					playlist.partDuration = part.duration();
+				playlist.parts.push_back({ it.first, index++, part.duration(), part.independent });
+			}
+		}
+	}
+	playlist.startTime = _startTime;
 	// Skip the first segment in playlist, because can be deleted by segments before request
 	bool first = _segments.size() >= _maxSegments;
+	UInt64 bytes = 0;
 	for (const Segment& segment : _segments) {
 		if (first) {
 			first = false;
@@ -284,10 +543,18 @@ Playlist& Segments::to(Playlist& playlist) const {
 			++playlist.sequence;
 			continue;
 		}
+		if (!playlist.count())
+			playlist.time = segment.time();
 		if (segment.discontinuous())
 			playlist.addItem(0); // discontinuous
 		playlist.addItem(segment.duration());
+		for (const shared<const Media::Base>& pMedia : segment)
+			bytes += pMedia->size();
 	}
+	if (playlist.duration())
+		playlist.bandwidth = UInt32(bytes * 8000 / playlist.duration());
+	if (!_segments.empty())
+		WriteCodecs(_segments.back(), playlist.codecs);
 	if (!_started)
 		playlist.addItem(0); // end
 	return playlist;
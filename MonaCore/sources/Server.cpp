@@ -49,6 +49,8 @@ Parameters& Server::start(const Parameters& parameters) {
 	else
 		FileSystem::MakeFolder(_www);
 	setString("wwwDir", _www);
+	// DVR rings folder, out of www to never be served
+	setString("dvrDir", FileSystem::MakeFolder(getString("dvrDir", "dvr/")));
 	Exception ex;
 	AUTO_ERROR(FileSystem::CreateDirectory(ex, _www), "Application directory creation");
 
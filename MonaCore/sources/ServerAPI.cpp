@@ -79,6 +79,8 @@ Publication* ServerAPI::publish(Exception& ex, Path& stream, Client* pClient) {
 
 
 	if (onPublish(ex, publication, pClient)) {
+		// DVR ring folder, used just if "dvr" parameter sets a retention (out of www to never serve or erase public files)
+		Path dvr(getString("dvrDir", "dvr/"), pClient ? pClient->path : "", name, ".dvr/");
 		if(!stream.extension().empty()) {
 			// RECORD!
 			Path path(www, pClient ? pClient->path : "", name, '.', stream.extension());
@@ -92,13 +94,13 @@ Publication* ServerAPI::publish(Exception& ex, Path& stream, Client* pClient) {
 					WARN("File text properties ", props, " not supported to publication recording");
 				unique<MediaFile::Writer> pFileWriter = MediaFile::Writer::New(ex, path.c_str(), ioFile, publication.getString("format",""));
 				if (pFileWriter) {
-					publication.start(move(pFileWriter));
+					publication.start(move(pFileWriter), dvr, &ioFile);
 					return &publication;
 				}
 				WARN(name, " impossible to record, ", ex);
 			}
 		}
-		publication.start();
+		publication.start(nullptr, dvr, &ioFile);
 		return &publication;
 	}
 
@@ -238,6 +240,7 @@ bool ServerAPI::subscribe(Exception& ex, Publication& publication, Subscription&
 		return false;
 	}
 	((set<Subscription*>&)publication.subscriptions).emplace(&subscription);
+	publication.textsChange();
 
 	if (subscription.pPublication)
 		unsubscribe(subscription, subscription.setNext(&publication), pClient); // publication switch (MBR) + cancel possible previous next!
@@ -260,6 +263,7 @@ void ServerAPI::unsubscribe(Subscription& subscription, Publication* pPublicatio
 		return;
 	if (!((set<Subscription*>&)pPublication->subscriptions).erase(&subscription))
 		return; // no subscription
+	pPublication->textsChange();
 	DEBUG((pClient ? pClient->address : TypeOf(self)), " unsubscribes to ", pPublication->name());
 	if (pClient && !pClient->connection)
 		ERROR(pPublication->name()," unsubscription before client connection")
@@ -275,8 +279,8 @@ void ServerAPI::unsubscribe(Subscription& subscription, Publication* pPublicatio
 
 void ServerAPI::erasePublication(const map<string, Publication>::const_iterator& it) {
 	Segments& segments = (Segments&)it->second.segments;
-	if (segments)
-		resources.create<Segments>(it->first, segments.duration(), std::move(segments));
+	if (segments) // keep segments alive during their duration, or during the DVR retention
+		resources.create<Segments>(it->first, segments.dvr() ? max<UInt32>(segments.duration(), segments.dvr()->retention() * 1000) : segments.duration(), std::move(segments));
 	_publications.erase(it);
 }
 
@@ -130,6 +130,8 @@ void Subscription::onParamChange(const string& key, const string* pValue) {
 				_datas.pSelection.reset();
 			else
 				_datas.pSelection.set(track);
+			if (pPublication)
+				pPublication->textsChange();
 		} else if (String::ICompare(key, "audio") == 0)
 			setMediaSelection(pPublication ? &pPublication->audios : NULL, pValue, _audios);
 		else if (String::ICompare(key, "video") == 0)
@@ -147,6 +149,8 @@ void Subscription::onParamClear() {
 	setMediaSelection(pPublication ? &pPublication->audios : NULL, NULL, _audios);
 	setMediaSelection(pPublication ? &pPublication->videos : NULL, NULL, _videos);
 	_datas.pSelection.reset();
+	if (pPublication)
+		pPublication->textsChange();
 	Media::Properties::onParamClear();
 }
 
@@ -635,6 +639,7 @@ void Subscription::Medias::setNext(Publication* pNextPublication) {
 
 		// unsubscribe in last to have "_nextSize = 0" and like that no reset packet stacked!
 		((set<Subscription*>&)_pNextSubscription->pPublication->subscriptions).erase(_pNextSubscription.get());
+		_pNextSubscription->pPublication->textsChange();
 		// reinitialize subscription instead of recreate it (more faster on multiple MBR switch)
 		_pNextSubscription->release();
 	}
@@ -667,6 +672,7 @@ void Subscription::Medias::setNext(Publication* pNextPublication) {
 	else
 		_pNextSubscription->_datas.pSelection.reset();
 	((set<Subscription*>&)pNextPublication->subscriptions).emplace(_pNextSubscription.get());
+	pNextPublication->textsChange();
 	_nextTimeout.update();
 }
 
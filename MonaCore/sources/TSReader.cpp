@@ -42,122 +42,98 @@ TSReader::Program& TSReader::Program::reset(Media::Source& source) {
 
 UInt32 TSReader::parse(Packet& buffer, Media::Source& source) {
 
-	BinaryReader input(buffer.data(), buffer.size());
+	const UInt8* data(buffer.data());
+	const UInt8* end(data + buffer.size());
 
-	do {
+	while (data < end) {
 
-		if(!_syncFound) {
-			while (input.read8()!=0x47) {
-				if (!_syncError) {
-					WARN("TSReader 47 signature not found");
-					_syncError = true;
-				}
-				if (!input.available())
-					return 0;
+		if (*data != 0x47) {
+			if (!_syncError) {
+				WARN("TSReader 47 signature not found");
+				_syncError = true;
 			}
-			_syncFound = true;
-			_syncError = false;
+			if (!(data = (const UInt8*)memchr(data, 0x47, end - data)))
+				return 0;
 		}
 
-		if (input.available() < 187)
-			return input.available();
-
-		BinaryReader reader(input.current(), 187);
-		//Logs::Dump(reader.data(), reader.size());
-		input.next(187);
-
-		_syncFound = false;
-			
-		// Now 187 bytes after 0x47
-			
-		// top of second byte
-		UInt8 byte(reader.read8());
-	//	bool tei(byte&0x80 ? true : false); // error indicator
-		bool hasHeader(byte &0x40 ? true : false); // payload unit start indication
-//		bool tpri(byte&0x20 ? true : false); // transport priority indication
-			
-		// program ID = bottom of second byte and all of third
-		UInt16 pid(((byte & 0x1f)<<8) | reader.read8());
-			
-		// fourth byte
-		byte = reader.read8();
-
-		//	UInt8 scramblingControl((value >> 6) & 0x03); // scrambling control for DVB-CSA, TODO?
-		bool hasContent(byte & 0x10 ? true : false);	// has payload data
-		// technically hasPD without hasAF is an error, see spec
-			
-		if (byte & 0x20) { // has adaptation field
-			 // process adaptation field and PCR
-			UInt8 length(reader.read8());
-			if (length >= 7) {
-				if (reader.read8() & 0x10)
-					length -= reader.next(6);
-				/*if (reader.read8() & 0x10) {
-					length -= 6;
-					pcr = reader.read32();
-					pcr <<= 1;	
-					UInt16 extension(reader.read16());
-					pcr |= (extension>>15)&1;
-					pcr *= 300;
-					pcr += (extension&0x1FF);
-				}*/
-				--length;
-			}
-			reader.next(length);
+		// Validate the sync byte of all the complete packets available and extract their headers in one pass
+		_cells.clear();
+		const UInt8* cur(data);
+		for (; (end - cur) >= 188 && *cur == 0x47; cur += 188) {
+			_cells.emplace_back();
+			Cell& cell(_cells.back());
+			// bool tei(cur[1]&0x80 ? true : false); // error indicator
+			cell.hasHeader = cur[1] & 0x40 ? true : false;
+			// bool tpri(cur[1]&0x20 ? true : false); // transport priority indication
+			// program ID = bottom of second byte and all of third
+			cell.pid = ((cur[1] & 0x1f) << 8) | cur[2];
+			// UInt8 scramblingControl((cur[3] >> 6) & 0x03); // scrambling control for DVB-CSA, TODO?
+			cell.flags = cur[3];
+			// adaptation field (PCR ignored)
+			cell.offset = (cell.flags & 0x20) ? UInt8(min(5 + cur[4], 188)) : 4;
 		}
+		if (_cells.empty())
+			return end - data; // wait the end of the packet
+		_syncError = false;
 
-		if(!pid) {
-			// PAT
-			if (hasHeader && hasContent) // assume that PAT table can't be split (pusi==true) + useless if no playload
-				parsePAT(reader.current(), reader.available(), source);
-			continue;
-		}
-		if (pid == 0x1FFF)
-			continue; // null packet, used for fixed bandwidth padding
-		const auto& it(_programs.find(pid));
-		if (it == _programs.end()) {
-			if (!hasHeader || !hasContent)
-				continue;
-			const auto& itPMT(_pmts.find(pid));
-			if (itPMT != _pmts.end()) // assume that PMT table can't be split (pusi==true) + useless if no playload
-				parsePSI(reader.current(), reader.available(), itPMT->second, source);
-			continue;
+		for (const Cell& cell : _cells) {
+			parseCell(cell, buffer, data, source);
+			data += 188;
 		}
+	}
+	return 0;
+}
 
-		if (!it->second)
-			continue;  // ignore unsupported track!
-
-		// Program known!
-
-		UInt8 sequence(byte & 0x0f);
-		UInt32 lost = sequence - it->second.sequence;
-		if (hasContent)
-			--lost; // continuity counter is incremented just on playload, else it says same!
-		lost = (lost & 0x0F) * 184; // 184 is an approximation (impossible to know if missing packet had playload header or adaptation field)
-		// On lost data, wait next header!
-		if (lost) {
-			if (!it->second.waitHeader) {
-				it->second.waitHeader = true;
-				it->second->flush(source); // flush to reset the state!
-			}
-			if (it->second.sequence != 0xFF) // if sequence==0xFF it's the first time, no real lost, juste wait header!
-				source.reportLost(it->second.type, lost, it->second->track);
-		}
-		it->second.sequence = sequence;
-	
-		if (hasHeader)
-			readPESHeader(reader, it->second);
-
-		if (hasContent) {
-			if (it->second.waitHeader)
-				lost += reader.available();
-			else
-				it->second->read(Packet(buffer, reader.current(), reader.available()), source);
+void TSReader::parseCell(const Cell& cell, const Packet& buffer, const UInt8* data, Media::Source& source) {
+	BinaryReader reader(data + cell.offset, 188 - cell.offset);
+	bool hasContent(cell.flags & 0x10 ? true : false);	// has payload data
+	// technically hasPD without hasAF is an error, see spec
+
+	if (!cell.pid) {
+		// PAT
+		if (cell.hasHeader && hasContent) // assume that PAT table can't be split (pusi==true) + useless if no playload
+			parsePAT(reader.current(), reader.available(), source);
+		return;
+	}
+	if (cell.pid == 0x1FFF)
+		return; // null packet, used for fixed bandwidth padding
+	const auto& it(_programs.find(cell.pid));
+	if (it == _programs.end()) {
+		if (!cell.hasHeader || !hasContent)
+			return;
+		const auto& itPMT(_pmts.find(cell.pid));
+		if (itPMT != _pmts.end()) // assume that PMT table can't be split (pusi==true) + useless if no playload
+			parsePSI(reader.current(), reader.available(), itPMT->second, source);
+		return;
+	}
+
+	if (!it->second)
+		return;  // ignore unsupported track!
+
+	// Program known!
+
+	UInt8 sequence(cell.flags & 0x0f);
+	UInt32 lost = sequence - it->second.sequence;
+	if (hasContent)
+		--lost; // continuity counter is incremented just on playload, else it says same!
+	lost = (lost & 0x0F) * 184; // 184 is an approximation (impossible to know if missing packet had playload header or adaptation field)
+	// On lost data, wait next header!
+	if (lost) {
+		if (!it->second.waitHeader) {
+			it->second.waitHeader = true;
+			it->second->flush(source); // flush to reset the state!
 		}
-		
-	} while (input.available());
+		if (it->second.sequence != 0xFF) // if sequence==0xFF it's the first time, no real lost, juste wait header!
+			source.reportLost(it->second.type, lost, it->second->track);
+	}
+	it->second.sequence = sequence;
 
-	return 0;
+	if (cell.hasHeader)
+		readPESHeader(reader, it->second);
+
+	// payload given as a slice of the buffer received, no copy
+	if (hasContent && !it->second.waitHeader)
+		it->second->read(Packet(buffer, reader.current(), reader.available()), source);
 }
 
 void TSReader::parsePAT(const UInt8* data, UInt32 size, Media::Source& source) {
@@ -397,7 +373,6 @@ void TSReader::onFlush(Packet& buffer, Media::Source& source) {
 	_propVersion = _properties.version;
 	_audioTrack = 0; _videoTrack = 0;
 	_pmts.clear();
-	_syncFound = false;
 	_syncError = false;
 	_crcPAT = 0;
 	_startTime = -1;
@@ -39,21 +39,6 @@ namespace Mona {
 // An offset with PCR is necessary to make working forward/rewind feature on few player as VLC
 #define PCR_OFFSET			200
 
-static UInt8 _FF[188] = {
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
-};
-
 TSWriter::Track& TSWriter::Track::operator=(MediaTrackWriter* pWriter) {
 	if (_pWriter) {
 		_pWriter->endMedia();
@@ -146,7 +131,7 @@ void TSWriter::writePMT(BinaryWriter& writer, UInt32 time) {
 	// Write CRC
 	writer.write32(Crypto::ComputeCRC32(writer.data() + offset + 5, (writer.size() - offset) - 5));
 	// Fill with FF
-	writer.write(_FF, 188 - (writer.size() - offset));
+	writer.append(188 - (writer.size() - offset), 0xFF);
 
 
 	offset = writer.size();
@@ -211,7 +196,7 @@ void TSWriter::writePMT(BinaryWriter& writer, UInt32 time) {
 	// Write CRC
 	writer.write32(Crypto::ComputeCRC32(writer.data() + offset + 5, (writer.size() - offset) - 5));
 	// Fill with FF
-	writer.write(_FF, 188 - (writer.size() - offset));
+	writer.append(188 - (writer.size() - offset), 0xFF);
 
 	_timePMT = time;
 }
@@ -262,8 +247,7 @@ void TSWriter::writeAudio(UInt8 track, const Media::Audio::Tag& tag, const Packe
 	} else // MP3
 		writeES(writer, itPID->first, itPID->second, tag.time, 0, packet, packet.size());
 
-	if(!pBuffer->empty())
-		onWrite(Packet(pBuffer));
+	flush(pBuffer, onWrite);
 //	if (_canWrite || _toWrite)
 //		int breakPoint = 0;
 }
@@ -302,8 +286,7 @@ void TSWriter::writeVideo(UInt8 track, const Media::Video::Tag& tag, const Packe
 	});
 	it->second->writeVideo(tag, packet, onVideoWrite, finalSize);
 
-	if (!pBuffer->empty())
-		onWrite(Packet(pBuffer));
+	flush(pBuffer, onWrite);
 	//	if (_canWrite || _toWrite)
 	//		int breakPoint = 0;
 }
@@ -314,13 +297,45 @@ void TSWriter::writeES(BinaryWriter& writer, UInt16 pid, UInt8& counter, UInt32
 		if (!_toWrite) {
 			if (_canWrite) {
 				ERROR("TS writer program ", pid, " has miscalculated PES split and fill size");
-				writer.write(_FF, _canWrite);
+				writer.append(_canWrite, 0xFF);
 			}
+			// preallocate the TS packets of the whole PES (+ possible PMT and PCR packets)
+			Buffer& buffer(writer.buffer());
+			UInt32 size(buffer.size());
+			buffer.resize(size + (esSize / 184) * (scatter ? 4 : 188) + 3 * 188).resize(size);
 			_canWrite = writePES(writer, pid, counter, time, compositionOffset, randomAccess, _toWrite = esSize);
-		} else if (!_canWrite)
+		} else if (!_canWrite) {
+			if (_toWrite >= 184 && playload.size() >= 184) {
+				// batch of full TS packets, without adaptation field: header template where just continuity counter changes
+				UInt32 count(min(playload.size(), _toWrite) / 184);
+				_toWrite -= count * 184;
+				UInt8 header[] = { 0x47, UInt8(pid >> 8), UInt8(pid), 0x10 };
+				if (scatter) {
+					while (count--) {
+						header[3] = 0x10 | (counter++ % 0x10);
+						_chain.emplace_back(SET, forward_as_tuple(writer.write(header, 4).size()), forward_as_tuple(playload, playload.data(), 184));
+						playload += 184;
+					}
+					continue;
+				}
+				UInt32 size(writer.size());
+				UInt8* cell(writer.resize(size + count * 188).buffer().data() + size);
+				while (count--) {
+					header[3] = 0x10 | (counter++ % 0x10);
+					memcpy(cell, header, 4);
+					memcpy(cell + 4, playload.data(), 184);
+					playload += 184;
+					cell += 188;
+				}
+				continue;
+			}
 			_canWrite = writePES(writer, pid, counter, time, randomAccess, _toWrite);
+		}
 		UInt32 toWrite = playload.size() > _canWrite ? _canWrite : playload.size();
-		writer.write(playload.data(), toWrite);
+		if (scatter && toWrite >= 64) // reference media data rather than copy it (except small parts as NAL prefixes), valid until flush at the end of writeAudio/writeVideo
+			_chain.emplace_back(SET, forward_as_tuple(writer.size()), forward_as_tuple(playload, playload.data(), toWrite));
+		else
+			writer.write(playload.data(), toWrite);
 		playload += toWrite;
 		_canWrite -= toWrite;
 		if (toWrite>_toWrite) {
@@ -331,6 +346,23 @@ void TSWriter::writeES(BinaryWriter& writer, UInt16 pid, UInt8& counter, UInt32
 	}
 }
 
+void TSWriter::flush(shared<Buffer>& pBuffer, const OnWrite& onWrite) {
+	if (pBuffer->empty())
+		return;
+	Packet buffer(pBuffer);
+	UInt32 position(0);
+	// headers and media parts alternately, in the order of the TS stream
+	for (const auto& it : _chain) {
+		if (it.first > position)
+			onWrite(Packet(buffer, buffer.data() + position, it.first - position));
+		onWrite(it.second);
+		position = it.first;
+	}
+	_chain.clear();
+	if (position < buffer.size())
+		onWrite(Packet(buffer, buffer.data() + position, buffer.size() - position));
+}
+
 UInt8 TSWriter::writePES(BinaryWriter& writer, UInt16 pid, UInt8& counter, UInt32 time, bool randomAccess, UInt32 size) {
 	writer.write8(0x47).write16(pid);
 	if (size >= 184) {
@@ -382,7 +414,7 @@ UInt8 TSWriter::writePES(BinaryWriter& writer, UInt16 pid, UInt8& counter, UInt3
 			else if (deltaTime >= 500) { // 500ms without PCR track, pulse it now (urgent)
 				// just PCR program (_pidPCR) can deliver the PCR timecode
 				const auto& it(_pids.emplace(_pidPCR, 0).first);
-				writer.write(_FF, writePES(writer, it->first, it->second, time, compositionOffset, false, 0));
+				writer.append(writePES(writer, it->first, it->second, time, compositionOffset, false, 0), 0xFF);
 			}
 		}
 	}
@@ -435,7 +467,7 @@ void TSWriter::writeAdaptiveHeader(BinaryWriter& writer, UInt16 pid, UInt32 time
 	} else if(fillSize)
 		writer.write8(0); // flags
 	// Fill with FF
-	writer.write(_FF, ++fillSize-(writer.size()-offset));
+	writer.append(++fillSize-(writer.size()-offset), 0xFF);
 }
 
 
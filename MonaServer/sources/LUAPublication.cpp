@@ -78,6 +78,16 @@ static int latency(lua_State *pState) {
 		SCRIPT_WRITE_INT(publication.latency())
 	SCRIPT_CALLBACK_RETURN
 }
+static int recordingQueueing(lua_State *pState) {
+	SCRIPT_CALLBACK(Publication, publication)
+		SCRIPT_WRITE_DOUBLE(publication.recordingQueueing())
+	SCRIPT_CALLBACK_RETURN
+}
+static int recordingLatency(lua_State *pState) {
+	SCRIPT_CALLBACK(Publication, publication)
+		SCRIPT_WRITE_INT(publication.recordingLatency())
+	SCRIPT_CALLBACK_RETURN
+}
 
 template<> void Script::ObjInit(lua_State *pState, Publication& publication) {
 	AddType<Media::Source>(pState, publication);
@@ -92,6 +102,8 @@ template<> void Script::ObjInit(lua_State *pState, Publication& publication) {
 		SCRIPT_DEFINE("videos", AddObject(pState, publication.videos));
 		SCRIPT_DEFINE("datas", AddObject(pState, publication.datas));
 		SCRIPT_DEFINE_FUNCTION("latency", &latency);
+		SCRIPT_DEFINE_FUNCTION("recordingQueueing", &recordingQueueing);
+		SCRIPT_DEFINE_FUNCTION("recordingLatency", &recordingLatency);
 		SCRIPT_DEFINE_FUNCTION("byteRate", &byteRate<const Publication>);
 		SCRIPT_DEFINE_FUNCTION("lostRate", &lostRate<const Publication>);
 	SCRIPT_END;
@@ -0,0 +1,129 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/AMFReader.h"
+#include "Mona/AMFWriter.h"
+#include "Mona/JSONWriter.h"
+#include <algorithm>
+
+using namespace Mona;
+using namespace std;
+
+namespace AMFTest {
+
+static const UInt32 Items(200);
+static const char* Categories[] = { "books", "music", "movies", "games" };
+static const char* Users[] = { "alice", "bob", "carol" };
+
+// NetConnection.call("updateCatalog", responder, catalog) with a catalog of typed items
+static void WriteCall(DataWriter& writer) {
+	writer.writeString(EXPAND("updateCatalog"));
+	writer.writeNumber(2); // transaction id
+	writer.writeNull();
+	writer.beginObject();
+	writer.writePropertyName("items");
+	writer.beginArray(Items);
+	for (UInt32 i = 0; i < Items; ++i) {
+		writer.beginObject("com.example.Item");
+		writer.writeNumberProperty("id", i);
+		writer.writeStringProperty("name", String("Item ", i));
+		writer.writeStringProperty("category", Categories[i % 4]);
+		writer.writeNumberProperty("price", i * 1.25);
+		writer.writeBooleanProperty("available", (i % 3) ? true : false);
+		writer.writePropertyName("owner");
+		writer.beginObject("com.example.User");
+		writer.writeStringProperty("name", Users[i % 3]);
+		writer.writeStringProperty("role", "editor");
+		writer.endObject();
+		writer.endObject();
+	}
+	writer.endArray();
+	writer.writeNumberProperty("total", Items);
+	writer.endObject();
+}
+
+static UInt32 Count(const Buffer& buffer, const char* value) {
+	UInt32 count(0);
+	const UInt8* end(buffer.data() + buffer.size());
+	for (const UInt8* cur = buffer.data(); (cur = search(cur, end, value, value + strlen(value))) < end; ++cur)
+		++count;
+	return count;
+}
+
+ADD_TEST(References) {
+	Buffer amf, json, expected;
+	AMFWriter amfWriter(amf);
+	WriteCall(amfWriter);
+	// strings and traits written just one time, then referenced
+	CHECK(Count(amf, "com.example.Item") == 1 && Count(amf, "category") == 1 && Count(amf, "editor") == 1 && Count(amf, "Item 1") == 111);
+
+	JSONWriter jsonWriter(json);
+	AMFReader(Packet(amf.data(), amf.size())).read(jsonWriter);
+	JSONWriter expectedWriter(expected);
+	WriteCall(expectedWriter);
+	CHECK(json.size() == expected.size() && memcmp(json.data(), expected.data(), json.size()) == 0);
+
+	// object reference resolved by a writer which can't repeat
+	amf.clear();
+	AMFWriter objects(amf);
+	objects.beginObject("com.example.User");
+	objects.writeStringProperty("name", "alice");
+	objects.endObject();
+	objects.beginArray(2);
+	UInt64 reference(objects.beginObject());
+	objects.writeNumberProperty("id", 1);
+	objects.endObject();
+	CHECK(objects.repeat(reference));
+	objects.endArray();
+	objects.beginObject("com.example.User");
+	objects.writeStringProperty("name", "bob");
+	objects.endObject();
+
+	json.clear();
+	JSONWriter jsonObjects(json);
+	AMFReader(Packet(amf.data(), amf.size())).read(jsonObjects);
+	CHECK(string(STR json.data(), json.size()) == R"([{"__type":"com.example.User","name":"alice"},[{"id":1},{"id":1}],{"__type":"com.example.User","name":"bob"}])");
+}
+
+ADD_TEST(EncodeCost) {
+	Buffer amf;
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 1000; ++i) {
+		amf.clear();
+		AMFWriter writer(amf);
+		WriteCall(writer);
+	}
+	chrono.stop();
+	DEBUG("AMF NetConnection.call encoding, ", chrono.elapsed(), "us/call (", amf.size(), " bytes)");
+}
+
+ADD_TEST(DecodeCost) {
+	Buffer amf;
+	AMFWriter writer(amf);
+	WriteCall(writer);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 1000; ++i)
+		AMFReader(Packet(amf.data(), amf.size())).read(DataWriter::Null());
+	chrono.stop();
+	DEBUG("AMF NetConnection.call decoding, ", chrono.elapsed(), "us/call (", amf.size(), " bytes)");
+}
+
+}
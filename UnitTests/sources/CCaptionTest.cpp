@@ -0,0 +1,100 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/CCaption.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace CCaptionTest {
+
+// AVCC frame, with a SEI of CEA-608 captions "Hi" on channel 1 if captions
+static Buffer& WriteFrame(Buffer& buffer, bool captions) {
+	BinaryWriter writer(buffer);
+	if (captions) {
+		writer.write32(23).write8(0x06).write8(4).write8(19); // SEI, user data registered
+		writer.write8(0xB5).write16(0x0031).write(EXPAND("GA94")).write8(3);
+		writer.write8(0x43).write8(0xFF); // 3 cc
+		writer.write8(0xFC).write8(0x14).write8(0x20); // resume caption loading
+		writer.write8(0xFC).write(EXPAND("Hi"));
+		writer.write8(0xFC).write8(0x14).write8(0x2F); // end of caption
+		writer.write8(0x80);
+	}
+	writer.write32(100).write8(0x65).append(99, 0x11); // slice
+	return buffer;
+}
+
+ADD_TEST(Extract) {
+	CCaption cc;
+	vector<string> texts;
+	CCaption::OnText onText([&texts](UInt8 channel, shared<Buffer>& pBuffer) {
+		CHECK(channel == 1);
+		texts.emplace_back(STR pBuffer->data(), pBuffer->size());
+	});
+	CCaption::OnLang onLang([](UInt8 channel, const char* lang) {});
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	tag.frame = Media::Video::FRAME_KEY;
+
+	Buffer sei, slice;
+	WriteFrame(sei, true);
+	WriteFrame(slice, false);
+	CHECK(cc.extract(tag, Packet(sei.data(), sei.size()), onText, onLang) == 27 && cc.scanned() == 1 && !cc.skipped() && !cc.filtered());
+	// frame without SEI skipped on its NAL types, captions flushed
+	tag.time = 40;
+	CHECK(!cc.extract(tag, Packet(slice.data(), slice.size()), onText, onLang) && cc.scanned() == 1 && cc.filtered() == 1 && !cc.skipped());
+	CHECK(texts.size() == 1 && texts[0] == "Hi");
+
+	// no more consumer, pending captions released without text
+	tag.time = 80;
+	cc.extract(tag, Packet(sei.data(), sei.size()), onText, onLang);
+	cc.skip();
+	cc.skip();
+	CHECK(texts.size() == 1 && cc.scanned() == 2 && cc.skipped() == 2 && cc.filtered() == 1);
+
+	// consumer again, extraction restarts cleanly
+	tag.time = 120;
+	cc.extract(tag, Packet(sei.data(), sei.size()), onText, onLang);
+	tag.time = 160;
+	cc.extract(tag, Packet(slice.data(), slice.size()), onText, onLang);
+	CHECK(texts.size() == 2 && texts[1] == "Hi" && cc.scanned() == 3 && cc.skipped() == 2 && cc.filtered() == 2);
+
+	// not H264
+	Media::Video::Tag hevc(Media::Video::CODEC_HEVC);
+	CHECK(!cc.extract(hevc, Packet(sei.data(), sei.size()), onText, onLang) && cc.filtered() == 3);
+}
+
+ADD_TEST(ExtractCost) {
+	CCaption cc;
+	CCaption::OnText onText([](UInt8 channel, shared<Buffer>& pBuffer) {});
+	CCaption::OnLang onLang([](UInt8 channel, const char* lang) {});
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	Buffer frame;
+	WriteFrame(frame, false);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 1000000; ++i) {
+		tag.time = i * 40;
+		cc.extract(tag, Packet(frame.data(), frame.size()), onText, onLang);
+	}
+	chrono.stop();
+	CHECK(cc.filtered() == 1000000 && !cc.scanned() && !cc.skipped());
+	DEBUG("Closed captions prefilter, ", chrono.elapsed(), "ns/frame");
+}
+
+}
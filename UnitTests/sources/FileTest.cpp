@@ -121,6 +121,7 @@ ADD_TEST(FileWriter) {
 	io.join();
 	CHECK(onFlush); // onFlush!
 	CHECK(writer->written() == 5 && writer->size(true) == 5);
+	CHECK(writer->delay() >= writer->latency()); // write latency from its queueing
 	writer.write(salut);
 	io.join();
 	CHECK(writer->written() == 10 && writer->size(true) == 10);
@@ -0,0 +1,352 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/Segments.h"
+#include "Mona/M3U8.h"
+#include "Mona/MPD.h"
+#include "Mona/FileSystem.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace HLSTest {
+
+static ThreadPool _ThreadPool;
+
+// 25 fps video with one key frame every 2 seconds
+static void WriteVideo(Segments& segments, UInt32& frame, UInt32 count) {
+	static const Packet Frame(EXPAND("frame"));
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	while (count--) {
+		tag.time = frame * 40;
+		tag.frame = (frame++ % 50) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		segments.writeVideo(1, tag, Frame);
+	}
+}
+
+static bool Contains(const Buffer& buffer, const char* value) {
+	return string(STR buffer.data(), buffer.size()).find(value) != string::npos;
+}
+
+ADD_TEST(PartName) {
+	string name;
+	Segment::WritePartName("live", 12, 3, name);
+	CHECK(name == "live.12~3");
+	UInt32 sequence;
+	UInt16 part, duration;
+	CHECK(Segment::ReadPartName(name, sequence, part) == 4 && sequence == 12 && part == 3);
+	CHECK(Segment::ReadName(name, sequence, duration) == string::npos);
+	name.clear();
+	CHECK(Segment::ReadPartName(Segment::WriteName("live", 12, 2000, name), sequence, part) == string::npos);
+}
+
+ADD_TEST(LowLatency) {
+	Segments segments(4);
+	segments.setPartDuration(200);
+	UInt32 frame = 0;
+	WriteVideo(segments, frame, 4 * 50 + 11); // 4 segments + 2 parts
+	CHECK(segments.count() == 4);
+	UInt32 current = segments.sequence() + segments.count();
+
+	// parts of the last segment
+	const Segment& first = segments(current - 1, 0);
+	CHECK(first && first.duration() == 200);
+	CHECK(!segments(current - 1, 10));
+	CHECK(segments(current, 1) && !segments(current, 2));
+	CHECK(segments.has(current - 1) && segments.has(current, 1) && !segments.has(current, 2) && !segments.has(current));
+
+	Playlist playlist(Path("live.ts"));
+	Buffer buffer;
+	M3U8::Write(segments.to(playlist), buffer);
+	CHECK(playlist.partDuration == 200);
+	CHECK(Contains(buffer, "#EXT-X-VERSION:6"));
+	CHECK(Contains(buffer, "#EXT-X-PART-INF:PART-TARGET=0.200"));
+	CHECK(Contains(buffer, "CAN-BLOCK-RELOAD=YES"));
+	string line("#EXT-X-PART:DURATION=0.200,URI=\"");
+	CHECK(Contains(buffer, Segment::WritePartName("live", current, 0, line).append(".ts\",INDEPENDENT=YES").c_str()));
+	line.assign("#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"");
+	CHECK(Contains(buffer, Segment::WritePartName("live", current, 2, line).append(".ts\"").c_str()));
+
+	// blocking reload
+	UInt32 wakes = 0;
+	shared<Segments::Waiter> pWaiter(SET, [&](const Segments& segments) {
+		++wakes;
+		return segments.has(current, 3);
+	});
+	segments.wait(pWaiter);
+	WriteVideo(segments, frame, 5); // part 2
+	CHECK(wakes == 1);
+	WriteVideo(segments, frame, 5); // part 3
+	CHECK(wakes == 2);
+	WriteVideo(segments, frame, 5);
+	CHECK(wakes == 2);
+
+	// released waiter
+	pWaiter.set([&](const Segments& segments) {
+		++wakes;
+		return false;
+	});
+	segments.wait(pWaiter);
+	pWaiter.reset();
+	WriteVideo(segments, frame, 5);
+	CHECK(wakes == 2);
+
+	// end of media wakes up waiters
+	bool ended = false;
+	pWaiter.set([&](const Segments& segments) { return ended = segments.has(current + 10); });
+	segments.wait(pWaiter);
+	segments.endMedia();
+	CHECK(ended);
+	M3U8::Write(segments.to(playlist), buffer.clear());
+	CHECK(!playlist.partDuration && Contains(buffer, "#EXT-X-ENDLIST") && !Contains(buffer, "#EXT-X-PRELOAD-HINT"));
+}
+
+
+ADD_TEST(CMAF) {
+	string name;
+	CHECK(Segment::ReadInitName(Segment::WriteInitName("live", name)) == 4 && name == "live.init");
+	CHECK(Segment::ReadInitName("live.12~3") == string::npos);
+
+	Segments segments(4);
+	UInt32 frame = 0;
+	WriteVideo(segments, frame, 3 * 50 + 1);
+	CHECK(segments.count() == 3);
+
+	Playlist playlist(Path("live.mp4"));
+	Buffer buffer;
+	M3U8::Write(segments.to(playlist), buffer);
+	CHECK(Contains(buffer, "#EXT-X-VERSION:6") && Contains(buffer, "#EXT-X-MAP:URI=\"live.init.mp4\""));
+	// not a CMAF format
+	M3U8::Write(Playlist(Path("live.ts")), buffer.clear());
+	CHECK(!Contains(buffer, "#EXT-X-MAP"));
+
+	// DASH manifest on the same segments
+	MPD::Write(segments.to(playlist), buffer.clear());
+	CHECK(Contains(buffer, "type=\"dynamic\"") && Contains(buffer, "<Initialization sourceURL=\"live.init.mp4\"/>"));
+	CHECK(Contains(buffer, "<S t=\"0\" d=\"2000\"/>") && Contains(buffer, "<S t=\"4000\" d=\"2000\"/>"));
+	string url("<SegmentURL media=\"");
+	CHECK(Contains(buffer, Segment::WriteName("live", segments.sequence() + 2, 2000, url).append(".mp4\"/>").c_str()));
+
+	segments.endMedia();
+	MPD::Write(segments.to(playlist), buffer.clear());
+	CHECK(Contains(buffer, "type=\"static\"") && !Contains(buffer, "publishTime"));
+}
+
+ADD_TEST(InitCache) {
+	Segments segments(4);
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	tag.frame = Media::Video::FRAME_CONFIG;
+	segments.writeVideo(1, tag, Packet(EXPAND("config")));
+	UInt32 frame = 0;
+	WriteVideo(segments, frame, 50 + 1);
+	CHECK(segments.count() == 1);
+	shared<Segment::Muxed> pInit(SET);
+	segments.initSegment().setMuxed("mp4", pInit);
+
+	// same config rewritten on every segment, init cache kept
+	WriteVideo(segments, frame, 50);
+	CHECK(segments.count() == 2 && segments.initSegment().muxed("mp4") == pInit);
+	// new config, init cache renewed just when the first segment carrying it is complete
+	tag.time = frame * 40;
+	segments.writeVideo(1, tag, Packet(EXPAND("config2")));
+	WriteVideo(segments, frame, 50);
+	CHECK(segments.count() == 3 && segments.initSegment().muxed("mp4") == pInit);
+	WriteVideo(segments, frame, 50);
+	CHECK(segments.count() == 4 && !segments.initSegment().muxed("mp4"));
+
+	// audio configs of temporary memory zones released after writing, config changes after the source packet is gone
+	Media::Audio::Tag audio(Media::Audio::CODEC_AAC);
+	audio.isConfig = true;
+	for (const char* value : { "audio1", "audio2" }) {
+		segments.initSegment().setMuxed("mp4", pInit);
+		{
+			Buffer config;
+			config.append(value, 6);
+			audio.time = frame * 40;
+			segments.writeAudio(1, audio, Packet(config.data(), config.size()));
+			memset(config.data(), 0, config.size());
+		}
+		WriteVideo(segments, frame, 50);
+		CHECK(!segments.initSegment().muxed("mp4"));
+		// same config rewritten on next segments
+		pInit.set();
+		segments.initSegment().setMuxed("mp4", pInit);
+		WriteVideo(segments, frame, 100);
+		CHECK(segments.initSegment().muxed("mp4") == pInit);
+	}
+}
+
+
+ADD_TEST(DVR) {
+	Signal signal;
+	Handler handler(signal);
+	IOFile io(handler, _ThreadPool);
+	Exception ex;
+	Path path(FileSystem::GetHome(""), ".MonaTests/live.dvr/");
+	// just block files of a previous ring are removed
+	CHECK(FileSystem::CreateDirectory(ex, path, FileSystem::MODE_HEAVY) && !ex);
+	Path old(path, "0.0.blk"), other(path, "other.txt");
+	CHECK(File(old, File::MODE_WRITE).create(ex) && File(other, File::MODE_WRITE).create(ex) && !ex);
+	{
+		Segments segments(2);
+		CHECK(segments.setDVR(io, path, 20) && segments.dvr() && !old.exists(true) && other.exists(true));
+		UInt32 frame = 0;
+		WriteVideo(segments, frame, 8 * 50 + 1); // 8 segments of 2 seconds
+		const DVR& dvr = *segments.dvr();
+		CHECK(dvr.sequence() == 0 && dvr.count() == 8 && dvr.duration() == 16000);
+		CHECK(segments.sequence() == 6 && segments.count() == 2);
+
+		// segments written asynchronously by IOFile
+		io.join();
+		UInt64 size = 0;
+		FileSystem::ListFiles(ex, path, [&size](const string& file, UInt16 level) {
+			if (file.compare(file.size() - 4, 4, ".blk") == 0)
+				size += Path(file).size(true);
+			return true;
+		});
+		CHECK(size == dvr.size());
+
+		// old segment read from the DVR, medias reference the mapped block (zero-copy)
+		Segment segment = segments(1);
+		CHECK(segment && segment.time() == 2000 && segment.duration() == 2000 && segment.count() == 50);
+		shared<const Segment::Muxed> pMuxed(SET);
+		segment.setMuxed("ts", pMuxed);
+		Segment cached = segments(1);
+		CHECK(cached.count() == 50 && cached.muxed("ts") == pMuxed); // same cached segment
+		UInt32 time = 2000;
+		for (const shared<const Media::Base>& pMedia : segment) {
+			CHECK(pMedia->type == Media::TYPE_VIDEO && pMedia->time() == time && String::ICompare(STR pMedia->data(), "frame", pMedia->size()) == 0);
+			CHECK(((const Media::Video&)*pMedia).tag.frame == (time % 2000 ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY));
+			time += 40;
+		}
+		CHECK(segments(6).duration() == 2000); // in memory
+
+		// DVR playlist
+		Playlist playlist(Path("live.ts"));
+		segments.to(playlist, 6);
+		CHECK(playlist.sequence == 5 && playlist.count() == 3 && playlist.time == 10000);
+		segments.to(playlist, 0xFFFFFFFF);
+		CHECK(playlist.sequence == 1 && playlist.count() == 7 && playlist.duration() == 14000);
+		segments.to(playlist);
+		CHECK(playlist.sequence == 7 && playlist.count() == 1);
+
+		// retention
+		Segment copy(segment);
+		WriteVideo(segments, frame, 4 * 50);
+		CHECK(dvr.sequence() == 2 && dvr.count() == 10 && dvr.duration() == 20000);
+		CHECK(!segments(1) && segments(2));
+		CHECK(copy.count() == 50 && String::ICompare(STR (*copy.begin())->data(), "frame", 5) == 0); // block always mapped while referenced
+
+		// segment held while more than CACHE_SEGMENTS lookups evict it of the cache
+		io.join();
+		Segment held = dvr(2);
+		held.setMuxed("ts", pMuxed);
+		for (UInt32 sequence = 3; sequence < dvr.sequence() + dvr.count(); ++sequence)
+			CHECK(dvr(sequence).count() == 50);
+		CHECK(dvr.count() - 1 > DVR::CACHE_SEGMENTS && !dvr(2).muxed("ts") && held.muxed("ts") == pMuxed); // read again, held kept its cache
+		time = 4000;
+		for (const shared<const Media::Base>& pMedia : held) {
+			CHECK(pMedia->time() == time && String::ICompare(STR pMedia->data(), "frame", pMedia->size()) == 0);
+			time += 40;
+		}
+		CHECK(time == 6000);
+
+		// end
+		segments.endMedia();
+		segments.to(playlist, 0xFFFFFFFF);
+		CHECK(playlist.sequence == 3 && playlist.durations().back() == 0);
+	}
+	// block files deleted, folder kept for the user file
+	UInt32 count = 0;
+	FileSystem::ListFiles(ex, path, [&count](const string& file, UInt16 level) { ++count; return true; });
+	CHECK(count == 1 && other.exists(true));
+	CHECK(FileSystem::Delete(ex, path, FileSystem::MODE_HEAVY) && !FileSystem::Exists(path));
+}
+
+
+ADD_TEST(PlaylistCache) {
+	Segments segments(4);
+	segments.setPartDuration(200);
+	UInt32 frame = 0;
+	WriteVideo(segments, frame, 2 * 50 + 1);
+	shared<const Segments::Playlists> pPlaylists = segments.playlists();
+	CHECK(pPlaylists == segments.playlists() && !pPlaylists->get("m3u8.ts.0"));
+	shared<Buffer> pBuffer(SET);
+	Playlist playlist(Path("live.ts"));
+	M3U8::Write(segments.to(playlist), *pBuffer);
+	Packet rendered(pBuffer);
+	pPlaylists->set("m3u8.ts.0", rendered);
+	Packet cached(pPlaylists->get("m3u8.ts.0"));
+	CHECK(cached.data() == rendered.data() && cached.size() == rendered.size());
+
+	// no change, same playlists
+	WriteVideo(segments, frame, 1);
+	CHECK(pPlaylists == segments.playlists());
+	// new part
+	WriteVideo(segments, frame, 5);
+	shared<const Segments::Playlists> pPartPlaylists = segments.playlists();
+	CHECK(pPartPlaylists != pPlaylists && pPartPlaylists->etag != pPlaylists->etag && !pPartPlaylists->get("m3u8.ts.0"));
+	// new segment
+	WriteVideo(segments, frame, 50);
+	CHECK(segments.playlists()->etag != pPartPlaylists->etag);
+	// end
+	pPlaylists = segments.playlists();
+	segments.endMedia();
+	CHECK(segments.playlists()->etag != pPlaylists->etag);
+}
+
+
+ADD_TEST(Master) {
+	// renditions started at different times, aligned on the same segments
+	Segments high(8), low(8);
+	for (Segments* pSegments : { &high, &low }) {
+		pSegments->setMaxDuration(4000);
+		CHECK(pSegments->setAligned(true) && pSegments->aligned());
+	}
+	UInt32 frame = 0;
+	WriteVideo(high, frame, 5 * 100 + 1);
+	frame = 30;
+	WriteVideo(low, frame, 5 * 100 + 1 - 30);
+	CHECK(high.count() == 5 && low.count() == 5);
+	CHECK(low(low.sequence()).time() == 1200 && low(low.sequence()).duration() == 2800); // starts at 1.2s, cut on the 4s slot
+	for (Int32 i = 1; i <= 4; ++i)
+		CHECK(high(-i).time() == low(-i).time() && high(-i).duration() == low(-i).duration() && high(-i).duration() == 4000);
+
+	// not aligned, one segment by key frame sequence
+	Segments segments(8);
+	segments.setMaxDuration(4000);
+	frame = 30;
+	WriteVideo(segments, frame, 5 * 100 + 1 - 30);
+	CHECK(segments(-1).duration() == 2000);
+
+	Playlist::Master master(Path("/live/live.m3u8"));
+	Playlist::Master::Item& item = master.items["live_720"];
+	item.bandwidth = 1600000;
+	item.averageBandwidth = 1200000;
+	item.width = 1280;
+	item.height = 720;
+	item.codecs = "avc1.64001F,mp4a.40.2";
+	master.items["live_480"].bandwidth = 800000;
+	Buffer buffer;
+	M3U8::Write(master, buffer);
+	CHECK(Contains(buffer, "#EXT-X-STREAM-INF:BANDWIDTH=1600000,AVERAGE-BANDWIDTH=1200000,RESOLUTION=1280x720,CODECS=\"avc1.64001F,mp4a.40.2\"\n"));
+	CHECK(Contains(buffer, "#EXT-X-STREAM-INF:BANDWIDTH=800000\n"));
+}
+
+}
@@ -0,0 +1,233 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/HTTP/HTTPDecoder.h"
+#include "Mona/HTTP/HTTPSegmentSender.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace HTTPTest {
+
+struct MainHandler : Handler {
+	MainHandler() : Handler(_signal) {}
+private:
+	Signal _signal;
+};
+
+// LL-HLS playlist polling of a browser
+static const char Request[] = "GET /live/stream.m3u8?_HLS_msn=12&_HLS_part=3 HTTP/1.1\r\n"
+	"Host: localhost:8080\r\n"
+	"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+	"Accept: */*\r\n"
+	"Accept-Language: en-US,en;q=0.9\r\n"
+	"Accept-Encoding: gzip, deflate, br\r\n"
+	"Origin: http://localhost\r\n"
+	"Connection: keep-alive\r\n"
+	"Referer: http://localhost/player.html\r\n"
+	"Cookie: session=abc123; theme=dark\r\n"
+	"If-None-Match: \"5f3e\"\r\n"
+	"Range: bytes=0-\r\n"
+	"X-Empty:   \r\n"
+	"  X-Spaces \t:  value with spaces \t \r\n"
+	"X-Alone\r\n"
+	"\r\n";
+
+static void Decode(Socket::Decoder& decoder, const char* data, UInt32 size, const shared<Socket>& pSocket) {
+	shared<Buffer> pBuffer(SET, data, size);
+	decoder.decode(pBuffer, pSocket->peerAddress(), pSocket);
+}
+
+static void Check(HTTP::Request& request) {
+	CHECK(!request.ex && request->type == HTTP::TYPE_GET && request.file.name() == "stream.m3u8" && request->query == "?_HLS_msn=12&_HLS_part=3");
+	CHECK(request->version == 1.1f && request->host == "localhost:8080" && strcmp(request->origin, "http://localhost") == 0);
+	CHECK(request->connection == HTTP::CONNECTION_KEEPALIVE && strcmp(request->ifNoneMatch, "\"5f3e\"") == 0 && strcmp(request->range, "0-") == 0);
+	CHECK(!request->contentLength && !request->progressive);
+	// parameters built on demand, first access can be a writing
+	request.setString("custom", "value");
+	CHECK(request.count() == 19 && strcmp(request.getString("custom"), "value") == 0);
+	CHECK(strcmp(request.getString("type"), "GET") == 0 && strcmp(request.getString("version"), "1.1") == 0);
+	CHECK(strcmp(request.getString("user-agent"), "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36") == 0);
+	CHECK(strcmp(request.getString("x-spaces"), "value with spaces") == 0 && strcmp(request.getString("x-empty", "?"), "") == 0 && strcmp(request.getString("x-alone", "?"), "") == 0);
+	CHECK(strcmp(request.getString("session"), "abc123") == 0 && strcmp(request.getString("theme"), "dark") == 0);
+}
+
+ADD_TEST(Header) {
+	MainHandler handler;
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	shared<const HTTP::Header> pHeader;
+	UInt32 requests(0);
+	{
+		HTTPDecoder decoder(handler, "www");
+		decoder.onRequest = [&](HTTP::Request& request) {
+			Check(request);
+			pHeader = request;
+			++requests;
+		};
+		// same request whatever the fragmentation
+		UInt32 size(sizeof(Request) - 1);
+		for (UInt32 split = 0; split <= size; ++split) {
+			Decode(decoder, Request, split, pSocket);
+			Decode(decoder, Request + split, size - split, pSocket);
+			handler.flush();
+		}
+		for (UInt32 i = 0; i < size; ++i)
+			Decode(decoder, Request + i, 1, pSocket);
+		// pipelined
+		string pipelined;
+		for (UInt32 i = 0; i < 3; ++i)
+			pipelined.append(Request, size);
+		Decode(decoder, pipelined.data(), pipelined.size(), pSocket);
+		handler.flush();
+		CHECK(requests == size + 5);
+	}
+	// header hold its fields after the decoding
+	CHECK(pHeader.unique() && pHeader->host == "localhost:8080" && strcmp(pHeader->ifNoneMatch, "\"5f3e\"") == 0 && strcmp(pHeader->getString("accept-language"), "en-US,en;q=0.9") == 0);
+
+	// chunked, no content-length
+	HTTPDecoder decoder(handler, "www");
+	decoder.onRequest = [&](HTTP::Request& request) {
+		if (!request)
+			return; // progressive content
+		CHECK(request->type == HTTP::TYPE_POST && request->chunked && !request->contentLength && request.size() == 5);
+		CHECK(!request.hasKey("content-length") && strcmp(request.getString("transfer-encoding"), "gzip, chunked") == 0);
+		++requests;
+	};
+	static const char Chunked[] = "POST /live/log.txt HTTP/1.1\r\nContent-Length: 10\r\nTransfer-Encoding: gzip, chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n";
+	Decode(decoder, Chunked, sizeof(Chunked) - 1, pSocket);
+	handler.flush();
+	CHECK(requests == sizeof(Request) + 5);
+}
+
+ADD_TEST(HeaderLimit) {
+	MainHandler handler;
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	HTTPDecoder decoder(handler, "www");
+	UInt32 errors(0);
+	decoder.onRequest = [&](HTTP::Request& request) {
+		CHECK(request.ex);
+		++errors;
+	};
+	// a lot of small fields, received line by line
+	static const char Line[] = "X-Field: 0123456789\r\n";
+	static const char Start[] = "GET /live/ HTTP/1.1\r\n";
+	Decode(decoder, Start, sizeof(Start) - 1, pSocket);
+	for (UInt32 i = 0; i < 1000; ++i)
+		Decode(decoder, Line, sizeof(Line) - 1, pSocket);
+	handler.flush();
+	CHECK(errors == 1);
+}
+
+ADD_TEST(RequestCost) {
+	MainHandler handler;
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	HTTPDecoder decoder(handler, "www");
+	bool properties;
+	UInt32 requests;
+	decoder.onRequest = [&](HTTP::Request& request) {
+		if (properties) // as copied to client properties for scripting
+			requests += request.count() ? 1 : 0;
+		else
+			requests += request->host.empty() ? 0 : 1;
+	};
+	for (bool withProperties : { false, true }) {
+		properties = withProperties;
+		requests = 0;
+		Stopwatch chrono;
+		chrono.start();
+		for (UInt32 i = 0; i < 20000; ++i) {
+			Decode(decoder, Request, sizeof(Request) - 1, pSocket);
+			if (!(i % 100))
+				handler.flush();
+		}
+		handler.flush();
+		chrono.stop();
+		CHECK(requests == 20000);
+		DEBUG("HTTP request decoding", properties ? " with properties" : "", ", ", requests * 1000 / (chrono.elapsed() ? chrono.elapsed() : 1), " requests/s");
+	}
+}
+
+// Socket which keeps the response written
+struct OutputSocket : Socket {
+	OutputSocket() : Socket(TYPE_STREAM) {}
+	Buffer	output;
+private:
+	int sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags) {
+		output.append(data, size);
+		return size;
+	}
+	int sendPackets(Exception& ex, const deque<Packet>& packets, int flags) {
+		UInt32 size(0);
+		for (const Packet& packet : packets) {
+			output.append(packet.data(), packet.size());
+			size += packet.size();
+		}
+		return size;
+	}
+};
+
+ADD_TEST(SegmentCache) {
+	MainHandler handler;
+	shared<Socket> pSocket(SET, Socket::TYPE_STREAM);
+	shared<const HTTP::Header> pHeader;
+	HTTPDecoder decoder(handler, "www");
+	decoder.onRequest = [&](HTTP::Request& request) { pHeader = request; };
+	static const char Get[] = "GET /live/test.ts HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	Decode(decoder, Get, sizeof(Get) - 1, pSocket);
+	handler.flush();
+	CHECK(pHeader);
+
+	Segment segment;
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	for (tag.time = 0; tag.time < 1000; tag.time += 40) {
+		tag.frame = tag.time ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		segment.add<Media::Video>(tag, Packet(EXPAND("\x00\x00\x00\x01\x65" "frame")));
+	}
+	CHECK(segment.count() == 25);
+
+	// first request muxes the segment (chunked), next requests send the muxed cache with a Content-Length
+	string bodies[2];
+	for (string& body : bodies) {
+		shared<OutputSocket> pOutput(SET);
+		Parameters params;
+		HTTPSegmentSender sender(pHeader, pOutput, Path("test.ts"), segment, params);
+		((Runner&)sender).run("HTTPTest");
+		string response(STR pOutput->output.data(), pOutput->output.size());
+		size_t content = response.find("\r\n\r\n");
+		CHECK(response.compare(0, 12, "HTTP/1.1 200") == 0 && content != string::npos);
+		string header(response, 0, content);
+		content += 4;
+		if (&body == bodies) {
+			CHECK(header.find("Transfer-Encoding: chunked") != string::npos);
+			// dechunk: [size]\r\n[data]\r\n, ends with a 0 size
+			UInt32 size;
+			size_t line;
+			while ((line = response.find("\r\n", content)) != string::npos && String::ToNumber(response.data() + content, line - content, size, BASE_16) && size) {
+				body.append(response, line + 2, size);
+				content = line + 4 + size;
+			}
+		} else {
+			body.assign(response, content, string::npos);
+			CHECK(header.find(String("Content-Length: ", body.size())) != string::npos);
+		}
+	}
+	CHECK(!bodies[0].empty() && (bodies[0].size() % 188) == 0 && bodies[0] == bodies[1]);
+}
+
+}
@@ -0,0 +1,156 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/JSONReader.h"
+#include "Mona/Util.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace JSONTest {
+
+// writes every call, with array sizes
+struct Events : DataWriter, virtual Object {
+	UInt64 beginObject(const char* type = NULL) { events.append("{").append(type ? type : ""); return 0; }
+	void   writePropertyName(const char* value) { events.append(" ").append(value).append(":"); }
+	void   endObject() { events.append("}"); }
+	UInt64 beginArray(UInt32 size) { String::Append(events, "[", size); return 0; }
+	void   endArray() { events.append("]"); }
+	void   writeNumber(double value) { String::Append(events, " ", value); }
+	void   writeString(const char* value, UInt32 size) { events.append(" \"").append(value, size).append("\""); }
+	void   writeBoolean(bool value) { String::Append(events, " ", value); }
+	void   writeNull() { events.append(" null"); }
+	UInt64 writeDate(const Date& date) { String::Append(events, " ", date.time()); return 0; }
+	UInt64 writeByte(const Packet& bytes) { String::Append(events, " bin", bytes.size()); return 0; }
+	string events;
+};
+
+static string Read(const string& json, bool indexed) {
+	UInt32 indexSize(JSONReader::IndexSize);
+	JSONReader::IndexSize = indexed ? 0 : 0xFFFFFFFF;
+	Events writer;
+	JSONReader(Packet(json.data(), json.size())).read(writer);
+	JSONReader::IndexSize = indexSize;
+	return writer.events;
+}
+
+static void Generate(string& json, UInt8 depth = 0) {
+	json.append(Util::Random<UInt8>() % 3, ' ');
+	switch (Util::Random<UInt8>() % (depth < 5 ? 7 : 5)) {
+		case 0:
+			String::Append(json, Util::Random<Int32>() / 7.0);
+			break;
+		case 1: {
+			static const char* Escapes[] = { "\\\"", "\\\\", "\\n", "\\u00e9", "\\\\\\\"", "]},:[{", " " };
+			json += '"';
+			UInt8 size(Util::Random<UInt8>() % 100);
+			while (size--) {
+				if (Util::Random<UInt8>() % 5)
+					json += char('a' + Util::Random<UInt8>() % 26);
+				else
+					json.append(Escapes[Util::Random<UInt8>() % 7]);
+			}
+			json += '"';
+			break;
+		}
+		case 2:
+			json.append(Util::Random<UInt8>() % 2 ? "true" : "null");
+			break;
+		case 3:
+			json.append("false");
+			break;
+		case 4:
+			json.append("\"2017-08-24T12:00:00Z\"");
+			break;
+		case 5: {
+			json += '[';
+			UInt8 count(Util::Random<UInt8>() % 8);
+			for (UInt8 i = 0; i < count; ++i) {
+				if (i)
+					json += ',';
+				Generate(json, depth + 1);
+			}
+			json += ']';
+			break;
+		}
+		default: {
+			json += '{';
+			UInt8 count(Util::Random<UInt8>() % 8);
+			for (UInt8 i = 0; i < count; ++i) {
+				if (i)
+					json += ',';
+				String::Append(json, "\"key", i, "\":");
+				Generate(json, depth + 1);
+			}
+			json += '}';
+		}
+	}
+	json.append(Util::Random<UInt8>() % 3, '\n');
+}
+
+ADD_TEST(Structurals) {
+	CHECK(Read(R"({"a":[1,[2,3],"x\\\"]",{"b":[]},true],"c":"\\\\","d":[ ]})", true) == R"({ a:[5 1[2 2 3] "x\\\"]"{ b:[0]} true] c: "\\\\" d:[0]})");
+	CHECK(Read(R"([1,"a,b",[null,[]],{"__type":"T","v":"}"}])", true) == R"( 1 "a,b"[2 null[0]]{T v: "}"})");
+}
+
+ADD_TEST(Conformance) {
+	// indexed and scalar parsing give the same result, including malformed JSON
+	static const char* Malformed[] = {
+		"[1,,2]", "{\"a\":1,}", "[1,]", "{\"a\":\"b}", "[[1,2]", "{\"a\":[1}]}", "[\"a\" \"b\"]",
+		"{,\"a\":1}", "[:1]", "[1 2]", "{\"a\" 1}", "[\"\\\"]", "{\"a\":[,]}", "[{\"a\":1}}]"
+	};
+	for (const char* json : Malformed)
+		CHECK(Read(json, true) == Read(json, false));
+	for (UInt32 i = 0; i < 500; ++i) {
+		string json;
+		Generate(json);
+		CHECK(Read(json, true) == Read(json, false));
+		// truncated
+		json.resize(json.size() / 2);
+		CHECK(Read(json, true) == Read(json, false));
+	}
+}
+
+static void GenerateUsers(string& json, UInt32 size) {
+	json.assign("[");
+	for (UInt32 i = 0; json.size() < size; ++i) {
+		if (i)
+			json += ',';
+		String::Append(json, R"({"id":)", i, R"(,"name":"user )", i, R"(","tags":["a","b","c"],"scores":[)", i, ",", i * 2.5, R"(,3],"profile":{"active":true,"bio":"Lorem ipsum dolor sit amet, consectetur adipiscing elit \"quoted\""}})");
+	}
+	json += ']';
+}
+
+ADD_TEST(ReadCost) {
+	string json;
+	GenerateUsers(json, 0x100000);
+	for (bool indexed : { false, true }) {
+		UInt32 indexSize(JSONReader::IndexSize);
+		JSONReader::IndexSize = indexed ? 0 : 0xFFFFFFFF;
+		Stopwatch chrono;
+		chrono.start();
+		for (UInt32 i = 0; i < 10; ++i)
+			JSONReader(Packet(json.data(), json.size())).read(DataWriter::Null());
+		chrono.stop();
+		JSONReader::IndexSize = indexSize;
+		DEBUG("JSON reading ", indexed ? "indexed" : "scalar", ", ", json.size() * 10 / (chrono.elapsed() ? chrono.elapsed() : 1) / 1000, "MB/s");
+	}
+}
+
+}
@@ -0,0 +1,220 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/MP4Reader.h"
+#include "Mona/MP4Writer.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace MP4Test {
+
+// 100 H264 frames of 40ms, one key frame every second, 5 frames by chunk
+static const UInt32 Frames(100);
+static const UInt32 FramesByChunk(5);
+static const UInt32 FrameSize(10);
+
+struct Source : Media::Source, virtual Object {
+	void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) {}
+	void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) {
+		if (tag.frame != Media::Video::FRAME_CONFIG)
+			videos.emplace_back(tag.time, tag.frame);
+	}
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) {}
+	void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) {}
+	void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) {}
+	void flush() {}
+	void reset() {}
+
+	vector<pair<UInt32, Media::Video::Frame>> videos;
+};
+
+static BinaryWriter& BeginBox(BinaryWriter& writer, const char* name, UInt32& position) {
+	position = writer.size();
+	return writer.write32(0).write(name, 4);
+}
+static BinaryWriter& EndBox(BinaryWriter& writer, UInt32 position) {
+	BinaryWriter(BIN writer.data() + position, 4).write32(writer.size() - position);
+	return writer;
+}
+
+static void WriteMoov(BinaryWriter& writer, UInt32 mdat) {
+	UInt32 moov, trak, mdia, minf, stbl, box;
+	BeginBox(writer, "moov", moov);
+	BeginBox(writer, "trak", trak);
+	BeginBox(writer, "mdia", mdia);
+	BeginBox(writer, "mdhd", box).write32(0).write32(0).write32(0).write32(1000).write32(Frames * 40).write16(0x55C4).write16(0);
+	EndBox(writer, box);
+	BeginBox(writer, "minf", minf);
+	BeginBox(writer, "stbl", stbl);
+	BeginBox(writer, "stsd", box).write32(0).write32(1);
+	writer.write32(86).write(EXPAND("avc1")).append(78, 0); // video sample entry without avcC
+	EndBox(writer, box);
+	BeginBox(writer, "stts", box).write32(0).write32(1).write32(Frames).write32(40);
+	EndBox(writer, box);
+	BeginBox(writer, "stss", box).write32(0).write32(Frames / 25);
+	for (UInt32 key = 1; key <= Frames; key += 25)
+		writer.write32(key);
+	EndBox(writer, box);
+	BeginBox(writer, "stsc", box).write32(0).write32(1).write32(1).write32(FramesByChunk).write32(1);
+	EndBox(writer, box);
+	BeginBox(writer, "stsz", box).write32(0).write32(FrameSize).write32(Frames);
+	EndBox(writer, box);
+	BeginBox(writer, "stco", box).write32(0).write32(Frames / FramesByChunk);
+	for (UInt32 chunk = 0; chunk < Frames / FramesByChunk; ++chunk)
+		writer.write32(mdat + 8 + chunk * FramesByChunk * FrameSize);
+	EndBox(writer, box);
+	EndBox(writer, stbl);
+	EndBox(writer, minf);
+	EndBox(writer, mdia);
+	EndBox(writer, trak);
+	EndBox(writer, moov);
+}
+
+static void WriteMdat(BinaryWriter& writer) {
+	UInt32 mdat;
+	BeginBox(writer, "mdat", mdat);
+	for (UInt32 frame = 0; frame < Frames; ++frame)
+		writer.write32(6).write8((frame % 25) ? 0x41 : 0x65).write(EXPAND("frame"));
+	EndBox(writer, mdat);
+}
+
+static bool Find(const Packet& packet, const char* box, UInt32& position) {
+	for (position = 4; (position + 4) <= packet.size(); ++position) {
+		if (memcmp(packet.data() + position, box, 4) == 0)
+			return true;
+	}
+	return false;
+}
+
+// write 25fps H264 frames from time during duration, returns mfhd sequences of the fragments,
+// init is true if the init part (ftyp+moov) is written in a separated packet
+static vector<UInt32> WriteFragments(MP4Writer& writer, UInt32 time, UInt32 duration, bool& init) {
+	vector<UInt32> sequences;
+	MediaWriter::OnWrite onWrite([&](const Packet& packet) {
+		UInt32 position;
+		if (MP4Writer::IsInit(packet))
+			init = !Find(packet, "moof", position);
+		if ((MP4Writer::IsInit(packet) || (packet.size() >= 8 && memcmp(packet.data() + 4, EXPAND("moof")) == 0)) && Find(packet, "mfhd", position))
+			sequences.emplace_back(BinaryReader(packet.data() + position + 8, 4).read32());
+	});
+	static const Packet Frame(EXPAND("\x00\x00\x00\x01\x65" "frame"));
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	writer.beginMedia(onWrite);
+	for (UInt32 end = time + duration; time < end; time += 40) {
+		tag.time = time;
+		tag.frame = (time % 1000) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		writer.writeVideo(1, tag, Frame, onWrite);
+	}
+	writer.endMedia(onWrite);
+	return sequences;
+}
+
+static Buffer& WriteFile(Buffer& buffer, bool faststart) {
+	BinaryWriter writer(buffer);
+	writer.write32(16).write(EXPAND("ftypisom")).write32(0);
+	if (faststart) {
+		// size of moov to get mdat position
+		Buffer moov;
+		BinaryWriter writerMoov(moov);
+		WriteMoov(writerMoov, 0);
+		WriteMoov(writer, writer.size() + moov.size());
+		WriteMdat(writer);
+	} else {
+		UInt32 mdat = writer.size();
+		WriteMdat(writer);
+		WriteMoov(writer, mdat);
+	}
+	return buffer;
+}
+
+// feed the reader as MediaFile::Reader, returns bytes readen
+static UInt64 Read(Source& source, const Buffer& file, UInt32 start = 0, bool seekable = true) {
+	MP4Reader reader;
+	Parameters parameters;
+	if (start)
+		parameters.setNumber("start", start);
+	reader.setParams(parameters);
+	reader.seekable = seekable;
+	UInt64 position = 0, readen = 0;
+	while (position < file.size()) {
+		UInt32 size = UInt32(min(file.size() - position, UInt64(64)));
+		reader.read(Packet(file.data() + position, size), source);
+		readen += size;
+		position += size;
+		reader.seeking(position);
+	}
+	reader.flush(source);
+	return readen;
+}
+
+ADD_TEST(Faststart) {
+	Buffer file;
+	Source source;
+	CHECK(Read(source, WriteFile(file, true)) == file.size());
+	CHECK(source.videos.size() == Frames && source.videos.front() == make_pair(0u, Media::Video::FRAME_KEY) && source.videos.back().first == (Frames - 1) * 40);
+	// start on key frame
+	source.videos.clear();
+	CHECK(Read(source, file, 2100) < file.size());
+	CHECK(source.videos.size() == 50 && source.videos.front() == make_pair(2000u, Media::Video::FRAME_KEY));
+	source.videos.clear();
+	Read(source, file, 1900);
+	CHECK(source.videos.size() == 75 && source.videos.front() == make_pair(1000u, Media::Video::FRAME_KEY));
+}
+
+ADD_TEST(MoovAtEnd) {
+	Buffer file;
+	Source source;
+	WriteFile(file, false);
+	// without random access, unsupported
+	Read(source, file, 0, false);
+	CHECK(source.videos.empty());
+	// moov read at the end, then mdat
+	CHECK(Read(source, file) > file.size());
+	CHECK(source.videos.size() == Frames && source.videos.front() == make_pair(0u, Media::Video::FRAME_KEY));
+	for (UInt32 i = 0; i < Frames; ++i)
+		CHECK(source.videos[i].first == i * 40 && source.videos[i].second == ((i % 25) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY));
+	// start on key frame, just the tail of mdat is readen
+	source.videos.clear();
+	CHECK(Read(source, file, 3500) < file.size());
+	CHECK(source.videos.size() == 25 && source.videos.front() == make_pair(3000u, Media::Video::FRAME_KEY));
+}
+
+ADD_TEST(CMAF) {
+	bool init = false;
+	// CMAF segments muxed separately, init part apart and fragment sequences increasing through the segments
+	MP4Writer first;
+	first.setEndTime(2000);
+	vector<UInt32> sequences = WriteFragments(first, 0, 2000, init);
+	CHECK(init && !sequences.empty());
+	MP4Writer second;
+	second.setEndTime(4000);
+	vector<UInt32> nexts = WriteFragments(second, 2000, 2000, init);
+	CHECK(init && !nexts.empty());
+	sequences.insert(sequences.end(), nexts.begin(), nexts.end());
+	for (UInt32 i = 1; i < sequences.size(); ++i)
+		CHECK(sequences[i] > sequences[i - 1]);
+
+	// not CMAF, one header packet with init part and first fragment
+	MP4Writer writer;
+	sequences = WriteFragments(writer, 2000, 2000, init);
+	CHECK(!init && !sequences.empty() && sequences.front() == 1);
+}
+
+}
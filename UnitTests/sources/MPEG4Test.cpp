@@ -0,0 +1,300 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/NALNetReader.h"
+#include "Mona/AVC.h"
+#include "Mona/HEVC.h"
+#include "Mona/Util.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace MPEG4Test {
+
+static const UInt32 Frames(200);
+
+// byte-by-byte search, reference to compare
+static const UInt8* FindStartCode(const UInt8* data, const UInt8* end, UInt8 zeros) {
+	for (const UInt8* cur = data; cur < end; ++cur) {
+		if (*cur == 1 && zeros >= 2)
+			return cur;
+		zeros = *cur ? 0 : zeros + 1;
+	}
+	return end;
+}
+
+struct Source : Media::Source, virtual Object {
+	void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) {}
+	void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) {
+		frames.emplace_back(tag.frame, string(STR packet.data(), packet.size()));
+	}
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) {}
+	void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) {}
+	void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) {}
+	void flush() {}
+	void reset() {}
+
+	vector<pair<Media::Video::Frame, string>> frames;
+};
+
+// Annex-B stream, SPS + PPS then frames prefixed by an AUD, with start codes of 3 and 4 bytes
+static void WriteStream(Buffer& stream, Source& expected) {
+	BinaryWriter writer(stream);
+	expected.frames.emplace_back(Media::Video::FRAME_CONFIG, string(EXPAND("\0\0\0\2\7\x42\0\0\0\2\x08\xCE")));
+	writer.write32(1).write8(AVC::NAL_SPS).write8(0x42).write24(1).write8(AVC::NAL_PPS).write8(0xCE);
+	for (UInt32 frame = 0; frame < Frames; ++frame) {
+		writer.write32(1).write8(AVC::NAL_AUD).write8(0xF0);
+		Buffer nal(1 + Util::Random<UInt16>() % 3000);
+		nal.data()[0] = (frame % 25) ? AVC::NAL_SLICE_NIDR : AVC::NAL_SLICE_IDR;
+		// content without start code emulation, but with zeros and ones
+		for (UInt32 i = 1; i < nal.size(); ++i)
+			nal.data()[i] = (i % 3) ? (Util::Random<UInt8>() | 2) : (i % 2);
+		nal.data()[nal.size() - 1] |= 2; // no trailing zero
+		(frame % 2) ? writer.write24(1) : writer.write32(1);
+		writer.write(nal.data(), nal.size());
+		Buffer reference;
+		BinaryWriter(reference).write32(nal.size()).write(nal.data(), nal.size());
+		expected.frames.emplace_back((frame % 25) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY, string(STR reference.data(), reference.size()));
+	}
+}
+
+static void Parse(const Buffer& stream, UInt32 step, Source& source) {
+	NALNetReader<AVC> reader;
+	for (UInt32 position = 0; position < stream.size(); position += step)
+		reader.read(Packet(stream.data() + position, min(step, stream.size() - position)), source);
+	reader.flush(source);
+}
+
+ADD_TEST(FindStartCode) {
+	Buffer buffer(0x10000);
+	// random data made of many zeros and ones
+	for (UInt32 i = 0; i < buffer.size(); ++i)
+		buffer.data()[i] = Util::Random<UInt8>() % 4 ? Util::Random<UInt8>() % 3 : Util::Random<UInt8>();
+	const UInt8* end(buffer.data() + buffer.size());
+	for (UInt8 zeros = 0; zeros < 4; ++zeros) {
+		for (UInt32 offset = 0; offset < 64; ++offset) { // unaligned
+			const UInt8* cur(buffer.data() + offset);
+			while (cur < end) {
+				const UInt8* next(MPEG4::FindStartCode(cur, end, zeros));
+				CHECK(next == FindStartCode(cur, end, zeros));
+				cur = next + 1;
+			}
+		}
+	}
+	// start code astride the previous data and at the end
+	const UInt8 data[] = { 0, 1 };
+	CHECK(MPEG4::FindStartCode(data + 1, data + 2, 2) == data + 1);
+	CHECK(MPEG4::FindStartCode(data, data + 2, 1) == data + 1);
+	CHECK(MPEG4::FindStartCode(data, data + 2, 0) == data + 2);
+	memset(buffer.data(), 0, buffer.size());
+	CHECK(MPEG4::FindStartCode(buffer.data(), end, 3) == end);
+	buffer.data()[buffer.size() - 1] = 1;
+	CHECK(MPEG4::FindStartCode(buffer.data(), end) == end - 1);
+}
+
+ADD_TEST(NALNetReader) {
+	Buffer stream;
+	Source expected;
+	WriteStream(stream, expected);
+	// same NAL units whatever the fragmentation of the stream
+	for (UInt32 step : { 1u, 2u, 3u, 5u, 11u, 188u, 1316u, stream.size() }) {
+		Source source;
+		Parse(stream, step, source);
+		CHECK(source.frames.size() == expected.frames.size());
+		// config is flushed as soon as PPS begins, complete just if PPS is not fragmented
+		CHECK(source.frames[0].first == Media::Video::FRAME_CONFIG && (step < 11 || source.frames[0] == expected.frames[0]));
+		for (UInt32 i = 1; i < expected.frames.size(); ++i)
+			CHECK(source.frames[i] == expected.frames[i]);
+	}
+}
+
+ADD_TEST(NALNetReaderCost) {
+	Buffer stream;
+	Source expected;
+	WriteStream(stream, expected);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 20; ++i) {
+		Source source;
+		Parse(stream, 1316, source); // as 7 TS packets by UDP datagram
+	}
+	chrono.stop();
+	DEBUG("NALNetReader parsing, ", stream.size() * 20 / (chrono.elapsed() ? chrono.elapsed() : 1) / 1000, "MB/s");
+}
+
+// bits writer of RBSP, with emulation prevention bytes
+struct Bits : virtual Object {
+	void write(UInt32 value, UInt8 count) {
+		while (count--)
+			_bits.push_back((value >> count) & 1);
+	}
+	void writeUE(UInt32 value) {
+		UInt8 count(0);
+		for (UInt32 code = value + 1; code; code >>= 1)
+			++count;
+		write(0, count - 1);
+		write(value + 1, count);
+	}
+	void writeSE(Int32 value) { writeUE(value > 0 ? value * 2 - 1 : -value * 2); }
+	Buffer& flush(Buffer& buffer) {
+		_bits.push_back(1); // rbsp_stop_one_bit
+		while (_bits.size() % 8)
+			_bits.push_back(0);
+		UInt8 zeros(0);
+		for (size_t i = 0; i < _bits.size(); i += 8) {
+			UInt8 byte(0);
+			for (size_t j = 0; j < 8; ++j)
+				byte = (byte << 1) | (_bits[i + j] ? 1 : 0);
+			if (zeros >= 2 && byte <= 3) {
+				buffer.append(1, 3);
+				zeros = 0;
+			}
+			buffer.append(&byte, 1);
+			zeros = byte ? 0 : (zeros + 1);
+		}
+		_bits.clear();
+		return buffer;
+	}
+private:
+	vector<bool> _bits;
+};
+
+static Buffer& WriteSPS(Buffer& sps, UInt8 profile, UInt16 width, UInt16 height, bool progressive = true) {
+	Bits bits;
+	bits.write(0x67, 8);
+	bits.write(profile, 8);
+	bits.write(0, 8); // constraints
+	bits.write(40, 8); // level
+	bits.writeUE(0); // seq_parameter_set_id
+	if (profile == 100) {
+		bits.writeUE(1); // chroma_format_idc 4:2:0
+		bits.writeUE(0); // bit_depth_luma_minus8
+		bits.writeUE(0); // bit_depth_chroma_minus8
+		bits.write(0, 1); // qpprime_y_zero_transform_bypass_flag
+		bits.write(1, 1); // seq_scaling_matrix_present_flag
+		for (UInt8 i = 0; i < 8; ++i) {
+			bits.write(i ? 0 : 1, 1);
+			for (UInt8 j = 0; !i && j < 16; ++j)
+				bits.writeSE((j % 2) ? -3 : 5);
+		}
+	}
+	bits.writeUE(0); // log2_max_frame_num_minus4
+	UInt8 picOrderCntType(profile == 66 ? 2 : (profile == 77 ? 1 : 0));
+	bits.writeUE(picOrderCntType);
+	if (!picOrderCntType)
+		bits.writeUE(2); // log2_max_pic_order_cnt_lsb_minus4
+	else if (picOrderCntType == 1) {
+		bits.write(0, 1); // delta_pic_order_always_zero_flag
+		bits.writeSE(-2); // offset_for_non_ref_pic
+		bits.writeSE(1); // offset_for_top_to_bottom_field
+		bits.writeUE(2);
+		bits.writeSE(1);
+		bits.writeSE(-1);
+	}
+	bits.writeUE(4); // max_num_ref_frames
+	bits.write(0, 1); // gaps_in_frame_num_value_allowed_flag
+	UInt16 mbs((width + 15) / 16), units(progressive ? (height + 15) / 16 : (height + 31) / 32);
+	bits.writeUE(mbs - 1);
+	bits.writeUE(units - 1);
+	bits.write(progressive ? 1 : 0, 1); // frame_mbs_only_flag
+	if (!progressive)
+		bits.write(0, 1); // mb_adaptive_frame_field_flag
+	bits.write(1, 1); // direct_8x8_inference_flag
+	UInt16 right((mbs * 16 - width) / 2), bottom((units * 16 * (progressive ? 1 : 2) - height) / (progressive ? 2 : 4));
+	bits.write((right || bottom) ? 1 : 0, 1); // frame_cropping_flag
+	if (right || bottom) {
+		bits.writeUE(0);
+		bits.writeUE(right);
+		bits.writeUE(0);
+		bits.writeUE(bottom);
+	}
+	bits.write(0, 1); // vui_parameters_present_flag
+	return bits.flush(sps);
+}
+
+static Buffer& WriteHEVCSPS(Buffer& sps, UInt16 width, UInt16 height) {
+	Bits bits;
+	bits.write(0x4201, 16);
+	bits.write(0, 4); // video_parameter_set_id
+	bits.write(0, 3); // max_sub_layers_minus1
+	bits.write(1, 1); // temporal_id_nesting_flag
+	bits.write(0x01, 8); // main profile
+	bits.write(0x60000000, 32); // profile compatibility
+	bits.write(0x9, 4);
+	bits.write(0, 32); // 44 bits of 0 => emulation prevention bytes!
+	bits.write(0, 12);
+	bits.write(93, 8); // level
+	bits.writeUE(0); // sps_seq_parameter_set_id
+	bits.writeUE(1); // chroma_format_idc
+	bits.writeUE(width);
+	bits.writeUE(height);
+	return bits.flush(sps);
+}
+
+ADD_TEST(ExpGolomb) {
+	Bits bits;
+	for (UInt32 value = 0; value < 5000; ++value)
+		bits.writeUE(value);
+	for (Int32 value = -2000; value <= 2000; ++value)
+		bits.writeSE(value);
+	Buffer buffer;
+	bits.flush(buffer);
+	BitstreamReader reader(buffer.data(), buffer.size());
+	for (UInt32 value = 0; value < 5000; ++value)
+		CHECK(MPEG4::ReadExpGolomb(reader) == value);
+	for (Int32 value = -2000; value <= 2000; ++value)
+		CHECK(MPEG4::ReadSignedExpGolomb(reader) == value);
+	CHECK(reader.read() && reader.available() < 8);
+}
+
+ADD_TEST(SPS) {
+	for (UInt8 profile : { 66, 77, 100 }) { // baseline, main, high
+		for (const auto& dimension : { make_pair(1920, 1080), make_pair(1280, 720), make_pair(854, 480), make_pair(3840, 2160) }) {
+			Buffer sps;
+			WriteSPS(sps, profile, dimension.first, dimension.second);
+			CHECK(AVC::SPSToVideoDimension(sps.data(), sps.size()) == UInt32((dimension.first << 16) | dimension.second));
+			sps.clear();
+			WriteSPS(sps, profile, dimension.first, dimension.second, false); // interlaced
+			CHECK(AVC::SPSToVideoDimension(sps.data(), sps.size()) == UInt32((dimension.first << 16) | dimension.second));
+		}
+	}
+	Buffer sps;
+	WriteHEVCSPS(sps, 1920, 1080);
+	CHECK(sps.size() > 20 && HEVC::SPSToVideoDimension(sps.data(), sps.size()) == ((1920 << 16) | 1080));
+}
+
+ADD_TEST(SPSCost) {
+	Buffer sps, hevc;
+	WriteSPS(sps, 100, 1920, 1080);
+	WriteHEVCSPS(hevc, 3840, 2160);
+	UInt32 dimensions(0);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 100000; ++i)
+		dimensions ^= AVC::SPSToVideoDimension(sps.data(), sps.size());
+	chrono.stop();
+	DEBUG("H264 high profile SPS parsing, ", chrono.elapsed() * 10, "ns/SPS (", dimensions, ")");
+	chrono.restart();
+	for (UInt32 i = 0; i < 100000; ++i)
+		dimensions ^= HEVC::SPSToVideoDimension(hevc.data(), hevc.size());
+	chrono.stop();
+	DEBUG("HEVC main profile SPS parsing, ", chrono.elapsed() * 10, "ns/SPS (", dimensions, ")");
+}
+
+}
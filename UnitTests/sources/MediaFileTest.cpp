@@ -0,0 +1,266 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/MediaFile.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace MediaFileTest {
+
+// 100 video frames of 10ms, one key frame every 25 frames
+static const UInt32 Frames(100);
+static const UInt32 FrameSize(2000);
+
+struct MainHandler : Handler {
+	MainHandler() : Handler(_signal) {}
+	// raise timer and handler until readers stop
+	void run(Timer& timer, const function<bool()>& running) {
+		while (running()) {
+			UInt32 timeout = timer.raise();
+			Handler::flush();
+			_signal.wait(timeout ? min(timeout, 10u) : 10);
+		}
+	}
+private:
+	void flush() {}
+	Signal _signal;
+};
+static ThreadPool	_ThreadPool;
+
+struct Source : Media::Source, virtual Object {
+	Source() : resets(0) {}
+	void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) {}
+	void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) {
+		CHECK(packet.size() == FrameSize - 1 && packet.data()[0] == UInt8(tag.time / 10));
+		videos.emplace_back(tag.time, packet.data());
+	}
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) {}
+	void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) {}
+	void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) {}
+	void flush() {}
+	void reset() { ++resets; }
+
+	vector<pair<UInt32, const UInt8*>> videos;
+	UInt32 resets;
+};
+
+// own temporary folder by test, with the FLV file to read
+struct Fixture : virtual Object {
+	Fixture(const char* test) {
+		const char* temp = getenv(
+#if defined(_WIN32)
+			"TEMP"
+#else
+			"TMPDIR"
+#endif
+		);
+		folder.assign(temp ? temp : "/tmp");
+		String::Append(FileSystem::MakeFolder(folder), "MonaMediaFileTest.", test, '/');
+		Exception ex;
+		if (FileSystem::Exists(folder))
+			CHECK(FileSystem::Delete(ex, folder, FileSystem::MODE_HEAVY) && !ex);
+		CHECK(FileSystem::CreateDirectory(ex, folder) && !ex);
+		WriteFile(name = folder + "temp.flv");
+	}
+	~Fixture() {
+		Exception ex;
+		FileSystem::Delete(ex, folder, FileSystem::MODE_HEAVY);
+	}
+	string folder;
+	string name;
+private:
+	static void WriteFile(const string& name);
+};
+
+void Fixture::WriteFile(const string& name) {
+	Buffer buffer;
+	BinaryWriter writer(buffer);
+	writer.write(EXPAND("FLV")).write8(1).write8(1).write32(9).write32(0);
+	for (UInt32 frame = 0; frame < Frames; ++frame) {
+		writer.write8(9).write24(FrameSize).write24(frame * 10).write8(0).write24(0); // video tag
+		writer.write8((frame % 25) ? 0x22 : 0x12).append(FrameSize - 1, UInt8(frame)); // Sorenson H263
+		writer.write32(FrameSize + 11); // previous tag size
+	}
+	Exception ex;
+	CHECK(File(name, File::MODE_WRITE).write(ex, buffer.data(), buffer.size()) && !ex);
+}
+
+static void Check(const Source& source) {
+	CHECK(source.videos.size() == Frames && source.resets);
+	for (UInt32 i = 0; i < Frames; ++i)
+		CHECK(source.videos[i].first == i * 10);
+}
+
+ADD_TEST(Demuxer) {
+	Fixture fixture("Demuxer");
+	const char* name(fixture.name.c_str());
+	MainHandler handler;
+	IOFile		io(handler, _ThreadPool);
+	Timer		timer;
+	Exception	ex;
+
+	Source source1, source2, source3;
+	auto pReader1(MediaFile::Reader::New(ex, name, source1, timer, io));
+	auto pReader2(MediaFile::Reader::New(ex, name, source2, timer, io));
+	auto pReader3(MediaFile::Reader::New(ex, name, source3, timer, io));
+	CHECK(pReader1 && pReader2 && pReader3 && !ex);
+	Parameters parameters;
+	parameters.setBoolean("cache", false);
+	CHECK(pReader1->start() && pReader2->start() && pReader3->start(parameters));
+	handler.run(timer, [&]() { return pReader1->state() || pReader2->state() || pReader3->state(); });
+	Check(source1);
+	Check(source2);
+	Check(source3);
+	// readers 1 and 2 share the same demuxed frames, reader 3 has its own demuxer
+	for (UInt32 i = 0; i < Frames; ++i)
+		CHECK(source1.videos[i].second == source2.videos[i].second && source1.videos[i].second != source3.videos[i].second);
+}
+
+ADD_TEST(CacheSize) {
+	Fixture fixture("CacheSize");
+	const char* name(fixture.name.c_str());
+	MainHandler handler;
+	IOFile		io(handler, _ThreadPool);
+	Timer		timer;
+	Exception	ex;
+
+	// no budget, the beginning of the file is released once played, a reader starting later gets its own demuxer
+	UInt64 cacheSize = MediaFile::Reader::CacheSize;
+	MediaFile::Reader::CacheSize = 0;
+	Source source1, source2;
+	auto pReader1(MediaFile::Reader::New(ex, name, source1, timer, io));
+	auto pReader2(MediaFile::Reader::New(ex, name, source2, timer, io));
+	CHECK(pReader1->start());
+	handler.run(timer, [&]() { return source1.videos.size() < Frames / 2; });
+	CHECK(pReader2->start());
+	handler.run(timer, [&]() { return pReader1->state() || pReader2->state(); });
+	MediaFile::Reader::CacheSize = cacheSize;
+	Check(source1);
+	Check(source2);
+
+	// budget exceeded while readers are spread more than read-ahead, the slower reader skips the medias released
+	Source source3, source4;
+	auto pReader3(MediaFile::Reader::New(ex, name, source3, timer, io));
+	auto pReader4(MediaFile::Reader::New(ex, name, source4, timer, io));
+	Parameters parameters;
+	parameters.setNumber("readAhead", 200);
+	CHECK(pReader3->start(parameters));
+	handler.run(timer, [&]() { return source3.videos.size() < Frames / 2; });
+	CHECK(pReader4->start(parameters)); // joins, beginning of the file kept
+	handler.run(timer, [&]() { return !source4.videos.size(); });
+	MediaFile::Reader::CacheSize = 0;
+	handler.run(timer, [&]() { return pReader3->state() || pReader4->state(); });
+	MediaFile::Reader::CacheSize = cacheSize;
+	Check(source3);
+	CHECK(source4.videos.size() < Frames && source4.videos.back().first == (Frames - 1) * 10 && source4.resets == 2);
+	for (UInt32 i = 0; i < source4.videos.size(); ++i)
+		CHECK(source4.videos[i].second == source3.videos[source4.videos[i].first / 10].second); // same demuxer
+}
+
+static UInt32 ReadAhead(MainHandler& handler, IOFile& io, const char* name, UInt32 readAhead1, UInt32 readAhead2) {
+	Timer		timer;
+	Exception	ex;
+	Source source1, source2;
+	auto pReader1(MediaFile::Reader::New(ex, name, source1, timer, io));
+	auto pReader2(MediaFile::Reader::New(ex, name, source2, timer, io));
+	CHECK(pReader1 && pReader2 && !ex);
+	Parameters parameters1, parameters2;
+	parameters1.setNumber("readAhead", readAhead1);
+	parameters2.setNumber("readAhead", readAhead2);
+	CHECK(pReader1->start(parameters1) && pReader2->start(parameters2)); // reader 2 joins the demuxer of reader 1
+	UInt32 buffered = 0;
+	handler.run(timer, [&]() {
+		buffered = max(buffered, pReader2->buffered());
+		return pReader1->state() || pReader2->state();
+	});
+	Check(source1);
+	Check(source2);
+	for (UInt32 i = 0; i < Frames; ++i)
+		CHECK(source1.videos[i].second == source2.videos[i].second);
+	return buffered;
+}
+
+ADD_TEST(ReadAhead) {
+	Fixture fixture("ReadAhead");
+	MainHandler handler;
+	IOFile		io(handler, _ThreadPool);
+	// a read of 64KB decodes 320ms of this file, the reader joining with a longer read-ahead gets it anyway
+	const char* name(fixture.name.c_str());
+	CHECK(ReadAhead(handler, io, name, 100, 100) < 500);
+	CHECK(ReadAhead(handler, io, name, 100, 600) >= 500);
+	CHECK(ReadAhead(handler, io, name, 600, 100) >= 500);
+}
+
+static void Record(IOFile& io, const char* name, const Parameters& parameters) {
+	Exception ex;
+	auto pWriter(MediaFile::Writer::New(ex, name, io));
+	CHECK(pWriter && !ex && pWriter->start(parameters) && pWriter->beginMedia("test"));
+	Media::Video::Tag tag(Media::Video::CODEC_SORENSON);
+	for (UInt32 frame = 0; frame < Frames; ++frame) {
+		tag.frame = (frame % 25) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		tag.time = frame * 10;
+		shared<Buffer> pFrame(SET, (frame % 7 + 1) * 1300); // various sizes
+		memset(pFrame->data(), UInt8(frame), pFrame->size());
+		pWriter->writeVideo(1, tag, Packet(pFrame), true);
+	}
+	pWriter->endMedia();
+	pWriter.reset();
+	io.join();
+}
+
+ADD_TEST(Recorder) {
+	Fixture fixture("Recorder");
+	string name1(fixture.folder + "record1.flv"), name2(fixture.folder + "record2.flv");
+	MainHandler handler;
+	IOFile		io(handler, _ThreadPool);
+	Exception	ex;
+
+	// coalesced writes, preallocation and sync policy give the same file than direct writes
+	Record(io, name1.c_str(), Parameters::Null());
+	Parameters parameters;
+	parameters.setNumber("block", 4096);
+	parameters.setNumber("extent", 0x100000);
+	parameters.setNumber("syncSize", 0x10000);
+	parameters.setNumber("syncInterval", 100);
+	Record(io, name2.c_str(), parameters);
+	// appending starts with a partial block to align the next ones on the file offset
+	Parameters append;
+	append.setBoolean("append", true);
+	Record(io, name1.c_str(), append);
+	parameters.setBoolean("append", true);
+	Record(io, name2.c_str(), parameters);
+
+	Buffer file1, file2;
+	{
+		File file(name1, File::MODE_READ);
+		CHECK(file.load(ex) && file.size());
+		file1.resize(UInt32(file.size()));
+		CHECK(file.read(ex, file1.data(), file1.size()) == int(file1.size()));
+	}
+	{
+		File file(name2, File::MODE_READ);
+		CHECK(file.load(ex) && file.size() == file1.size()); // preallocation keeps the file size
+		file2.resize(UInt32(file.size()));
+		CHECK(file.read(ex, file2.data(), file2.size()) == int(file2.size()));
+	}
+	CHECK(memcmp(file1.data(), file2.data(), file1.size()) == 0);
+}
+
+}
@@ -0,0 +1,173 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/RTMFP/RTMFP.h"
+#include "Mona/Util.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace RTMFPTest {
+
+static const UInt8* Key(BIN "0123456789ABCDEF");
+static const UInt32 Packets(100000);
+
+// previous checksum implementation, reference to compare
+static UInt16 Checksum(const UInt8* data, UInt32 size) {
+	BinaryReader reader(data, size);
+	UInt32 sum = 0;
+	while (reader.available()>0)
+		sum += reader.available() == 1 ? reader.read8() : reader.read16();
+	sum = (sum >> 16) + (sum & 0xffff);
+	sum += (sum >> 16);
+	return ~sum;
+}
+
+// previous encoding implementation (cipher context initialized for every packet), reference to compare
+static void Encode(Buffer& buffer, UInt32 farId) {
+	UInt32 size(buffer.size());
+	UInt32 padding((0xFFFFFFFF - size + 5) & 0x0F);
+	buffer.resize(size + padding);
+	memset(buffer.data() + size, 0xFF, padding);
+	size += padding;
+	UInt8* data(buffer.data());
+	BinaryWriter(data + 4, 2).write16(Checksum(data + 6, size - 6));
+	static UInt8 IV[16];
+	EVP_CIPHER_CTX* pContext(EVP_CIPHER_CTX_new());
+	EVP_CipherInit_ex(pContext, EVP_aes_128_cbc(), NULL, Key, IV, 1);
+	int temp;
+	EVP_CipherUpdate(pContext, data + 4, &temp, data + 4, size - 4);
+	EVP_CIPHER_CTX_free(pContext);
+	BinaryReader reader(data + 4, 8);
+	BinaryWriter(data, 4).write32(reader.read32() ^ reader.read32() ^ farId);
+}
+
+static shared<Buffer> NewPacket(UInt32 size) {
+	shared<Buffer> pBuffer(SET, 6 + size);
+	Util::Random(pBuffer->data() + 6, size);
+	return pBuffer;
+}
+
+
+ADD_TEST(Checksum) {
+	Buffer buffer(2048);
+	for (UInt8 value : {0x00, 0xFF}) {
+		memset(buffer.data(), value, buffer.size());
+		for (UInt32 size = 0; size <= 1500; ++size)
+			CHECK(Crypto::ComputeChecksum(buffer.data(), size) == Checksum(buffer.data(), size));
+	}
+	Util::Random(buffer.data(), buffer.size());
+	for (UInt32 offset = 0; offset < 4; ++offset) { // unaligned
+		for (UInt32 size = 0; size <= 1500; ++size)
+			CHECK(Crypto::ComputeChecksum(buffer.data() + offset, size) == Checksum(buffer.data() + offset, size));
+	}
+}
+
+ADD_TEST(Engine) {
+	RTMFP::Engine encoder(Key), decoder(Key);
+	for (UInt32 size = 1; size < RTMFP::SIZE_PACKET - 32; size += 37) {
+		shared<Buffer> pBuffer(NewPacket(size));
+		Buffer reference(pBuffer->data(), pBuffer->size());
+		Buffer content(pBuffer->data() + 6, size);
+		// same encoding than previous implementation, with a context reused
+		Encode(reference, 0x12345678);
+		encoder.encode(pBuffer, 0x12345678, SocketAddress::Wildcard());
+		CHECK(pBuffer->size() == reference.size() && memcmp(pBuffer->data(), reference.data(), reference.size()) == 0);
+		// decoding
+		Buffer& buffer(*pBuffer);
+		CHECK(RTMFP::ReadID(buffer) == 0x12345678);
+		Exception ex;
+		CHECK(decoder.decode(ex, buffer, SocketAddress::Wildcard()) && !ex);
+		CHECK(buffer.size() >= size && memcmp(buffer.data(), content.data(), size) == 0);
+	}
+	// corrupted packet
+	shared<Buffer> pBuffer(NewPacket(100));
+	encoder.encode(pBuffer, 0, SocketAddress::Wildcard());
+	RTMFP::ReadID(*pBuffer);
+	pBuffer->data()[20] ^= 0xFF;
+	Exception ex;
+	CHECK(!decoder.decode(ex, *pBuffer, SocketAddress::Wildcard()) && ex);
+}
+
+ADD_TEST(Cookie) {
+	SocketAddress address(IPAddress::Loopback(), 1935);
+	Buffer cookie;
+	BinaryWriter writer(cookie);
+	RTMFP::WriteCookie(writer, 0x12345678, address);
+	CHECK(cookie.size() == RTMFP::SIZE_COOKIE && BinaryReader(cookie.data(), 4).read32() == 0x12345678);
+	CHECK(RTMFP::CheckCookie(cookie.data(), address));
+	// not delivered to this address
+	CHECK(!RTMFP::CheckCookie(cookie.data(), SocketAddress(IPAddress::Loopback(), 1936)));
+	CHECK(!RTMFP::CheckCookie(cookie.data(), SocketAddress(IPAddress::Wildcard(), 1935)));
+	// id or hmac changed
+	++cookie.data()[3];
+	CHECK(!RTMFP::CheckCookie(cookie.data(), address));
+	--cookie.data()[3];
+	cookie.data()[20] ^= 0xFF;
+	CHECK(!RTMFP::CheckCookie(cookie.data(), address));
+	// random tail is not a part of the check
+	cookie.data()[20] ^= 0xFF;
+	cookie.data()[RTMFP::SIZE_COOKIE - 1] ^= 0xFF;
+	CHECK(RTMFP::CheckCookie(cookie.data(), address));
+}
+
+ADD_TEST(KeyPool) {
+	ThreadPool threadPool(1);
+	Exception ex;
+	set<string> keys;
+	// pool filled in background, and empty pool (0 capacity) computes in place
+	for (UInt32 capacity : { 4u, 0u }) {
+		RTMFP::KeyPool pool(threadPool, capacity);
+		for (UInt8 i = 0; i < 8; ++i) {
+			unique<DiffieHellman> pDH = pool.pop(ex);
+			CHECK(pDH && !ex && pDH->publicKeySize());
+			UInt8 key[DiffieHellman::SIZE];
+			CHECK(keys.emplace(STR pDH->readPublicKey(key), pDH->publicKeySize()).second); // always a new keypair
+		}
+	}
+	threadPool.join();
+}
+
+ADD_TEST(ChecksumCost) {
+	shared<Buffer> pBuffer(NewPacket(RTMFP::SIZE_PACKET));
+	UInt16 checksum(0);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < Packets; ++i)
+		checksum ^= Crypto::ComputeChecksum(pBuffer->data(), pBuffer->size());
+	chrono.stop();
+	DEBUG("Checksum of ", RTMFP::SIZE_PACKET, " bytes, ", chrono.elapsed() * 1000000 / Packets, "ns/packet (", checksum, ")");
+}
+
+ADD_TEST(EngineCost) {
+	RTMFP::Engine encoder(Key), decoder(Key);
+	Exception ex;
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < Packets; ++i) {
+		shared<Buffer> pBuffer(SET, 6 + RTMFP::SIZE_PACKET - 32);
+		encoder.encode(pBuffer, 0, SocketAddress::Wildcard());
+		RTMFP::ReadID(*pBuffer);
+		CHECK(decoder.decode(ex, *pBuffer, SocketAddress::Wildcard()));
+	}
+	chrono.stop();
+	DEBUG("RTMFP encoding + decoding, ", chrono.elapsed() * 1000000 / Packets, "ns/packet");
+}
+
+}
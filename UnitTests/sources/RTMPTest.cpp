@@ -0,0 +1,227 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+// RTMPE uses RC4 whose API is deprecated since OpenSSL 3.0
+#define OPENSSL_SUPPRESS_DEPRECATED
+#include "Mona/UnitTest.h"
+#include "Mona/RTMP/RTMPSender.h"
+#include "Mona/RTMP/RTMPDecoder.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace RTMPTest {
+
+// Socket which consumes everything written (and can keep it to check content)
+struct NullSocket : Socket {
+	NullSocket(bool keep = false) : Socket(TYPE_STREAM), keep(keep), written(0), writings(0) {}
+	Buffer	output;
+	bool	keep;
+	UInt64	written;
+	UInt32	writings;
+private:
+	int sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags) {
+		if(keep)
+			output.append(data, size);
+		++writings;
+		written += size;
+		return size;
+	}
+	int sendPackets(Exception& ex, const deque<Packet>& packets, int flags) {
+		UInt32 size(0);
+		for (const Packet& packet : packets) {
+			if (keep)
+				output.append(packet.data(), packet.size());
+			size += packet.size();
+		}
+		++writings;
+		written += size;
+		return size;
+	}
+};
+
+struct Subscriber : virtual Object {
+	Subscriber(bool keep = false, const shared<RC4_KEY>& pEncryptKey = nullptr) : pChannel(SET, 3), pSocket(SET, keep), pEncryptKey(pEncryptKey), pChunkSize(SET, RTMP::DEFAULT_CHUNKSIZE) {}
+
+	// send one flush of frames as RTMPWriter does: one RTMPSenders for all the messages
+	void send(UInt32 time, const Packet& audio, const Packet& video) {
+		deque<shared<RTMPSender>> senders;
+		senders.emplace_back(SET, AMF::TYPE_AUDIO, time, 1, pChannel, pSocket, pEncryptKey, pChunkSize, Media::Data::TYPE_AMF, audio);
+		senders.back()->writer->write8(0xAF).write8(1);
+		senders.emplace_back(SET, AMF::TYPE_VIDEO, time, 1, pChannel, pSocket, pEncryptKey, pChunkSize, Media::Data::TYPE_AMF, video);
+		senders.back()->writer->write8(0x27).write8(1).write24(0);
+		RTMPSenders sending(senders);
+		((Runner&)sending).run("RTMPTest");
+	}
+
+	shared<RTMP::Channel>	pChannel;
+	shared<NullSocket>		pSocket;
+	shared<RC4_KEY>			pEncryptKey;
+	shared<UInt32>			pChunkSize;
+};
+
+static const UInt32 Subscribers(500);
+static const UInt32 Frames(50);
+
+static shared<RC4_KEY> NewKey() {
+	shared<RC4_KEY> pKey(SET);
+	RC4_set_key(pKey.get(), 16, BIN "0123456789ABCDEF");
+	return pKey;
+}
+
+// returns the fan-out time in ms
+static Int64 FanOut(bool encrypted, UInt64& written) {
+	// same publication frames shared between all subscribers (no copy to do)
+	shared<Buffer> pAudio(SET, 400), pVideo(SET, 8000);
+	Packet audio(pAudio), video(pVideo);
+	vector<unique<Subscriber>> subscribers;
+	for (UInt32 i = 0; i < Subscribers; ++i)
+		subscribers.emplace_back(new Subscriber(false, encrypted ? NewKey() : nullptr));
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 frame = 0; frame < Frames; ++frame) {
+		for (unique<Subscriber>& pSubscriber : subscribers)
+			pSubscriber->send(frame * 40, audio, video);
+	}
+	chrono.stop();
+	written = 0;
+	for (unique<Subscriber>& pSubscriber : subscribers) {
+		CHECK(pSubscriber->pSocket->writings == Frames); // one writing by flush
+		written += pSubscriber->pSocket->written;
+	}
+	return chrono.elapsed();
+}
+
+ADD_TEST(RTMPE) {
+	// RTMPE output deciphered must be exactly the RTMP output
+	shared<Buffer> pAudio(SET, 400), pVideo(SET, 8000);
+	for (UInt32 i = 0; i < pVideo->size(); ++i)
+		pVideo->data()[i] = UInt8(i);
+	Packet audio(pAudio), video(pVideo);
+
+	Subscriber rtmp(true), rtmpe(true, NewKey());
+	for (UInt32 frame = 0; frame < 5; ++frame) {
+		rtmp.send(frame * 40, audio, video);
+		rtmpe.send(frame * 40, audio, video);
+	}
+	const Buffer& output(rtmp.pSocket->output);
+	Buffer& cipher(rtmpe.pSocket->output);
+	CHECK(output.size() == cipher.size() && output.size() > 5 * (400 + 8000));
+	RC4(NewKey().get(), cipher.size(), cipher.data(), cipher.data());
+	CHECK(memcmp(output.data(), cipher.data(), output.size()) == 0);
+	// frames shared with subscribers are never modified by the encryption
+	for (UInt32 i = 0; i < video.size(); ++i)
+		CHECK(video.data()[i] == UInt8(i));
+}
+
+ADD_TEST(FanOutCost) {
+	UInt64 rtmpBytes, rtmpeBytes;
+	Int64 rtmp(FanOut(false, rtmpBytes));
+	Int64 rtmpe(FanOut(true, rtmpeBytes));
+	CHECK(rtmpBytes == rtmpeBytes && rtmpBytes > UInt64(Subscribers) * Frames * (400 + 8000));
+	// cost of one flush of frames (audio + video) by subscriber
+	DEBUG("RTMP fan-out to ", Subscribers, " subscribers, ", rtmp * 1000000 / (Subscribers * Frames), "ns/subscriber/flush");
+	DEBUG("RTMPE fan-out to ", Subscribers, " subscribers, ", rtmpe * 1000000 / (Subscribers * Frames), "ns/subscriber/flush (x", String::Format<double>("%.2f", double(rtmpe) / (rtmp ? rtmp : 1)), " RTMP)");
+}
+
+// decode output by RTMPDecoder after a simple handshake
+static void Decode(RTMPDecoder& decoder, const Buffer& output) {
+	shared<NullSocket> pPeer(SET);
+	shared<Buffer> pBuffer(SET, 1537);
+	memset(pBuffer->data(), 0, pBuffer->size());
+	pBuffer->data()[0] = 3;
+	((Socket::Decoder&)decoder).decode(pBuffer, SocketAddress::Wildcard(), pPeer);
+	CHECK(pPeer->written == 1 + 2 * 1536);
+	pBuffer.set(1536);
+	((Socket::Decoder&)decoder).decode(pBuffer, SocketAddress::Wildcard(), pPeer);
+	pBuffer.set(output.data(), output.size());
+	((Socket::Decoder&)decoder).decode(pBuffer, SocketAddress::Wildcard(), pPeer);
+}
+
+ADD_TEST(Aggregate) {
+	// audio and video frames gathered in one aggregate message by RTMPSender
+	shared<Buffer> pAudio(SET, 300), pVideo(SET, 1000);
+	for (UInt32 i = 0; i < pVideo->size(); ++i)
+		pVideo->data()[i] = UInt8(i);
+	memset(pAudio->data(), 0xAA, pAudio->size());
+	Packet audio(pAudio), video(pVideo);
+	Subscriber subscriber(true);
+	shared<RTMPSender> pAggregate(SET, AMF::TYPE_AGGREGATE, 1000, 1, subscriber.pChannel, subscriber.pSocket, nullptr, subscriber.pChunkSize, Media::Data::TYPE_AMF, Packet::Null());
+	shared<RTMPSender> pAudioSender(SET, AMF::TYPE_AUDIO, 1000, 1, subscriber.pChannel, subscriber.pSocket, nullptr, subscriber.pChunkSize, Media::Data::TYPE_AMF, audio);
+	CHECK(pAggregate->aggregate(pAudioSender) == 320);
+	pAudioSender->writer->write8(0xAF).write8(1);
+	shared<RTMPSender> pVideoSender(SET, AMF::TYPE_VIDEO, 1040, 1, subscriber.pChannel, subscriber.pSocket, nullptr, subscriber.pChunkSize, Media::Data::TYPE_AMF, video);
+	CHECK(pAggregate->aggregate(pVideoSender) == 1340);
+	pVideoSender->writer->write8(0x27).write8(1).write24(0);
+	deque<shared<RTMPSender>> senders;
+	senders.emplace_back(pAggregate);
+	RTMPSenders sending(senders);
+	((Runner&)sending).run("RTMPTest");
+	CHECK(subscriber.pSocket->writings == 1);
+
+	// split by RTMPDecoder in its sub-messages, after a simple handshake
+	Signal signal;
+	Handler handler(signal);
+	RTMPDecoder decoder(handler);
+	vector<AMF::Type> types;
+	vector<UInt32> times;
+	deque<Packet> packets;
+	decoder.onRequest = [&](RTMP::Request& request) {
+		CHECK(request.streamId == 1 && request.channelId == subscriber.pChannel->id);
+		types.emplace_back(request.type);
+		times.emplace_back(request.time);
+		packets.emplace_back(move(request)); // bufferize, request is released after this call
+	};
+	Decode(decoder, subscriber.pSocket->output);
+	handler.flush();
+
+	CHECK(types.size() == 2 && types[0] == AMF::TYPE_AUDIO && types[1] == AMF::TYPE_VIDEO);
+	CHECK(times[0] == 1000 && times[1] == 1040);
+	CHECK(packets[0].size() == 302 && memcmp(packets[0].data(), EXPAND("\xAF\x01")) == 0 && memcmp(packets[0].data() + 2, audio.data(), audio.size()) == 0);
+	CHECK(packets[1].size() == 1005 && memcmp(packets[1].data(), EXPAND("\x27\x01\x00\x00\x00")) == 0 && memcmp(packets[1].data() + 5, video.data(), video.size()) == 0);
+}
+
+ADD_TEST(ChannelId) {
+	// 2-byte (64 to 319) and 3-byte (320 to 65599) forms of channel id, on the header and the chunk continuations
+	for (UInt32 id : { 3u, 64u, 319u, 320u, 1000u, 65599u }) {
+		shared<Buffer> pAudio(SET, 300);
+		memset(pAudio->data(), 0xAA, pAudio->size());
+		Packet audio(pAudio);
+		Subscriber subscriber(true);
+		subscriber.pChannel.set(id);
+		deque<shared<RTMPSender>> senders;
+		senders.emplace_back(SET, AMF::TYPE_AUDIO, 1000, 1, subscriber.pChannel, subscriber.pSocket, nullptr, subscriber.pChunkSize, Media::Data::TYPE_AMF, audio);
+		RTMPSenders sending(senders);
+		((Runner&)sending).run("RTMPTest");
+		CHECK(subscriber.pSocket->writings == 1);
+
+		Signal signal;
+		Handler handler(signal);
+		RTMPDecoder decoder(handler);
+		UInt32 requests = 0;
+		decoder.onRequest = [&](RTMP::Request& request) {
+			CHECK(request.channelId == id && request.type == AMF::TYPE_AUDIO && request.size() == audio.size() && memcmp(request.data(), audio.data(), audio.size()) == 0);
+			++requests;
+		};
+		Decode(decoder, subscriber.pSocket->output);
+		handler.flush();
+		CHECK(requests == 1);
+	}
+}
+
+}
@@ -207,6 +207,11 @@ void TestTCPBlocking(const shared<TLS>& pClientTLS = nullptr, const shared<TLS>&
 	// Test server TCP communication
 	CHECK(pClient->send(ex, EXPAND("hi mathieu and thomas")) == 21 && !ex);
 	CHECK(UInt32(pClient->send(ex, _Long0Data.c_str(), _Long0Data.size())) == _Long0Data.size() && !ex);
+	// gather writing
+	deque<Packet> packets;
+	packets.emplace_back(EXPAND("hi "));
+	packets.emplace_back(EXPAND("mathieu and thomas"));
+	CHECK(pClient->write(ex, packets) == 21 && !ex);
 	CHECK(pClient->shutdown(Socket::SHUTDOWN_SEND));
 
 	UInt8 buffer[8192];
@@ -215,7 +220,8 @@ void TestTCPBlocking(const shared<TLS>& pClientTLS = nullptr, const shared<TLS>&
 	while ((received = pClient->receive(ex, buffer, sizeof(buffer))) > 0)
 		message.append(buffer, received);
 
-	CHECK(!ex && message.size() == (_Long0Data.size() + 21) && memcmp(message.data(), EXPAND("hi mathieu and thomas")) == 0 && memcmp(message.data() + 21, _Long0Data.data(), _Long0Data.size()) == 0)
+	CHECK(!ex && message.size() == (_Long0Data.size() + 42) && memcmp(message.data(), EXPAND("hi mathieu and thomas")) == 0 && memcmp(message.data() + 21, _Long0Data.data(), _Long0Data.size()) == 0)
+	CHECK(memcmp(message.data() + 21 + _Long0Data.size(), EXPAND("hi mathieu and thomas")) == 0);
 }
 
 
@@ -231,6 +237,61 @@ ADD_TEST(TCP_SSL_Blocking) {
 	TestTCPBlocking(pClientTLS, pServerTLS);
 }
 
+struct GatheringSocket : Socket {
+	GatheringSocket() : Socket(Socket::TYPE_STREAM), sends(0) {}
+	UInt32 sends;
+	int sendTo(Exception& ex, const void* data, UInt32 size, const SocketAddress& address, int flags = 0) {
+		++sends;
+		return Socket::sendTo(ex, data, size, address, flags);
+	}
+private:
+	int sendPackets(Exception& ex, const deque<Packet>& packets, int flags = 0) {
+		++sends;
+		return Socket::sendPackets(ex, packets, flags);
+	}
+};
+
+ADD_TEST(TCP_GatheredFlush) {
+	Exception ex;
+	Socket server(Socket::TYPE_STREAM);
+	CHECK(server.bind(ex, IPAddress::Loopback()) && !ex && server.listen(ex) && !ex);
+	GatheringSocket client;
+	CHECK(client.connect(ex, server.address()) && !ex);
+	shared<Socket> pConnection;
+	CHECK(server.accept(ex, pConnection) && pConnection && !ex);
+	CHECK(client.setNonBlockingMode(ex, true) && !ex);
+
+	// small parts like a scatter writing of TS cells (4 bytes header + 184 bytes payload),
+	// more than IOV_MAX parts so always queued
+	Buffer data(0x40000);
+	for (UInt32 i = 0; i < data.size(); ++i)
+		data.data()[i] = UInt8(i % 251);
+	shared<Buffer> pBuffer(SET, data.data(), data.size());
+	Packet packet(pBuffer);
+	deque<Packet> packets;
+	UInt32 position = 0;
+	while (position < packet.size()) {
+		UInt32 size = min(packet.size() - position, UInt32(packets.size() & 1 ? 184 : 4));
+		packets.emplace_back(packet, packet.data() + position, size);
+		position += size;
+	}
+	CHECK(client.write(ex, packets) >= 0 && !ex && client.queueing());
+
+	// read on the other side while flushing, queued parts have to be gathered in few system calls
+	Buffer received(data.size());
+	position = 0;
+	client.sends = 0;
+	while (position < received.size()) {
+		CHECK(client.flush(ex) && !ex);
+		int size = pConnection->receive(ex, received.data() + position, received.size() - position);
+		CHECK(size > 0 && !ex);
+		position += size;
+	}
+	CHECK(client.flush(ex) && !ex && !client.queueing());
+	CHECK(memcmp(received.data(), data.data(), data.size()) == 0);
+	CHECK(client.sends < packets.size() / 16);
+}
+
 
 struct UDPEchoClient :  UDPSocket {
 	UDPEchoClient(IOSocket& io) : UDPSocket(io) {
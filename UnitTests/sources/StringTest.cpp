@@ -20,6 +20,7 @@ details (or else see http://www.gnu.org/licenses/).
 #include "Mona/String.h"
 #include "Mona/Exceptions.h"
 #include "Mona/Logs.h"
+#include "Mona/Util.h"
 #include "math.h"
 #include "float.h"
 
@@ -210,6 +211,159 @@ ADD_TEST(ToNumber) {
 	
 }
 
+ADD_TEST(Exponent) {
+	double result;
+	CHECK(String::ToNumber("1e3", result) && result == 1000);
+	CHECK(String::ToNumber("1.5E-2", result) && result == 0.015);
+	CHECK(String::ToNumber("-2.5e+2", result) && result == -250);
+	CHECK(String::ToNumber("1,5e1", result) && result == 15);
+	CHECK(String::ToNumber("6.02214076e23", result) && result == 6.02214076e23);
+	CHECK(String::ToNumber("4.9e-324", result) && result == 4.9e-324);
+	CHECK(String::ToNumber("1e-400", result) && result == 0);
+	CHECK(!String::ToNumber("1e400", result));
+	// zero and huge exponents, never NaN
+	CHECK(String::ToNumber("0e999999", result) && result == 0 && !signbit(result));
+	CHECK(String::ToNumber("-0.000e999999", result) && result == 0 && signbit(result));
+	CHECK(String::ToNumber("0e-999999", result) && result == 0);
+	CHECK(String::ToNumber("1e-999999", result) && result == 0);
+	CHECK(!String::ToNumber("1e999999", result));
+	CHECK(tryToNumber<int>("0e999999", 0));
+	string big("1");
+	big.append(400, '0').append("e-400");
+	CHECK(String::ToNumber(big, result) && result == 1);
+	big.assign("0.").append(400, '0').append("1e401");
+	CHECK(String::ToNumber(big, result) && result == 1);
+	CHECK(tryToNumber<int>("-2e2", -200));
+	CHECK(tryToNumber<int>("12e-1", 1));
+	CHECK(tryToNumber<UInt32>("4.294967295e9", 4294967295u));
+	CHECK(!tryToNumber<UInt32>("4.294967296e9", 0));
+	// 'e' is a digit from base 15
+	int value;
+	CHECK(String::ToNumber("1e", value, BASE_16) && value == 30);
+	CHECK(!String::ToNumber("1e", value, BASE_14));
+
+	static const char* Malformed[] = { "1e", "e5", "1e+", "1e-", "-e5", "1e5x", "1e 5", "1e5.2", "1e+-5", "1e5e5", "1e5 " };
+	for (const char* malformed : Malformed)
+		CHECK(!String::ToNumber(malformed, result));
+	// size bounded
+	CHECK(String::ToNumber("1e21234", 4, result) && result == 1e21);
+}
+
+static UInt64 Power(UInt64 base, UInt8 exponent) {
+	UInt64 result(1);
+	while (exponent--)
+		result *= base;
+	return result;
+}
+
+ADD_TEST(Conformance) {
+	// formatting identical to sprintf
+	char expected[64];
+	for (double value : { 0.0, -0.0, 1.0, -1.0, 0.5, 0.1, 0.3, 1.0 / 3, 2.0 / 3, 0.1 + 0.2, 1e-4, 9.99999999999999e-5, 1e-5, 123456789012345.6,
+		999999999999999.9, 9999999999999999.0, 1e16, 1e100, -1e-100, 5e-324, DBL_MAX, DBL_MIN, HUGE_VAL, -HUGE_VAL, 0.125, 2.5, 0.000123456789, 1.0000000000000002 }) {
+		snprintf(expected, sizeof(expected), "%.16g", value);
+		CHECK(String(value) == expected);
+		snprintf(expected, sizeof(expected), "%.8g", float(value));
+		CHECK(String(float(value)) == expected);
+	}
+	for (UInt32 i = 0; i < 100000; ++i) {
+		UInt64 bits(Util::Random<UInt64>());
+		double value;
+		switch (i % 4) {
+			case 0: // all doubles
+				memcpy(&value, &bits, sizeof(value));
+				break;
+			case 1: // decimals
+				value = Int32(bits) / double(Power(10, bits % 10));
+				break;
+			case 2: // around the fixed/exponent notation limits
+				value = ldexp(double(bits >> 11), Int32(bits % 80) - 110);
+				break;
+			default:
+				value = double(Int64(bits) >> (bits % 64));
+		}
+		snprintf(expected, sizeof(expected), "%.16g", value);
+		CHECK(String(value) == expected);
+		float single = float(value);
+		snprintf(expected, sizeof(expected), "%.8g", single);
+		CHECK(single != single || String(single) == expected);
+
+		Int64 integer(Int64(bits) >> (bits % 64));
+		snprintf(expected, sizeof(expected), "%lld", (long long)integer);
+		CHECK(String(integer) == expected);
+		snprintf(expected, sizeof(expected), "%llu", (unsigned long long)bits);
+		CHECK(String(bits) == expected);
+		snprintf(expected, sizeof(expected), "%d", Int32(bits));
+		CHECK(String(Int32(bits)) == expected);
+	}
+	CHECK(String(numeric_limits<Int64>::min()) == "-9223372036854775808");
+
+	// parsing of 15 significant digits is correctly rounded, like strtod
+	for (const char* value : { "-2.757219100000000e-08", "1.639532000000000e-08", "2.5e25" }) {
+		double result;
+		CHECK(String::ToNumber(value, result) && result == strtod(value, NULL));
+	}
+	for (UInt32 i = 0; i < 100000; ++i) {
+		double value(Int32(Util::Random<UInt32>()) / double(Power(10, Util::Random<UInt8>() % 16)));
+		snprintf(expected, sizeof(expected), (i & 1) ? "%.15g" : "%.15e", value);
+		double result;
+		CHECK(String::ToNumber(expected, result) && result == strtod(expected, NULL));
+	}
+}
+
+ADD_TEST(NumberCost) {
+	// new locale-free paths against the libc ones
+	vector<string> decimals, integers;
+	for (UInt32 i = 0; i < 10000; ++i) {
+		decimals.emplace_back(String(Int32(Util::Random<UInt32>()) / 1000.0));
+		integers.emplace_back(String(Util::Random<UInt32>()));
+	}
+	char buffer[32];
+	Stopwatch chrono;
+	double total(0);
+	for (bool libc : { true, false }) {
+		chrono.restart();
+		for (UInt32 i = 0; i < 100; ++i) {
+			for (const string& decimal : decimals) {
+				double result;
+				if (libc)
+					result = strtod(decimal.c_str(), NULL);
+				else
+					String::ToNumber(decimal, result);
+				total += result;
+			}
+		}
+		chrono.stop();
+		DEBUG(libc ? "strtod" : "String::ToNumber<double>", ", ", chrono.elapsed(), "ns/number");
+		chrono.restart();
+		for (UInt32 i = 0; i < 100; ++i) {
+			for (const string& integer : integers) {
+				UInt32 result;
+				if (libc)
+					result = strtoul(integer.c_str(), NULL, 10);
+				else
+					String::ToNumber(integer, result);
+				total += result;
+			}
+		}
+		chrono.stop();
+		DEBUG(libc ? "strtoul" : "String::ToNumber<UInt32>", ", ", chrono.elapsed(), "ns/number");
+		chrono.restart();
+		for (UInt32 i = 0; i < 1000000; ++i) {
+			double value(i / 1000.0);
+			total += libc ? snprintf(buffer, sizeof(buffer), "%.16g", value) : String::FromNumber(value, buffer);
+		}
+		chrono.stop();
+		DEBUG(libc ? "sprintf(\"%.16g\")" : "String::Append(double)", ", ", chrono.elapsed(), "ns/number");
+		chrono.restart();
+		for (UInt32 i = 0; i < 1000000; ++i)
+			total += libc ? snprintf(buffer, sizeof(buffer), "%u", i * 7919) : String::FromNumber(UInt64(i * 7919), buffer);
+		chrono.stop();
+		DEBUG(libc ? "sprintf(\"%u\")" : "String::Append(UInt32)", ", ", chrono.elapsed(), "ns/number");
+	}
+	CHECK(total);
+}
+
 ADD_TEST(TrimLeft) {
 
 	string s = "abc";
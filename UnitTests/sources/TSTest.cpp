@@ -0,0 +1,192 @@
+/*
+This file is a part of MonaSolutions Copyright 2017
+mathieu.poux[a]gmail.com
+jammetthomas[a]gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License received along this program for more
+details (or else see http://www.gnu.org/licenses/).
+
+*/
+
+#include "Mona/UnitTest.h"
+#include "Mona/TSReader.h"
+#include "Mona/TSWriter.h"
+#include "Mona/Util.h"
+#include "Mona/Crypto.h"
+
+using namespace Mona;
+using namespace std;
+
+namespace TSTest {
+
+// 250 H264 frames of 40ms, one key frame every 25 frames
+static const UInt32 Frames(250);
+
+struct Source : Media::Source, virtual Object {
+	void writeAudio(const Media::Audio::Tag& tag, const Packet& packet, UInt8 track = 1) {}
+	void writeVideo(const Media::Video::Tag& tag, const Packet& packet, UInt8 track = 1) {
+		if (tag.frame != Media::Video::FRAME_CONFIG)
+			videos.emplace_back(tag.time, string(STR packet.data(), packet.size()));
+	}
+	void writeData(Media::Data::Type type, const Packet& packet, UInt8 track = 0) {}
+	void addProperties(UInt8 track, Media::Data::Type type, const Packet& packet) {}
+	void reportLost(Media::Type type, UInt32 lost, UInt8 track = 0) { ++losts; }
+	void flush() {}
+	void reset() {}
+
+	Source() : losts(0) {}
+	vector<pair<UInt32, string>> videos;
+	UInt32 losts;
+};
+
+static void NewFrames(vector<string>& frames) {
+	for (UInt32 frame = 0; frame < Frames; ++frame) {
+		Buffer buffer(4 + 1 + Util::Random<UInt16>() % 20000);
+		BinaryWriter(buffer.data(), 5).write32(buffer.size() - 4).write8((frame % 25) ? 0x41 : 0x65);
+		for (UInt32 i = 5; i < buffer.size(); ++i)
+			buffer.data()[i] = Util::Random<UInt8>() | 2; // without start code emulation
+		frames.emplace_back(STR buffer.data(), buffer.size());
+	}
+}
+
+// TS stream of the AVCC frames, returns the count of frame parts referenced rather than copied
+static UInt32 WriteStream(const vector<string>& frames, Buffer& stream, bool scatter = false) {
+	TSWriter writer;
+	writer.scatter = scatter;
+	UInt32 references(0);
+	const string* pFrame(NULL);
+	MediaWriter::OnWrite onWrite([&](const Packet& packet) {
+		if (pFrame && packet.data() >= BIN pFrame->data() && packet.data() < BIN pFrame->data() + pFrame->size())
+			++references;
+		stream.append(packet.data(), packet.size());
+	});
+	writer.beginMedia(onWrite);
+	Media::Video::Tag tag(Media::Video::CODEC_H264);
+	tag.frame = Media::Video::FRAME_CONFIG;
+	writer.writeVideo(1, tag, Packet(EXPAND("\x00\x00\x00\x02\x67\x42\x00\x00\x00\x02\x68\xCE")), onWrite);
+	for (UInt32 frame = 0; frame < frames.size(); ++frame) {
+		tag.time = frame * 40;
+		tag.frame = (frame % 25) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		pFrame = &frames[frame];
+		writer.writeVideo(1, tag, Packet(pFrame->data(), pFrame->size()), onWrite);
+	}
+	writer.endMedia(onWrite);
+	return references;
+}
+
+static void Read(const Buffer& stream, UInt32 step, Source& source) {
+	TSReader reader;
+	for (UInt32 position = 0; position < stream.size(); position += step)
+		reader.read(Packet(stream.data() + position, min(step, stream.size() - position)), source);
+	reader.flush(source);
+}
+
+static void Check(const Source& source, const vector<string>& frames) {
+	CHECK(source.videos.size() == frames.size() && !source.losts);
+	for (UInt32 i = 0; i < frames.size(); ++i)
+		CHECK(source.videos[i].second == frames[i] && (source.videos[i].first - source.videos[0].first) == i * 40);
+}
+
+ADD_TEST(Demux) {
+	Buffer stream;
+	vector<string> frames;
+	NewFrames(frames);
+	WriteStream(frames, stream);
+	CHECK(stream.size() % 188 == 0);
+	// same frames whatever the fragmentation of the stream
+	for (UInt32 step : { 1u, 100u, 188u, 1316u, 10000u, stream.size() }) {
+		Source source;
+		Read(stream, step, source);
+		Check(source, frames);
+	}
+	// resynchronization after garbage
+	Buffer garbage(100);
+	memset(garbage.data(), 0xFF, garbage.size());
+	garbage.append(stream.data(), stream.size());
+	Source source;
+	Read(garbage, 1316, source);
+	Check(source, frames);
+}
+
+ADD_TEST(Scatter) {
+	vector<string> frames;
+	NewFrames(frames);
+	Buffer stream, scattered;
+	CHECK(!WriteStream(frames, stream));
+	// same TS stream, but frames are referenced by TS payload rather than copied
+	UInt32 references(WriteStream(frames, scattered, true));
+	CHECK(references > frames.size() && stream.size() == scattered.size() && memcmp(stream.data(), scattered.data(), stream.size()) == 0);
+}
+
+// deterministic H264 + MP3 stream, with composition offsets and frames of all sizes
+static void Mux(TSWriter& writer, Buffer& stream, UInt32 frames = Frames) {
+	MediaWriter::OnWrite onWrite([&stream](const Packet& packet) { stream.append(packet.data(), packet.size()); });
+	writer.beginMedia(onWrite);
+	Media::Video::Tag video(Media::Video::CODEC_H264);
+	video.frame = Media::Video::FRAME_CONFIG;
+	writer.writeVideo(1, video, Packet(EXPAND("\x00\x00\x00\x02\x67\x42\x00\x00\x00\x02\x68\xCE")), onWrite);
+	Media::Audio::Tag audio(Media::Audio::CODEC_MP3);
+	Buffer frame(30000);
+	for (UInt32 i = 0; i < frame.size(); ++i)
+		frame.data()[i] = UInt8(i * 7) | 2;
+	for (UInt32 i = 0; i < frames; ++i) {
+		video.time = i * 40;
+		video.compositionOffset = (i % 3) * 40;
+		video.frame = (i % 25) ? Media::Video::FRAME_INTER : Media::Video::FRAME_KEY;
+		UInt32 size = 1 + (i * 7919) % (frame.size() - 4);
+		BinaryWriter(frame.data(), 5).write32(size).write8((i % 25) ? 0x41 : 0x65);
+		writer.writeVideo(1, video, Packet(frame.data(), size + 4), onWrite);
+		audio.time = i * 40 + 10;
+		writer.writeAudio(1, audio, Packet(frame.data() + 5, 1 + (i * 131) % 700), onWrite);
+	}
+	writer.endMedia(onWrite);
+}
+
+ADD_TEST(Mux) {
+	// byte-identical to the output of the TS writer before batched muxing
+	for (bool scatter : { false, true }) {
+		TSWriter writer;
+		writer.scatter = scatter;
+		Buffer stream;
+		Mux(writer, stream);
+		CHECK(stream.size() == 3953264 && Crypto::ComputeCRC32(stream.data(), stream.size()) == 3613094522u);
+	}
+}
+
+ADD_TEST(MuxCost) {
+	TSWriter writer;
+	Buffer stream;
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 10; ++i) {
+		stream.clear();
+		Mux(writer, stream);
+	}
+	chrono.stop();
+	DEBUG("TS muxing, ", stream.size() * 10 / (chrono.elapsed() ? chrono.elapsed() : 1) / 1000, "MB/s");
+}
+
+ADD_TEST(DemuxCost) {
+	Buffer stream;
+	vector<string> frames;
+	NewFrames(frames);
+	WriteStream(frames, stream);
+	Stopwatch chrono;
+	chrono.start();
+	for (UInt32 i = 0; i < 10; ++i) {
+		Source source;
+		Read(stream, 1316, source); // 7 TS packets by UDP datagram
+	}
+	chrono.stop();
+	DEBUG("TS demuxing, ", stream.size() * 10 / (chrono.elapsed() ? chrono.elapsed() : 1) / 1000, "MB/s");
+}
+
+}